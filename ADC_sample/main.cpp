@@ -15,20 +15,76 @@
 #include "common/format.hpp"
 #include "common/itimer.hpp"
 #include "common/adc_io.hpp"
-#include "common/task.hpp"
+#include "common/scheduler.hpp"
 
 namespace {
 
+	// イベント番号
+	constexpr uint8_t EVT_TICK = 0;	///< インターバル・タイマー
+	constexpr uint8_t EVT_ADC  = 1;	///< A/D スキャン終了
+	constexpr uint8_t EVT_NUM  = 2;
+
+	typedef utils::scheduler<EVT_NUM> SCHED;
+	SCHED	sched_;
+
 	typedef utils::fifo<uint8_t, 32> BUFFER;
 	typedef device::uart_io<device::SAU02, device::SAU03, BUFFER, BUFFER> UART1;
 	UART1	uart_;
 
-	typedef device::itimer<uint8_t> ITM;
+	typedef device::itimer<uint8_t, utils::post_task<SCHED, sched_, EVT_TICK> > ITM;
 	ITM		itm_;
 
 	// 最終チャネル番号＋１を設定
-	typedef device::adc_io<4, utils::null_task> ADC;
+	typedef device::adc_io<4, utils::post_task<SCHED, sched_, EVT_ADC> > ADC;
 	ADC 	adc_;
+
+	uint8_t	n_ = 0;
+	uint8_t	t_ = 0;
+
+	void tick_task_(uint8_t param)
+	{
+		adc_.start_scan(2, true);  // スキャン開始チャネル、温度取得
+
+		++n_;
+		if(n_ >= 30) n_ = 0;
+		device::P4.B3 = n_ < 10 ? false : true;
+	}
+
+
+	void adc_task_(uint8_t param)
+	{
+		if(t_ < 30) {
+			++t_;
+			return;
+		}
+		t_ = 0;
+
+		auto val = adc_.get(2);
+		val >>= 6;
+#if 1
+		uint32_t vol = static_cast<uint32_t>(val) * 1024 / 310;  // Vref: 3.3V とした場合の電圧
+		utils::format("A/D CH2: %4.2:10y [V] (%d)\n") % vol % val;
+#else
+		float vol = static_cast<float>(val) * 3.3f / 1023.0f;
+		utils::format("A/D CH2: %4.2f [V] (%d)\n") % vol % val;
+#endif
+		val = adc_.get(3);
+		val >>= 6;
+#if 1
+		vol = static_cast<uint32_t>(val) * 1024 / 310;
+		utils::format("A/D CH3: %4.2:10y [V] (%d)\n") % vol % val;
+#else
+		vol = static_cast<float>(val) * 3.3f / 1023.0f;
+		utils::format("A/D CH3: %4.2f [V] (%d)\n") % vol % val;
+#endif
+		// 温度表示
+		val = adc_.get_temp();
+		val >>= 6;
+		// 1.05V: 25.0度, 3.6mV/度
+		float tv = static_cast<float>(val) * 3.3f / 1023.0f;
+		float temp = (1.05f - tv) / 0.0036f + 25.0f;
+		utils::format("A/D TEMP: %4.2f [K], %4.3f [V]\n") % temp % tv;
+	}
 }
 
 
@@ -112,50 +168,11 @@ int main(int argc, char* argv[])
 		adc_.start(ADC::REFP::VDD, ADC::REFM::VSS, intr_level);
 	}
 
-	uart_.puts("Start RL78/G13 A/D Convert sample\n");
-
-	uint8_t n = 0;
-	uint8_t t = 0;
-	while(1) {
-		itm_.sync();
-		adc_.start_scan(2, true);  // スキャン開始チャネル、温度取得
-
-		adc_.sync();  // スキャン終了待ち
+	sched_.install(EVT_TICK, tick_task_);
+	sched_.install(EVT_ADC, adc_task_, 1);
 
-		if(t >= 30) {
-			auto val = adc_.get(2);
-			val >>= 6;
-#if 1
-			uint32_t vol = static_cast<uint32_t>(val) * 1024 / 310;  // Vref: 3.3V とした場合の電圧
-			utils::format("A/D CH2: %4.2:10y [V] (%d)\n") % vol % val;
-#else
-			float vol = static_cast<float>(val) * 3.3f / 1023.0f;
-			utils::format("A/D CH2: %4.2f [V] (%d)\n") % vol % val;
-#endif
-			val = adc_.get(3);
-			val >>= 6;
-#if 1
-			vol = static_cast<uint32_t>(val) * 1024 / 310;
-			utils::format("A/D CH3: %4.2:10y [V] (%d)\n") % vol % val;
-#else
-			vol = static_cast<float>(val) * 3.3f / 1023.0f;
-			utils::format("A/D CH3: %4.2f [V] (%d)\n") % vol % val;
-#endif
-			// 温度表示
-			val = adc_.get_temp();
-			val >>= 6;
-			// 1.05V: 25.0度, 3.6mV/度
-			float tv = static_cast<float>(val) * 3.3f / 1023.0f;
-			float temp = (1.05f - tv) / 0.0036f + 25.0f;
-			utils::format("A/D TEMP: %4.2f [K], %4.3f [V]\n") % temp % tv;
-
-			t = 0;
-		} else {
-			++t;
-		}
+	uart_.puts("Start RL78/G13 A/D Convert sample\n");
 
-		++n;
-		if(n >= 30) n = 0;
-		device::P4.B3 = n < 10 ? false : true; 	
-	}
+	// イベントが無い間は HALT で待つ
+	sched_.run();
 }
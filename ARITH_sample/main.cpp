@@ -15,7 +15,7 @@
 #include "common/iica_io.hpp"
 #include "common/itimer.hpp"
 #include "common/command.hpp"
-#include "common/basic_arith.hpp"
+#include "common/arith_vm.hpp"
 #include <cstdint>
 #include<cstring>
 
@@ -30,7 +30,10 @@ namespace {
 
 	utils::command<64> command_;
 
-	utils::basic_arith<int32_t> arith_;
+	// 式はバイトコードにコンパイルして評価する、「ans」は前回の結果
+	utils::arith_vm<int32_t> arith_;
+	const char* const sym_[] = { "ans" };
+	int32_t ans_ = 0;
 }
 
 
@@ -119,12 +122,18 @@ int main(int argc, char* argv[])
 
 		// コマンド入力と、コマンド解析
 		if(command_.service()) {
-			if(!arith_.analize(command_.get_command())) {
+			if(!arith_.compile(command_.get_command(), sym_, 1)) {
 				auto err = arith_.get_error();
 				utils::format("Error: %04X\n") % static_cast<uint16_t>(err());
 			} else {
-				auto v = arith_.get();
-				utils::format("Ans: %d\n") % v;
+				auto v = arith_.run(&ans_);
+				auto err = arith_.get_error();
+				if(err() != 0) {
+					utils::format("Error: %04X\n") % static_cast<uint16_t>(err());
+				} else {
+					ans_ = v;
+					utils::format("Ans: %d\n") % v;
+				}
 			}
 		}
 	}
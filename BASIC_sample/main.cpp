@@ -1,6 +1,9 @@
 //=====================================================================//
 /*!	@file
-	@brief	BASIC サンプル
+	@brief	BASIC サンプル @n
+			入力した行は、tiny_basic で中間コードに変換して保存、実行する。 @n
+			SAVE、LOAD で、プログラムをデータ・フラッシュに保存、読み込み、 @n
+			実行中は ^C で止める。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2016 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -14,6 +17,8 @@
 #include "common/itimer.hpp"
 #include "common/format.hpp"
 #include "common/command.hpp"
+#include "common/flash_io.hpp"
+#include "common/tiny_basic.hpp"
 
 namespace {
 
@@ -28,6 +33,22 @@ namespace {
 	ITM		itm_;
 
 	utils::command<64> command_;
+
+	// データ・フラッシュ（プログラムの保存先）
+	device::flash_io	flash_;
+
+	// ^C で実行を止める
+	struct basic_break {
+		bool operator() () {
+			while(uart_.recv_length() > 0) {
+				if(uart_.getch() == 0x03) return true;
+			}
+			return false;
+		}
+	};
+
+	typedef utils::tiny_basic<2048, 128, 32, basic_break> BASIC;
+	BASIC	basic_;
 }
 
 
@@ -108,6 +129,11 @@ int main(int argc, char* argv[])
 
 	uart_.puts("Start RL78/G13 BASIC sample\n");
 
+	bool flash = flash_.start();
+	if(!flash) {
+		utils::format("Data Flash Start: NG\n");
+	}
+
 	command_.set_prompt("# ");
 
 	uint8_t n = 0;
@@ -116,6 +142,21 @@ int main(int argc, char* argv[])
 
 		// コマンド入力と、コマンド解析
 		if(command_.service()) {
+			if(command_.cmp_word(0, "SAVE") || command_.cmp_word(0, "save")) {
+				if(flash && basic_.save(flash_, 0)) {
+					utils::format("%d bytes\n") % basic_.size();
+				} else {
+					utils::format("?SAVE ERROR\n");
+				}
+			} else if(command_.cmp_word(0, "LOAD") || command_.cmp_word(0, "load")) {
+				if(flash && basic_.load(flash_, 0)) {
+					utils::format("%d bytes\n") % basic_.size();
+				} else {
+					utils::format("?LOAD ERROR\n");
+				}
+			} else {
+				basic_.service(command_.get_command());
+			}
 		}
 
 		++n;
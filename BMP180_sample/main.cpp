@@ -145,14 +145,17 @@ int main(int argc, char* argv[])
 		++n;
 		if(n >= 60) {
 			n = 0;
-			auto t = bmpx_.get_temperature();
+			// 温度、圧力は一回の読み出しで取得（整数演算のみ）
+			int32_t t;
+			int32_t p;
+			bmpx_.get(t, p);
 			utils::format("Temperature: %d.%02d C\n") % (t / 100) % (t % 100);
-
-			auto p = bmpx_.get_pressure();
 			utils::format("Pressure: %d.%02d hPa\n") % (p / 100) % (p % 100);
 
-			auto a = bmpx_.get_altitude();
-			utils::format("Altitude: %3.2f m\n") % a;
+			int32_t a = utils::altitude<>::get(p);
+			char sign = ' ';
+			if(a < 0) { sign = '-'; a = -a; }
+			utils::format("Altitude: %c%d.%02d m\n") % sign % (a / 100) % (a % 100);
 		}
 
 		// コマンド入力と、コマンド解析
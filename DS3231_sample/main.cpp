@@ -20,6 +20,7 @@
 #include "common/command.hpp"
 #include "common/time.h"
 #include "chip/DS3231.hpp"
+#include "common/rtc_time.hpp"
 
 // どれか一つだけ有効にする。
 // #define UART0
@@ -30,7 +31,11 @@ namespace {
 	typedef device::iica_io<device::IICA0> IICA;
 	IICA iica0_;
 
-	chip::DS3231<IICA> rtc_(iica0_);
+	typedef chip::DS3231<IICA> RTC;
+	RTC		rtc_(iica0_);
+
+	// RTC を読むのは開始時と同期時だけ、時間は itimer で進める
+	utils::rtc_time<RTC> rtc_time_(rtc_);
 
 	typedef utils::fifo<uint8_t, 32> buffer;
 
@@ -118,6 +123,7 @@ extern "C" {
 	void ITM_intr(void)
 	{
 		itm_.task();
+		rtc_time_.tick();
 	}
 };
 
@@ -126,11 +132,7 @@ namespace {
 
 	time_t get_time_()
 	{
-		time_t t = 0;
-		if(!rtc_.get_time(t)) {
-			utils::format("Stall RTC read (%d)\n") % static_cast<uint32_t>(iica0_.get_last_error());
-		}
-		return t;
+		return rtc_time_.get();
 	}
 
 
@@ -222,7 +224,7 @@ namespace {
 		}
 
 		time_t tt = mktime(m);
-		if(!rtc_.set_time(tt)) {
+		if(!rtc_time_.set(tt)) {
 			sci_puts("Stall RTC write...\n");
 		}
 	}
@@ -264,6 +266,9 @@ int main(int argc, char* argv[])
 	if(!rtc_.start()) {
 		utils::format("Stall RTC start (%d)\n") % static_cast<uint32_t>(iica0_.get_last_error());
 	}
+	if(!rtc_time_.start(60)) {
+		utils::format("Stall RTC read (%d)\n") % static_cast<uint32_t>(iica0_.get_last_error());
+	}
 
 	command_.set_prompt("# ");
 
@@ -272,6 +277,8 @@ int main(int argc, char* argv[])
 	while(1) {
 		itm_.sync();
 
+		rtc_time_.service();
+
 		if(cnt >= 20) {
 			cnt = 0;
 		}
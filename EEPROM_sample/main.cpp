@@ -33,6 +33,10 @@ namespace {
 	typedef chip::EEPROM<I2C> eeprom;
 	eeprom eeprom_(i2c_);
 
+	// 32 バイト x 4 ラインのライトバック・キャッシュ
+	typedef chip::EEPROM_cache<eeprom, 32, 4> CACHE;
+	CACHE	cache_(eeprom_);
+
 	utils::command<64> command_;
 }
 
@@ -164,6 +168,7 @@ namespace {
 			sci_puts("read ADDRESS [END-ADDRESS]\n");
 			sci_puts("write ADDRESS DATA ...\n");
 			sci_puts("fill ADDRESS LENGTH DATA ...\n");
+			sci_puts("flush\n");
 			return true;
 		}
 		return false;
@@ -208,6 +213,8 @@ namespace {
 				sci_puts("Invalid Page-Size renge.\n");
 				return true;
 			}
+			cache_.flush();
+			cache_.clear();
 			if(command_.cmp_word(1, "M256B")) {
 				if(id >= 0 && id <= 7) {
 					eeprom_.start(static_cast<eeprom::M256B>(id), pgs);
@@ -256,7 +263,7 @@ namespace {
 					if(len > (end - adr)) {
 						len = end - adr;
 					}
-					if(eeprom_.read(adr, tmp, len)) {
+					if(cache_.read(adr, tmp, len)) {
 						dump_(adr, tmp, len);
 					} else {
 						sci_puts("Stall EEPROM read...\n");
@@ -292,7 +299,7 @@ namespace {
 						return true;
 					}
 				}
-				if(!eeprom_.write(adr, tmp, cmdn)) {
+				if(!cache_.write(adr, tmp, cmdn)) {
 					sci_puts("Stall EEPROM write...\n");
 				}
 			} else {
@@ -328,18 +335,13 @@ namespace {
 					}
 					while(len > 0) {
 						if(cmdn > len) cmdn = len;
-						if(!eeprom_.write(adr, tmp, cmdn)) {
+						if(!cache_.write(adr, tmp, cmdn)) {
 							sci_puts("Stall EEPROM write...\n");
 							break;
 						} else {
 							sci_putch('.');
 						}
 						len -= cmdn;
-						if(len > 0) {
-							if(!eeprom_.sync_write(adr)) {
-								sci_puts("Stall EEPROM write: 'write sync time out'\n");
-							}
-						}
 						adr += cmdn;
 					}
 					sci_putch('\n');
@@ -353,6 +355,17 @@ namespace {
 		}
 		return false;
 	}
+
+
+	bool flush_(uint8_t cmdn) {
+		if(cmdn == 1 && command_.cmp_word(0, "flush")) {
+			if(!cache_.flush()) {
+				sci_puts("Stall EEPROM write: 'write sync time out'\n");
+			}
+			return true;
+		}
+		return false;
+	}
 }
 
 
@@ -402,6 +415,13 @@ int main(int argc, char* argv[])
 	while(1) {
 		itm_.sync();
 
+		// キャッシュの書き込み（１ページずつ、ACK ポーリング）
+		cache_.service();
+		if(cache_.get_error()) {
+			sci_puts("Stall EEPROM write...\n");
+			cache_.clear();
+		}
+
 		// コマンド入力と、コマンド解析
 		if(command_.service()) {
 			uint8_t cmdn = command_.get_words();
@@ -414,6 +434,7 @@ int main(int argc, char* argv[])
 			else if(read_(cmdn)) ;
 			else if(write_(cmdn)) ;
 			else if(fill_(cmdn)) ;
+			else if(flush_(cmdn)) ;
 			else {
 				sci_puts("Command error: ");
 				sci_puts(command_.get_command());
@@ -193,7 +193,7 @@ namespace device {
 			@return ペリフェラル種別
 		*/
 		//-------------------------------------------------------------//
-		static peripheral get_peripheral() { return peripheral::ADC; }
+		static constexpr peripheral get_peripheral() { return peripheral::ADC; }
 	};
 	// テンプレート内、スタティック定義、実態：
 	template<class _> typename adc_t<_>::ADM0_ adc_t<_>::ADM0;
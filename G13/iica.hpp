@@ -172,7 +172,7 @@ namespace device {
 			@return ペリフェラル種別
 		*/
 		//-------------------------------------------------------------//
-		static peripheral get_peripheral() { return PER; }
+		static constexpr peripheral get_peripheral() { return PER; }
 	};
 	// テンプレート内、スタティック定義、実態：
 	template <peripheral PER, uint32_t UOFS>
@@ -49,7 +49,7 @@ namespace device {
 			@return ペリフェラル種別
 		*/
 		//-----------------------------------------------------------------//
-		static peripheral get_peripheral() { return peripheral::ITM; }
+		static constexpr peripheral get_peripheral() { return peripheral::ITM; }
 	};
 	// テンプレート内、スタティック定義、実態：
 	template<class _> typename itm_t<_>::ITMC_ itm_t<_>::ITMC;
@@ -11,11 +11,28 @@
 #include "common/renesas.hpp"
 #include "common/port_utils.hpp"
 #include "common/itimer.hpp"
+#include "common/soft_timer.hpp"
 
 namespace {
 
-	device::itimer<uint8_t> itm_;
+	utils::soft_timer<4> timer_;
 
+	class timer_task {
+	public:
+		void operator() ();
+	};
+
+	device::itimer<uint8_t, timer_task> itm_;
+
+	// 割り込み周期の倍率分（tickless）の tick を渡す
+	void timer_task::operator() () {
+		timer_.tick(itm_.get_scale());
+	}
+
+	void led_task_(void* option)
+	{
+		device::P4.B3 = !device::P4.B3();
+	}
 }
 
 
@@ -39,12 +56,13 @@ int main(int argc, char* argv[])
 	uint8_t intr_level = 1;
 	itm_.start(60, intr_level);
 
-	uint16_t n = 0;
+	auto led = timer_.add(led_task_);
+	timer_.start(led, 15, 15);  // 0.25 秒毎に反転
+
+	// tickless：次の期限まで、インターバル・タイマーの割り込みを間引く
 	while(1) {
-///		utils::delay::micro_second(10);
 		itm_.sync();
-		++n;
-		if(n >= 30) n = 0;
-		P4.B3 = n < 10 ? false : true; 	
+		timer_.service();
+		itm_.set_scale(timer_.get_idle(0xffff));
 	}
 }
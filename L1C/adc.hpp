@@ -183,6 +183,6 @@ namespace device {
 			@return ペリフェラル種別
 		*/
 		//-------------------------------------------------------------//
-		static peripheral get_peripheral() { return peripheral::ADC; }
+		static constexpr peripheral get_peripheral() { return peripheral::ADC; }
 	};
 }
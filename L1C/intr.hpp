@@ -919,5 +919,114 @@ namespace device {
 				break;
 			}
 		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief  割り込み要因番号の取得 @n
+					IF0L の B0 を０とする通し番号で、IF レジスタのアドレスと @n
+					ビット位置を表す。MK、PR0x、PR1x は、IF レジスタから、 @n
+					+4、+8、+12 のアドレスに、同じビット配置で並ぶ。
+			@param[in]	per	ペリフェラル型
+			@return 要因番号（対応しない場合「0xff」）
+		*/
+		//-------------------------------------------------------------//
+		static constexpr uint8_t get_source(peripheral per)
+		{
+			switch(per) {
+			case peripheral::ITM:   return 28;  // IF1H.TMKAIF
+			case peripheral::ADC:   return 26;  // IF1H.ADIF
+			case peripheral::IICA0: return 20;  // IF1L.IICAIF0
+			case peripheral::SAU00: return 13;  // IF0H.STIF0
+			case peripheral::SAU01: return 15;  // IF0H.SRIF0
+			case peripheral::SAU02: return 17;  // IF1L.STIF1
+			case peripheral::SAU03: return 18;  // IF1L.SRIF1
+			case peripheral::SAU10: return  8;  // IF0H.STIF2
+			case peripheral::SAU11: return  9;  // IF0H.SRIF2
+			case peripheral::SAU12: return 30;  // IF1H.STIF3
+			case peripheral::SAU13: return 31;  // IF1H.SRIF3
+			case peripheral::TAU00: return 14;  // IF0H.TMIF00
+			case peripheral::TAU01: return 23;  // IF1L.TMIF01
+			case peripheral::TAU02: return 24;  // IF1H.TMIF02
+			case peripheral::TAU03: return 25;  // IF1H.TMIF03
+			case peripheral::TAU04: return 33;  // IF2L.TMIF04
+			case peripheral::TAU05: return 34;  // IF2L.TMIF05
+			case peripheral::TAU06: return 40;  // IF2H.TMIF06
+			case peripheral::TAU07: return 41;  // IF2H.TMIF07
+			default:
+				return 0xff;
+			}
+		}
+
+	private:
+		static constexpr address_type if_org_(uint8_t src)
+		{
+			return src < 32 ? (0xFFFE0 + (src >> 3)) : (0xFFFD0 + ((src >> 3) - 4));
+		}
+
+		template <peripheral PER, uint8_t OFS>
+		using src_bit_t = bit_rw_t<rw8_t<if_org_(get_source(PER)) + OFS>,
+			static_cast<bitpos>(get_source(PER) & 7)>;
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief  割り込み要求フラグの取得（コンパイル時に解決）
+			@param[in]	PER	ペリフェラル型
+			@return 割り込み発生なら「true」
+		*/
+		//-------------------------------------------------------------//
+		template <peripheral PER>
+		static bool get_request()
+		{
+			static_assert(get_source(PER) != 0xff, "Not support peripheral");
+			return src_bit_t<PER, 0>::get();
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief  割り込み要求フラグの設定（コンパイル時に解決）
+			@param[in]	PER	ペリフェラル型
+			@param[in]	ena	要求フラグ
+		*/
+		//-------------------------------------------------------------//
+		template <peripheral PER>
+		static void set_request(bool ena)
+		{
+			static_assert(get_source(PER) != 0xff, "Not support peripheral");
+			src_bit_t<PER, 0>::set(ena);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief  割り込み許可（コンパイル時に解決）
+			@param[in]	PER	ペリフェラル型
+			@param[in]	ena	不許可なら「false」
+		*/
+		//-------------------------------------------------------------//
+		template <peripheral PER>
+		static void enable(bool ena = true)
+		{
+			static_assert(get_source(PER) != 0xff, "Not support peripheral");
+			src_bit_t<PER, 4>::set(!ena);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief  割り込みレベル設定（コンパイル時に解決）
+			@param[in]	PER		ペリフェラル型
+			@param[in]	level	割り込みレベル（０、１、２）
+		*/
+		//-------------------------------------------------------------//
+		template <peripheral PER>
+		static void set_level(uint8_t level)
+		{
+			static_assert(get_source(PER) != 0xff, "Not support peripheral");
+			src_bit_t<PER, 8>::set(level & 1);
+			src_bit_t<PER, 12>::set((level & 2) >> 1);
+		}
 	};
 }
@@ -255,7 +255,7 @@ namespace device {
 			@return ペリフェラル種別
 		*/
 		//-------------------------------------------------------------//
-		static peripheral get_peripheral() { return PER; }
+		static constexpr peripheral get_peripheral() { return PER; }
 	};
 	typedef sau_t<peripheral::SAU00, 0x00, 0x00, 0x00> SAU00;
 	typedef sau_t<peripheral::SAU01, 0x00, 0x02, 0x02> SAU01;
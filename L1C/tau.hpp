@@ -317,7 +317,7 @@ namespace device {
 			@return ペリフェラル種別
 		*/
 		//-------------------------------------------------------------//
-		static peripheral get_peripheral() { return PER; }
+		static constexpr peripheral get_peripheral() { return PER; }
 	};
 	typedef tau_t<peripheral::TAU00, 0x00, 0x00, 0xFFF18> TAU00;
 	typedef tau_t<peripheral::TAU01, 0x00, 0x02, 0xFFF1A> TAU01;
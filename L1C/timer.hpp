@@ -45,6 +45,6 @@ namespace device {
 			@return ペリフェラル種別
 		*/
 		//-----------------------------------------------------------------//
-		static peripheral get_peripheral() { return peripheral::ITM; }
+		static constexpr peripheral get_peripheral() { return peripheral::ITM; }
 	};
 }
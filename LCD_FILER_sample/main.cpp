@@ -61,7 +61,8 @@ namespace {
 	typedef device::PORT<device::port_no::P0,  device::bitpos::B1> card_power;	///< カード電源制御
 	typedef device::PORT<device::port_no::P14, device::bitpos::B6> card_detect;	///< カード検出
 
-	typedef utils::sdc_io<csi, card_select, card_power, card_detect> sdc_io;
+	// ファイラーのページ表示用ディレクトリー・インデックス（64 x 8 = 512 エントリー、256 バイト）
+	typedef utils::sdc_io<csi, card_select, card_power, card_detect, 64> sdc_io;
 	sdc_io sdc_(csi_);
 
 	// LCD CSI(SPI) の定義、CSI20 の通信では、「SAU10」を利用、１ユニット、チャネル０
@@ -354,7 +355,7 @@ int main(int argc, char* argv[])
 		P4.B3 = n < 10 ? false : true;
 
 		if((fbf_back && !fbf) || fbcopy) {
-			lcd_.copy(bitmap_.fb(), bitmap_.page_num());
+			lcd_.flush_dirty(bitmap_);
 		}
 	}
 }
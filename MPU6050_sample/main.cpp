@@ -19,6 +19,7 @@
 #include "common/itimer.hpp"
 #include "common/command.hpp"
 #include "common/time.h"
+#include "common/imu_filter.hpp"
 #include "chip/MPU6050.hpp"
 
 namespace {
@@ -26,7 +27,15 @@ namespace {
 	typedef device::iica_io<device::IICA0> IICA;
 	IICA iica_;
 
-	chip::MPU6050<IICA> mpu6050_(iica_);
+	typedef chip::MPU6050<IICA> MPU6050;
+	MPU6050 mpu6050_(iica_);
+
+	// FIFO のサンプリングレート
+	static const uint16_t SAMPLE_RATE = 200;
+
+	utils::imu_filter<> imu_filter_;
+
+	MPU6050::frame_t frames_[8];
 
 	typedef utils::fifo<uint8_t, 64> buffer;
 
@@ -124,6 +133,9 @@ int main(int argc, char* argv[])
 	// MPU6050 の開始
 	if(!mpu6050_.start()) {
 		utils::format("Stall MPU6050 start (%d)\n") % static_cast<uint32_t>(iica_.get_last_error());
+	} else {
+		mpu6050_.start_fifo(SAMPLE_RATE);
+		imu_filter_.start(SAMPLE_RATE, mpu6050_.get_gyro_sens10());
 	}
 
 	command_.set_prompt("# ");
@@ -140,18 +152,28 @@ int main(int argc, char* argv[])
 		else P4.B3 = 0;
 		++cnt;
 
+		// FIFO に溜まったフレームをまとめて読み、姿勢を更新
+		uint8_t fn = mpu6050_.read_fifo(frames_, sizeof(frames_) / sizeof(frames_[0]));
+		for(uint8_t i = 0; i < fn; ++i) {
+			const auto& f = frames_[i];
+			imu_filter_.update(f.accel.x, f.accel.y, f.accel.z, f.gyro.x, f.gyro.y);
+		}
+
 		++n;
 		if(n >= 60) {
 			n = 0;
 
-			auto a = mpu6050_.get_accel();
-			utils::format("ACCEL: %d, %d, %d\n") % a.x % a.y % a.z;
+			if(fn > 0) {
+				const auto& f = frames_[fn - 1];
+				utils::format("ACCEL: %d, %d, %d\n") % f.accel.x % f.accel.y % f.accel.z;
+				utils::format("GYRO:  %d, %d, %d\n") % f.gyro.x % f.gyro.y % f.gyro.z;
+			}
 
 			auto t = mpu6050_.get_temp();
 			utils::format("TEMP:  %d.%1d\n") % (t / 10) % (t % 10);
 
-			auto g = mpu6050_.get_gyro();
-			utils::format("GYRO:  %d, %d, %d\n") % g.x % g.y % g.z;
+			utils::format("ROLL:  %d, PITCH: %d (0.01 deg)\n")
+				% imu_filter_.get_roll() % imu_filter_.get_pitch();
 		}
 
 		// コマンド入力と、コマンド解析
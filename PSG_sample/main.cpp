@@ -21,6 +21,7 @@
 #include "common/command.hpp"
 
 #include "common/psg_mng.hpp"
+#include "common/profile.hpp"
 
 namespace pwm {
 
@@ -41,8 +42,8 @@ namespace pwm {
 		// 波形位置を取得
 		uint16_t get_pos() const { return pos_; }
 
-		// 割り込み、functor
-		void operator() () {
+		// 割り込み、functor（RAM で実行）
+		void operator() () RAMTEXT_FUNC {
 			device::TAU01::TDRL = buff_[pos_];
 			device::TAU02::TDRL = buff_[pos_];
 			++pos_;
@@ -79,6 +80,15 @@ namespace {
 
 	utils::command<64> command_;
 
+	// プロファイラーの ID（Makefile の USER_DEFS に PROFILE を追加すると有効）
+	enum prof_id : uint8_t {
+		PROF_UART_RX,	///< uart_io::recv_task
+		PROF_MASTER,	///< interval_master（TM00）
+		PROF_MASTER_LAT,	///< TM00 割り込みの遅延（TAU00 のカウント単位、prof_decode で換算）
+		PROF_RENDER,	///< psg_mng::render_fast
+		PROF_SERVICE,	///< psg_mng::service
+	};
+
 	bool init_pwm_()
 	{
 		// 31.25 KHz (32MHz(F_CLK) / 4 / 256)
@@ -1086,7 +1096,9 @@ extern "C" {
 
 	void UART1_RX_intr(void)
 	{
+		PROF_ENTER(PROF_UART_RX);
 		uart_.recv_task();
+		PROF_LEAVE(PROF_UART_RX);
 	}
 
 
@@ -1103,7 +1115,10 @@ extern "C" {
 
 	void TM00_intr(void)
 	{
+		PROF_LATENCY(PROF_MASTER_LAT, device::TAU00);
+		PROF_ENTER(PROF_MASTER);
 		master_.task();
+		PROF_LEAVE(PROF_MASTER);
 	}
 };
 
@@ -1128,6 +1143,11 @@ int main(int argc, char* argv[])
 
 	uart_.puts("Start RL78/G13 PSG sample\n");
 
+#ifdef PROFILE
+	// TAU00～02 が PRS0 を使うので、PRS1 のチャネルで計測する
+	device::tau_cycle<device::TAU06>::start();
+#endif
+
 	if(!init_pwm_()) {
 		uart_.puts("PWM initialization fail\n");
 	}
@@ -1150,7 +1170,10 @@ int main(int argc, char* argv[])
 			n &= pwm::BUFF_NUM - 1;
 			if(n > (SAMPLE / TICK + 8)) n = SAMPLE / TICK + 8;
 			int8_t tmp[n];
-			psg_mng_.render(n, tmp);
+			{
+				PROF_SCOPE(PROF_RENDER);
+				psg_mng_.render_fast(n, tmp);
+			}
 			auto p = master_.at_task().get_buff();
 			pos -= n;
 			pos &= pwm::BUFF_NUM - 1;
@@ -1164,6 +1187,7 @@ int main(int argc, char* argv[])
 			if(delay > 0) {
 				delay--;
 			} else {
+				PROF_SCOPE(PROF_SERVICE);
 				psg_mng_.service();
 			}
 		}
@@ -1172,6 +1196,15 @@ int main(int argc, char* argv[])
 		if(command_.service()) {
 			auto cmdn = command_.get_words();
 			if(cmdn >= 1) {
+#ifdef PROFILE
+				if(command_.cmp_word(0, "prof")) {  // 集計の出力（prof_decode で表示）
+					if(cmdn >= 2 && command_.cmp_word(1, "clear")) {
+						utils::profile::clear();
+					} else {
+						PROF_DUMP(uart_);
+					}
+				}
+#endif
 			}
 		}
 
@@ -15,6 +15,7 @@
 #include "common/uart_io.hpp"
 #include "common/itimer.hpp"
 #include "common/format.hpp"
+#include "common/ram_monitor.hpp"
 #include "common/delay.hpp"
 #include "common/iica_io.hpp"
 #include "common/csi_io.hpp"
@@ -338,6 +339,9 @@ int main(int argc, char* argv[])
 				} else if(command_.cmp_word(0, "speed")) { // speed
 					test_all_();
 					f = true;
+				} else if(command_.cmp_word(0, "ram")) { // ram
+					utils::ram_monitor::list();
+					f = true;
 #ifdef WITH_RTC
 				} else if(command_.cmp_word(0, "date")) { // date
 					date_();
@@ -134,7 +134,8 @@ int main(int argc, char* argv[])
 
 			auto v = adc_.get(2);
 			v >>= 6;
-			utils::format("温度： %5.2f [度]\n") % thmister_(v);
+			// テーブル変換（float、libm を使わない）
+			utils::format("温度： %5.2:4y [度]\n") % thmister_.get_fixed(v);
 			t = 0;
 		}
 
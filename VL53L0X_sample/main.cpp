@@ -10,6 +10,7 @@
 #include "common/renesas.hpp"
 #include "common/port_utils.hpp"
 #include "common/itimer.hpp"
+#include "common/tau_clock.hpp"
 #include "common/uart_io.hpp"
 #include "common/format.hpp"
 #include "common/iica_io.hpp"
@@ -21,6 +22,9 @@ namespace {
 
 	device::itimer<uint8_t> itm_;
 
+	// delay、deadline（VL53L0X のタイムアウト）を、タイマーで測る
+	typedef device::tau_clock<device::TAU03> CLOCK;
+
 	typedef utils::fifo<uint8_t, 32> BUFFER;
 	typedef device::uart_io<device::SAU02, device::SAU03, BUFFER, BUFFER> UART;
 	UART	uart_;
@@ -81,6 +85,12 @@ extern "C" {
 	{
 		itm_.task();
 	}
+
+
+	void TM03_intr(void)
+	{
+		CLOCK::task();
+	}
 };
 
 
@@ -98,6 +108,12 @@ int main(int argc, char* argv[])
 		itm_.start(60, intr_level);
 	}
 
+	// タイム・ベースの開始（登録後、delay、deadline はタイマーを使う）
+	{
+		uint8_t intr_level = 1;
+		CLOCK::start(intr_level);
+	}
+
 	// UART の開始
 	{
 		uint8_t intr_level = 1;
@@ -114,27 +130,45 @@ int main(int argc, char* argv[])
 
 	utils::format("Start RL78/G13 VL53L0X sample\n");
 
+	// タイマーの動作確認（1000uS の待ちを、タイマーで測る）
+	{
+		utils::elapsed et;
+		utils::delay::micro_second(1000);
+		utils::format("Time base: %d Hz, delay 1000 us -> %d us\n")
+			% CLOCK::get_freq() % et.get_us();
+	}
+
 	// VL53L0X を開始
 	if(!vlx_.start()) {
 		utils::format("VL53L0X start fail\n");
 	} else {
 		// 20ms
 		vlx_.set_measurement_timing_budget(200000);
+		// 連続計測、完了はタイマー毎にポーリング（ブロックしない）
+		vlx_.start_service(0);
 	}
 
 	uint8_t cnt = 0;
 	uint8_t	itv = 0;
+	uint32_t svc = 0;
 	while(1) {
 		itm_.sync();
 
+		utils::elapsed et;
+		vlx_.service(itm_.get_counter());
+		uint32_t t = et.get_us();
+		if(t > svc) svc = t;
+
 		++itv;
 		if(itv >= 50) {
-			auto len = vlx_.read_range_single_millimeters();
-			if(vlx_.timeout_occurred()) {
-				utils::format("Length: timeout\n");
+			auto len = vlx_.get_median();
+			if(len == 65535) {
+				utils::format("Length: out of range\n");
 			} else {
 				utils::format("Length: %d [mm]\n") % (len - 50);
 			}
+			utils::format("service: %d us (max)\n") % svc;
+			svc = 0;
 			itv = 0;
 		}
 
@@ -165,7 +165,8 @@ namespace {
 	typedef device::PORT<device::port_no::P0,  device::bitpos::B1> card_power;	///< カード電源制御
 	typedef device::PORT<device::port_no::P14, device::bitpos::B6> card_detect;	///< カード検出
 
-	typedef utils::sdc_io<csi, card_select, card_power, card_detect> sdc_io;
+	// ファイラーのページ表示用ディレクトリー・インデックス（64 x 8 = 512 エントリー、256 バイト）
+	typedef utils::sdc_io<csi, card_select, card_power, card_detect, 64> sdc_io;
 	sdc_io sdc_(csi_);
 
 	utils::command<64> command_;
@@ -466,7 +467,7 @@ namespace {
 			% static_cast<uint32_t>(wav_.get_chanel())
 			% wav_.get_rate();
 		turn_bmp_ = false;
-		lcd_.copy(bitmap_.fb(), bitmap_.page_num());
+		lcd_.flush_dirty(bitmap_);
 #endif
 
 		master_.at_task().set_rate(wav_.get_rate());
@@ -692,7 +693,7 @@ int main(int argc, char* argv[])
 		adc_.start_scan(2);
 
 		if((fbf_back && !fbf) || fbcopy) {
-			lcd_.copy(bitmap_.fb(), bitmap_.page_num());
+			lcd_.flush_dirty(bitmap_);
 		}
 
 		adc_.sync();
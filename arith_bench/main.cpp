@@ -0,0 +1,148 @@
+//=====================================================================//
+/*!	@file
+	@brief	basic_arith と arith_vm の評価速度の比較（ホスト用） @n
+			同じ式を、毎回テキストから解析する場合と、一度コンパイルした @n
+			バイトコードを評価する場合の、１秒あたりの評価回数を表示する。 @n
+			シンボルを使う式は、整数、float、固定小数点（Q8）の VM を、 @n
+			値を埋め込んだテキストを解析する basic_arith と比較する。 @n
+			arith_bench [式 ...]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include "common/basic_arith.hpp"
+#include "common/arith_vm.hpp"
+
+namespace {
+
+	static const uint32_t LOOP = 1000000;
+
+	volatile int32_t sink_;
+
+	template <class FUNC>
+	double bench_(FUNC func)
+	{
+		auto st = std::chrono::steady_clock::now();
+		for(uint32_t i = 0; i < LOOP; ++i) {
+			func(i);
+		}
+		auto ed = std::chrono::steady_clock::now();
+		double sec = std::chrono::duration<double>(ed - st).count();
+		return LOOP / sec;
+	}
+
+
+	void test_(const char* text)
+	{
+		utils::basic_arith<int32_t> arith;
+		utils::arith_vm<int32_t> vm;
+		if(!arith.analize(text) || !vm.compile(text)) {
+			printf("Error: '%s'\n", text);
+			return;
+		}
+		if(arith.get() != vm.run()) {
+			printf("Mismatch: '%s' (%d, %d)\n", text, arith.get(), vm.run());
+			return;
+		}
+
+		auto a = bench_([&](uint32_t) { arith.analize(text); sink_ = arith.get(); });
+		auto b = bench_([&](uint32_t) { sink_ = vm.run(); });
+		printf("'%s' (%u bytes)\n", text, vm.size());
+		printf("  basic_arith: %12.0f eval/s\n", a);
+		printf("  arith_vm:    %12.0f eval/s (x%.1f)\n", b, b / a);
+	}
+
+
+	// シンボルを使う式（ADC のサンプル毎の変換を想定）
+	static const char* SYM_TEXT = "(adc - ofs) * gain / 1024 + base";
+	static const char* SYM_NAME[] = { "adc", "ofs", "gain", "base" };
+	static const int32_t SYM_OFS = 512;
+	static const int32_t SYM_GAIN = 3300;
+	static const int32_t SYM_BASE = 100;
+	static const uint16_t SYM_NUM = 1024;
+
+	char sym_text_[SYM_NUM][48];
+	int32_t sym_ref_[SYM_NUM];
+
+	// basic_arith はシンボルを扱わないので、サンプル毎に値を埋め込んだテキストを解析
+	double symbol_base_()
+	{
+		utils::basic_arith<int32_t> arith;
+		for(uint16_t i = 0; i < SYM_NUM; ++i) {
+			snprintf(sym_text_[i], sizeof(sym_text_[i]), "(%u - %d) * %d / 1024 + %d",
+				i, SYM_OFS, SYM_GAIN, SYM_BASE);
+			arith.analize(sym_text_[i]);
+			sym_ref_[i] = arith.get();
+		}
+		return bench_([&](uint32_t i) { arith.analize(sym_text_[i & (SYM_NUM - 1)]); sink_ = arith.get(); });
+	}
+
+
+	template <class VM, typename T>
+	bool test_symbol_(const char* name, double base, T (*to)(int32_t), double (*from)(T))
+	{
+		VM vm;
+		if(!vm.compile(SYM_TEXT, SYM_NAME, 4)) {
+			printf("Error: '%s' (%s)\n", SYM_TEXT, name);
+			return false;
+		}
+		T vars[4] = { 0, to(SYM_OFS), to(SYM_GAIN), to(SYM_BASE) };
+		// 整数の割り算は切り捨てなので、差は 1 未満
+		for(uint16_t i = 0; i < SYM_NUM; ++i) {
+			vars[0] = to(i);
+			double v = from(vm.run(vars));
+			if(vm.get_error()() != 0 || v < (sym_ref_[i] - 1) || v > (sym_ref_[i] + 1)) {
+				printf("Mismatch: %s adc=%u (%f, %d)\n", name, i, v, sym_ref_[i]);
+				return false;
+			}
+		}
+		auto b = bench_([&](uint32_t i) {
+			vars[0] = to(i & (SYM_NUM - 1));
+			sink_ = static_cast<int32_t>(vm.run(vars));
+		});
+		char tmp[32];
+		snprintf(tmp, sizeof(tmp), "arith_vm<%s>:", name);
+		printf("  %-18s %12.0f eval/s (x%.1f)\n", tmp, b, b / base);
+		return true;
+	}
+
+	int32_t int_to_(int32_t v) { return v; }
+	double int_from_(int32_t v) { return v; }
+	float float_to_(int32_t v) { return v; }
+	double float_from_(float v) { return v; }
+	int32_t q8_to_(int32_t v) { return v << 8; }
+	double q8_from_(int32_t v) { return v / 256.0; }
+
+	void test_symbol_all_()
+	{
+		auto a = symbol_base_();
+		printf("'%s' (adc = 0 to %u)\n", SYM_TEXT, SYM_NUM - 1);
+		printf("  %-18s %12.0f eval/s (text with values)\n", "basic_arith:", a);
+		test_symbol_<utils::arith_vm<int32_t>, int32_t>("int32_t", a, int_to_, int_from_);
+		test_symbol_<utils::arith_vm<float>, float>("float", a, float_to_, float_from_);
+		// 途中の積（-512 * 3300）が入る様に、小数部は 8 ビット
+		test_symbol_<utils::arith_vm<int32_t, utils::arith_fixed<8> >, int32_t>("Q8",
+			a, q8_to_, q8_from_);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(argc > 1) {
+		for(int i = 1; i < argc; ++i) {
+			test_(argv[i]);
+		}
+		return 0;
+	}
+
+	test_("1+2*3");
+	test_("(123 + 456) * 789 // 1000 - 3 << 2");
+	test_symbol_all_();
+	return 0;
+}
@@ -0,0 +1,505 @@
+//=====================================================================//
+/*!	@file
+	@brief	tiny_basic の実行速度（ホスト用） @n
+			Rugg/Feldman のベンチマーク（BM1～BM7）を整数版にして、 @n
+			１回の RUN にかかる時間を表示する。 @n
+			比較の為に、ソース・テキストを毎回解析し、行を先頭から探す @n
+			従来型のインタープリター（ベンチマークの命令だけ）でも実行する。 @n
+			最後に、BM1～BM7 の合計が、目標（10 倍）に届いたかを表示する。 @n
+			※BM6、BM7 の配列 M() は、@() に置き換え、BM8（浮動小数点の @n
+			関数）は、整数版には無いので除く。 @n
+			basic_bench [回数]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include "common/tiny_basic.hpp"
+
+namespace {
+
+	typedef utils::tiny_basic<> BASIC;
+
+	static const char* bm1_[] = {
+		"100 FOR K=1 TO 1000",
+		"110 NEXT K",
+		"120 END",
+		nullptr
+	};
+
+	static const char* bm2_[] = {
+		"100 K=0",
+		"110 K=K+1",
+		"120 IF K<1000 THEN 110",
+		"130 END",
+		nullptr
+	};
+
+	static const char* bm3_[] = {
+		"100 K=0",
+		"110 K=K+1",
+		"120 A=K/K*K+K-K",
+		"130 IF K<1000 THEN 110",
+		"140 END",
+		nullptr
+	};
+
+	static const char* bm4_[] = {
+		"100 K=0",
+		"110 K=K+1",
+		"120 A=K/2*3+4-5",
+		"130 IF K<1000 THEN 110",
+		"140 END",
+		nullptr
+	};
+
+	static const char* bm5_[] = {
+		"100 K=0",
+		"110 K=K+1",
+		"120 A=K/2*3+4-5",
+		"130 GOSUB 200",
+		"140 IF K<1000 THEN 110",
+		"150 END",
+		"200 RETURN",
+		nullptr
+	};
+
+	static const char* bm6_[] = {
+		"100 K=0",
+		"110 K=K+1",
+		"120 A=K/2*3+4-5",
+		"130 GOSUB 200",
+		"140 FOR L=1 TO 5",
+		"150 NEXT L",
+		"160 IF K<1000 THEN 110",
+		"170 END",
+		"200 RETURN",
+		nullptr
+	};
+
+	static const char* bm7_[] = {
+		"100 K=0",
+		"110 K=K+1",
+		"120 A=K/2*3+4-5",
+		"130 GOSUB 200",
+		"140 FOR L=1 TO 5",
+		"150 @(L)=A",
+		"160 NEXT L",
+		"170 IF K<1000 THEN 110",
+		"180 END",
+		"200 RETURN",
+		nullptr
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	テキストのまま実行するインタープリター（比較用） @n
+				実行の度に、キーワード、数値、変数名を文字列から解析し、 @n
+				GOTO、GOSUB は、行を先頭から探す。 @n
+				ベンチマークの命令だけで、１行に１命令、FOR は STEP 無し。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class text_basic {
+		static constexpr uint8_t LNUM = 32;
+		static constexpr uint8_t NEST = 8;
+
+		struct line_t {
+			uint32_t	num;
+			const char*	text;
+		};
+		line_t		line_[LNUM];
+		uint8_t		lnum_;
+
+		int32_t		var_[26];
+		int32_t		arr_[64];
+
+		struct for_t {
+			uint8_t	var;
+			int32_t	to;
+			uint8_t	line;	///< FOR の次の行
+		};
+		for_t		for_[NEST];
+		uint8_t		for_pos_;
+		uint8_t		gosub_[NEST];
+		uint8_t		gosub_pos_;
+
+		const char*	p_;
+		uint8_t		next_;
+		bool		end_;
+		bool		error_;
+
+		void skip_() { while(*p_ == ' ') ++p_; }
+
+		bool match_(const char* key)
+		{
+			skip_();
+			uint8_t n = strlen(key);
+			if(strncmp(p_, key, n) != 0) return false;
+			p_ += n;
+			return true;
+		}
+
+		int32_t* var_ref_()
+		{
+			skip_();
+			if(*p_ >= 'A' && *p_ <= 'Z') return &var_[*p_++ - 'A'];
+			if(*p_ == '@') {
+				++p_;
+				int32_t i = factor_();
+				if(i >= 0 && i < 64) return &arr_[i];
+			}
+			error_ = true;
+			return &var_[0];
+		}
+
+		int32_t factor_()
+		{
+			skip_();
+			char ch = *p_;
+			if(ch >= '0' && ch <= '9') {
+				int32_t v = 0;
+				while(*p_ >= '0' && *p_ <= '9') v = v * 10 + (*p_++ - '0');
+				return v;
+			} else if(ch == '(') {
+				++p_;
+				int32_t v = expr_();
+				if(!match_(")")) error_ = true;
+				return v;
+			} else if(ch == '-') {
+				++p_;
+				return -factor_();
+			}
+			return *var_ref_();
+		}
+
+		int32_t term_()
+		{
+			int32_t v = factor_();
+			for(;;) {
+				skip_();
+				if(*p_ == '*') {
+					++p_;
+					v *= factor_();
+				} else if(*p_ == '/') {
+					++p_;
+					int32_t d = factor_();
+					if(d == 0) {
+						error_ = true;
+						return 0;
+					}
+					v /= d;
+				} else {
+					return v;
+				}
+			}
+		}
+
+		int32_t add_()
+		{
+			int32_t v = term_();
+			for(;;) {
+				skip_();
+				if(*p_ == '+') {
+					++p_;
+					v += term_();
+				} else if(*p_ == '-') {
+					++p_;
+					v -= term_();
+				} else {
+					return v;
+				}
+			}
+		}
+
+		int32_t expr_()
+		{
+			int32_t a = add_();
+			if(match_("<=")) return a <= add_();
+			if(match_(">=")) return a >= add_();
+			if(match_("<>")) return a != add_();
+			if(match_("<")) return a < add_();
+			if(match_(">")) return a > add_();
+			if(match_("=")) return a == add_();
+			return a;
+		}
+
+		void jump_(int32_t num)
+		{
+			for(uint8_t i = 0; i < lnum_; ++i) {
+				if(line_[i].num == static_cast<uint32_t>(num)) {
+					next_ = i;
+					return;
+				}
+			}
+			error_ = true;
+		}
+
+		void let_()
+		{
+			int32_t* v = var_ref_();
+			if(!match_("=")) {
+				error_ = true;
+				return;
+			}
+			*v = expr_();
+		}
+
+		// 文の先頭のキーワードを、表の先頭から探す
+		int8_t keyword_()
+		{
+			static const char* key[] = {
+				"PRINT", "LET", "IF", "GOTO", "GOSUB", "RETURN",
+				"FOR", "NEXT", "REM", "END", "STOP"
+			};
+			for(uint8_t i = 0; i < (sizeof(key) / sizeof(key[0])); ++i) {
+				if(match_(key[i])) return i;
+			}
+			return -1;
+		}
+
+		void statement_()
+		{
+			switch(keyword_()) {
+			case 2:  // IF
+				{
+					int32_t v = expr_();
+					if(!match_("THEN")) error_ = true;
+					if(v != 0) {
+						skip_();
+						if(*p_ >= '0' && *p_ <= '9') jump_(expr_());
+						else statement_();
+					}
+				}
+				break;
+			case 3:  // GOTO
+				jump_(expr_());
+				break;
+			case 4:  // GOSUB
+				if(gosub_pos_ >= NEST) {
+					error_ = true;
+					break;
+				}
+				gosub_[gosub_pos_++] = next_;
+				jump_(expr_());
+				break;
+			case 5:  // RETURN
+				if(gosub_pos_ == 0) {
+					error_ = true;
+					break;
+				}
+				next_ = gosub_[--gosub_pos_];
+				break;
+			case 6:  // FOR
+				if(for_pos_ >= NEST) {
+					error_ = true;
+					break;
+				}
+				{
+					auto& f = for_[for_pos_];
+					skip_();
+					f.var = *p_ - 'A';
+					let_();
+					if(!match_("TO")) error_ = true;
+					f.to = expr_();
+					f.line = next_;
+					++for_pos_;
+				}
+				break;
+			case 7:  // NEXT
+				if(for_pos_ == 0) {
+					error_ = true;
+					break;
+				}
+				{
+					auto& f = for_[for_pos_ - 1];
+					if(++var_[f.var] <= f.to) next_ = f.line;
+					else --for_pos_;
+				}
+				break;
+			case 8:  // REM
+				break;
+			case 9:  // END
+			case 10: // STOP
+				end_ = true;
+				break;
+			case 1:  // LET
+			case -1:
+				let_();
+				break;
+			default:  // PRINT は無し
+				error_ = true;
+				break;
+			}
+		}
+
+	public:
+		text_basic() : lnum_(0) { }
+
+		// 行番号の昇順に並んだプログラム
+		bool load(const char** prog)
+		{
+			lnum_ = 0;
+			for(uint32_t i = 0; prog[i] != nullptr; ++i) {
+				if(lnum_ >= LNUM) return false;
+				const char* t = prog[i];
+				uint32_t num = 0;
+				while(*t >= '0' && *t <= '9') num = num * 10 + (*t++ - '0');
+				line_[lnum_].num = num;
+				line_[lnum_].text = t;
+				++lnum_;
+			}
+			return true;
+		}
+
+		bool run()
+		{
+			memset(var_, 0, sizeof(var_));
+			memset(arr_, 0, sizeof(arr_));
+			for_pos_ = 0;
+			gosub_pos_ = 0;
+			end_ = false;
+			error_ = false;
+			uint8_t cur = 0;
+			while(cur < lnum_ && !end_ && !error_) {
+				p_ = line_[cur].text;
+				next_ = cur + 1;
+				statement_();
+				cur = next_;
+			}
+			return !error_;
+		}
+
+		int32_t get_var(char ch) const { return var_[ch - 'A']; }
+	};
+
+
+	template <class FUNC>
+	double time_(FUNC func, uint32_t loop)
+	{
+		auto st = std::chrono::steady_clock::now();
+		for(uint32_t i = 0; i < loop; ++i) {
+			if(!func()) return -1.0;
+		}
+		auto ed = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::micro>(ed - st).count() / loop;
+	}
+
+
+	double	total_;
+	double	text_total_;
+
+	bool bench_(const char* name, const char** prog, int32_t k, uint32_t loop)
+	{
+		static BASIC basic;
+		basic.clear();
+		for(uint32_t i = 0; prog[i] != nullptr; ++i) {
+			if(!basic.service(prog[i])) return false;
+		}
+		static text_basic text;
+		if(!text.load(prog)) return false;
+
+		double us = time_([&]() { return basic.service("RUN"); }, loop);
+		double ts = time_([&]() { return text.run(); }, loop);
+		if(us < 0.0 || ts < 0.0 || basic.get_var('K') != k || text.get_var('K') != k) {
+			printf("%s: K = %d, %d (text): NG\n", name, basic.get_var('K'), text.get_var('K'));
+			return false;
+		}
+		printf("%s: %9.1f us/run (%u bytes, %u lines), text %9.1f us/run (x%.1f)\n", name, us,
+			basic.size(), basic.lines(), ts, ts / us);
+		total_ += us;
+		text_total_ += ts;
+		return true;
+	}
+
+
+	// 32767 を超える行番号（T_NUM32）への IF THEN
+	bool if_line_()
+	{
+		static const char* prog[] = {
+			"10 K=0",
+			"20 IF K=0 THEN 40000",
+			"30 K=2",
+			"40 END",
+			"40000 K=1",
+			"40010 END",
+			nullptr
+		};
+		static BASIC basic;
+		basic.clear();
+		for(uint32_t i = 0; prog[i] != nullptr; ++i) {
+			if(!basic.service(prog[i])) return false;
+		}
+		if(!basic.service("RUN") || basic.get_var('K') != 1) {
+			printf("IF THEN 40000: NG (K = %d)\n", basic.get_var('K'));
+			return false;
+		}
+		return true;
+	}
+
+
+	// 分岐先キャッシュ：行を挿入した後も、正しい行に分岐する
+	bool jump_cache_()
+	{
+		static const char* prog[] = {
+			"10 K=0",
+			"20 GOSUB 100",
+			"30 IF K<3 THEN 20",
+			"40 END",
+			"100 K=K+1",
+			"110 RETURN",
+			nullptr
+		};
+		static BASIC basic;
+		basic.clear();
+		for(uint32_t i = 0; prog[i] != nullptr; ++i) {
+			if(!basic.service(prog[i])) return false;
+		}
+		if(!basic.service("RUN") || basic.get_var('K') != 3) {
+			printf("GOSUB 100: NG (K = %d)\n", basic.get_var('K'));
+			return false;
+		}
+		// 分岐先の行の位置が変わる（古い分岐先は 50 の行になる）
+		if(!basic.service("50 K=K+10") || !basic.service("RUN") || basic.get_var('K') != 3) {
+			printf("GOSUB 100 (edited): NG (K = %d)\n", basic.get_var('K'));
+			return false;
+		}
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t loop = 1000;
+	if(argc >= 2) loop = strtoul(argv[1], nullptr, 10);
+	if(loop == 0) loop = 1;
+
+	bool ok = if_line_();
+	ok = jump_cache_() && ok;
+	ok = bench_("BM1", bm1_, 1001, loop) && ok;
+	ok = bench_("BM2", bm2_, 1000, loop) && ok;
+	ok = bench_("BM3", bm3_, 1000, loop) && ok;
+	ok = bench_("BM4", bm4_, 1000, loop) && ok;
+	ok = bench_("BM5", bm5_, 1000, loop) && ok;
+	ok = bench_("BM6", bm6_, 1000, loop) && ok;
+	ok = bench_("BM7", bm7_, 1000, loop) && ok;
+	if(ok) {
+		static const double target = 10.0;
+		double r = text_total_ / total_;
+		printf("BM1-7: %9.1f us, text %9.1f us (x%.1f)\n", total_, text_total_, r);
+		if(r >= target) {
+			printf("Target x%.0f: met\n", target);
+		} else {
+			printf("Target x%.0f: NOT MET (x%.1f, %.1f times short)\n", target, r, target / r);
+		}
+	}
+
+	return ok ? 0 : 1;
+}
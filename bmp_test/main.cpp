@@ -0,0 +1,397 @@
+//=====================================================================//
+/*!	@file
+	@brief	BMP280、BMP180 の整数演算テスト（ホスト用） @n
+			I2C のレジスタ・モデルに、補正データと A/D 変換値を置き、 @n
+			ドライバーの 32 ビット演算の結果を、64 ビット演算の結果と比較する。 @n
+			A/D 変換値は、データシートの計算例と、動作範囲の掃引を使う。 @n
+			また、altitude の高度を、pow() を使う計算と比較する。 @n
+			bmp_test
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include "chip/BMP280.hpp"
+#include "chip/BMP180.hpp"
+#include "common/altitude.hpp"
+
+namespace {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	I2C レジスタ・モデル（send の先頭バイトがレジスタ番号）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct i2c_model {
+		uint8_t	reg_[256];
+		uint8_t	ptr_;
+		uint32_t	trans_;
+		void (*write_)(i2c_model& m, uint8_t reg, uint8_t data);
+
+		i2c_model() : reg_{ 0 }, ptr_(0), trans_(0), write_(nullptr) { }
+
+		bool send(uint8_t adr, const uint8_t* src, uint8_t len) {
+			++trans_;
+			ptr_ = src[0];
+			for(uint8_t i = 1; i < len; ++i) {
+				reg_[ptr_] = src[i];
+				if(write_ != nullptr) write_(*this, ptr_, src[i]);
+				++ptr_;
+			}
+			return true;
+		}
+
+		bool recv(uint8_t adr, uint8_t* dst, uint8_t len) {
+			++trans_;
+			for(uint8_t i = 0; i < len; ++i) {
+				dst[i] = reg_[ptr_];
+				++ptr_;
+			}
+			return true;
+		}
+
+		void set16le(uint8_t reg, uint16_t v) {
+			reg_[reg] = v;
+			reg_[reg + 1] = v >> 8;
+		}
+
+		void set16be(uint8_t reg, uint16_t v) {
+			reg_[reg] = v >> 8;
+			reg_[reg + 1] = v;
+		}
+	};
+
+	//=================================================================//
+	// BMP280
+	//=================================================================//
+
+	struct bmp280_calib_t {
+		uint16_t	T1;
+		int16_t		T2;
+		int16_t		T3;
+		uint16_t	P1;
+		int16_t		P2;
+		int16_t		P3;
+		int16_t		P4;
+		int16_t		P5;
+		int16_t		P6;
+		int16_t		P7;
+		int16_t		P8;
+		int16_t		P9;
+	};
+
+	// データシート 3.12 節の計算例（adc_T = 519888, adc_P = 415148）
+	static const bmp280_calib_t bmp280_ds_ = {
+		27504, 26435, -1000,
+		36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000
+	};
+
+	// データシートの整数演算（64 ビット）をそのまま書いた参照
+	struct bmp280_ref {
+		const bmp280_calib_t& c;
+		int32_t t_fine;
+
+		int32_t temp(int32_t adc_T) {
+			int32_t var1 = ((((adc_T >> 3) - (static_cast<int32_t>(c.T1) << 1))) * c.T2) >> 11;
+			int32_t var2 = (((((adc_T >> 4) - c.T1) * ((adc_T >> 4) - c.T1)) >> 12) * c.T3) >> 14;
+			t_fine = var1 + var2;
+			return (t_fine * 5 + 128) >> 8;
+		}
+
+		int64_t press_q8(int32_t adc_P) {
+			int64_t var1 = static_cast<int64_t>(t_fine) - 128000;
+			int64_t var2 = var1 * var1 * c.P6;
+			var2 = var2 + ((var1 * c.P5) << 17);
+			var2 = var2 + (static_cast<int64_t>(c.P4) << 35);
+			var1 = ((var1 * var1 * c.P3) >> 8) + ((var1 * c.P2) << 12);
+			var1 = ((static_cast<int64_t>(1) << 47) + var1) * c.P1 >> 33;
+			if(var1 == 0) return 0;
+			int64_t p = 1048576 - adc_P;
+			p = (((p << 31) - var2) * 3125) / var1;
+			var1 = (static_cast<int64_t>(c.P9) * (p >> 13) * (p >> 13)) >> 25;
+			var2 = (static_cast<int64_t>(c.P8) * p) >> 19;
+			return ((p + var1 + var2) >> 8) + (static_cast<int64_t>(c.P7) << 4);
+		}
+	};
+
+	void set_bmp280_(i2c_model& m, const bmp280_calib_t& c)
+	{
+		m.reg_[0xD0] = 0x58;
+		const uint16_t* p = &c.T1;
+		for(uint8_t i = 0; i < 12; ++i) {
+			m.set16le(0x88 + i * 2, p[i]);
+		}
+	}
+
+	void set_bmp280_raw_(i2c_model& m, int32_t adc_T, int32_t adc_P)
+	{
+		m.reg_[0xF7] = adc_P >> 12;
+		m.reg_[0xF8] = adc_P >> 4;
+		m.reg_[0xF9] = (adc_P << 4) & 0xf0;
+		m.reg_[0xFA] = adc_T >> 12;
+		m.reg_[0xFB] = adc_T >> 4;
+		m.reg_[0xFC] = (adc_T << 4) & 0xf0;
+	}
+
+	// 補正データを、個体差程度（±2 ％）ずらす
+	bmp280_calib_t vary_(const bmp280_calib_t& c)
+	{
+		bmp280_calib_t t = c;
+		int16_t* p = &t.P2;
+		for(uint8_t i = 0; i < 8; ++i) {
+			int32_t v = p[i];
+			v += v * ((rand() % 41) - 20) / 1000;
+			if(v > 32767) v = 32767;
+			else if(v < -32768) v = -32768;
+			p[i] = v;
+		}
+		t.T1 += (rand() % 201) - 100;
+		t.P1 += (rand() % 201) - 100;
+		return t;
+	}
+
+	static constexpr int32_t BMP280_LIMIT = 8;	///< 32 ビット版の許容誤差 [Pa]
+
+	bool test_bmp280_()
+	{
+		i2c_model m;
+		chip::BMP280<i2c_model> bmp(m);
+
+		// データシートの計算例
+		set_bmp280_(m, bmp280_ds_);
+		if(!bmp.start()) {
+			printf("BMP280: start NG\n");
+			return false;
+		}
+		set_bmp280_raw_(m, 519888, 415148);
+		int32_t t;
+		int32_t p;
+		m.trans_ = 0;
+		bmp.get(t, p);
+		uint32_t trans = m.trans_;
+		int32_t p64 = bmp.get_pressure();
+		printf("BMP280: datasheet: %d.%02d C, %d Pa (64 bits: %d Pa), %u transfers/get\n",
+			t / 100, t % 100, p, p64, trans);
+		if(t != 2508 || p64 != 100653 || std::abs(p - p64) > BMP280_LIMIT || trans != 2) {
+			printf("BMP280: datasheet NG\n");
+			return false;
+		}
+
+		// 温度 -40 ～ 85 ℃、気圧 300 ～ 1100 hPa の範囲を掃引する
+		int32_t err = 0;
+		uint32_t num = 0;
+		for(uint16_t dev = 0; dev < 10; ++dev) {
+			bmp280_calib_t c = dev == 0 ? bmp280_ds_ : vary_(bmp280_ds_);
+			set_bmp280_(m, c);
+			bmp.start();
+			bmp280_ref ref{ c, 0 };
+			for(int32_t adc_T = 0; adc_T < 1048576; adc_T += 1021) {
+				int32_t tr = ref.temp(adc_T);
+				if(tr < -4000 || tr > 8500) continue;
+				for(int32_t adc_P = 0; adc_P < 1048576; adc_P += 509) {
+					int32_t pr = ref.press_q8(adc_P) >> 8;
+					if(pr < 30000 || pr > 110000) continue;
+					set_bmp280_raw_(m, adc_T, adc_P);
+					bmp.get(t, p);
+					if(t != tr) {
+						printf("BMP280: temperature NG: adc_T %d: %d != %d\n", adc_T, t, tr);
+						return false;
+					}
+					int32_t d = std::abs(p - pr);
+					if(d > err) err = d;
+					if(d > BMP280_LIMIT) {
+						printf("BMP280: pressure NG: adc_T %d, adc_P %d: %d != %d\n", adc_T, adc_P, p, pr);
+						return false;
+					}
+					++num;
+				}
+			}
+		}
+		printf("BMP280: %u samples, 32 bits vs 64 bits: max %d Pa (limit %d Pa)\n", num, err, BMP280_LIMIT);
+		return true;
+	}
+
+	//=================================================================//
+	// BMP180
+	//=================================================================//
+
+	struct bmp180_calib_t {
+		int16_t		ac1;
+		int16_t		ac2;
+		int16_t		ac3;
+		uint16_t	ac4;
+		uint16_t	ac5;
+		uint16_t	ac6;
+		int16_t		b1;
+		int16_t		b2;
+		int16_t		mb;
+		int16_t		mc;
+		int16_t		md;
+	};
+
+	// データシート 3.5 節の計算例（UT = 27898, UP = 23843, oss = 0）
+	static const bmp180_calib_t bmp180_ds_ = {
+		408, -72, -14383, 32741, 32757, 23153, 6190, 4, -32768, -8711, 2868
+	};
+
+	// データシートの計算（64 ビット）
+	struct bmp180_ref {
+		const bmp180_calib_t& c;
+		uint8_t oss;
+
+		int64_t b5(int64_t ut) const {
+			int64_t x1 = ((ut - c.ac6) * c.ac5) >> 15;
+			int64_t x2 = (static_cast<int64_t>(c.mc) << 11) / (x1 + c.md);
+			return x1 + x2;
+		}
+
+		int32_t temp(int64_t ut) const {
+			return ((b5(ut) + 8) >> 4) * 10;  // 0.1 ℃ -> 0.01 ℃
+		}
+
+		int32_t press(int64_t ut, int64_t up) const {
+			int64_t b6 = b5(ut) - 4000;
+			int64_t x1 = (c.b2 * ((b6 * b6) >> 12)) >> 11;
+			int64_t x2 = (c.ac2 * b6) >> 11;
+			int64_t x3 = x1 + x2;
+			int64_t b3 = (((static_cast<int64_t>(c.ac1) * 4 + x3) << oss) + 2) / 4;
+			x1 = (c.ac3 * b6) >> 13;
+			x2 = (c.b1 * ((b6 * b6) >> 12)) >> 16;
+			x3 = ((x1 + x2) + 2) >> 2;
+			int64_t b4 = (c.ac4 * (x3 + 32768)) >> 15;
+			int64_t b7 = (up - b3) * (50000 >> oss);
+			int64_t p = (b7 * 2) / b4;
+			x1 = (p >> 8) * (p >> 8);
+			x1 = (x1 * 3038) >> 16;
+			x2 = (-7357 * p) >> 16;
+			return p + ((x1 + x2 + 3791) >> 4);
+		}
+	};
+
+	uint16_t bmp180_ut_;
+	uint32_t bmp180_up_;
+
+	// CONTROL への書き込みで、変換結果をデータ・レジスタに置く
+	void bmp180_write_(i2c_model& m, uint8_t reg, uint8_t data)
+	{
+		if(reg != 0xF4) return;
+		if(data == 0x2E) {
+			m.set16be(0xF6, bmp180_ut_);
+		} else if((data & 0x3f) == 0x34) {
+			uint8_t oss = data >> 6;
+			uint32_t v = bmp180_up_ << (8 - oss);
+			m.reg_[0xF6] = v >> 16;
+			m.reg_[0xF7] = v >> 8;
+			m.reg_[0xF8] = v;
+		}
+	}
+
+	static constexpr int32_t BMP180_LIMIT = 2;	///< 32 ビット版の許容誤差 [Pa]
+
+	bool test_bmp180_()
+	{
+		{
+			bmp180_ref ref{ bmp180_ds_, 0 };
+			int32_t t = ref.temp(27898);
+			int32_t p = ref.press(27898, 23843);
+			if(t != 1500 || p != 69964) {
+				printf("BMP180: reference NG: %d, %d\n", t, p);
+				return false;
+			}
+		}
+
+		i2c_model m;
+		m.write_ = bmp180_write_;
+		m.reg_[0xD0] = 0x55;
+		const uint16_t* c = reinterpret_cast<const uint16_t*>(&bmp180_ds_);
+		for(uint8_t i = 0; i < 11; ++i) {
+			m.set16be(0xAA + i * 2, c[i]);
+		}
+		chip::BMP180<i2c_model> bmp(m);
+		if(!bmp.start()) {
+			printf("BMP180: start NG\n");
+			return false;
+		}
+
+		// ドライバーは ULTRAHIGHRES（oss = 3）
+		bmp180_ref ref{ bmp180_ds_, 3 };
+		int32_t err = 0;
+		int32_t terr = 0;
+		uint32_t num = 0;
+		for(uint32_t ut = 16000; ut < 40000; ut += 97) {
+			int32_t tr = ref.temp(ut);
+			if(tr < -4000 || tr > 8500) continue;
+			for(uint32_t up = 0; up < 0x80000; up += 613) {
+				int32_t pr = ref.press(ut, up);
+				if(pr < 30000 || pr > 110000) continue;
+				bmp180_ut_ = ut;
+				bmp180_up_ = up;
+				int32_t t;
+				int32_t p;
+				bmp.get(t, p);
+				// ドライバーは (B5 + 8) / 8 * 5 で、0.01 ℃ 単位にする
+				int32_t td = std::abs(t - tr);
+				if(td > terr) terr = td;
+				int32_t d = std::abs(p - pr);
+				if(d > err) err = d;
+				if(d > BMP180_LIMIT || td > 5) {
+					printf("BMP180: NG: UT %u, UP %u: %d != %d, %d != %d\n", ut, up, p, pr, t, tr);
+					return false;
+				}
+				++num;
+			}
+		}
+		printf("BMP180: %u samples, 32 bits vs 64 bits: max %d Pa (limit %d Pa), %d.%02d C\n",
+			num, err, BMP180_LIMIT, terr / 100, terr % 100);
+		return true;
+	}
+
+	//=================================================================//
+	// altitude
+	//=================================================================//
+
+	bool test_altitude_()
+	{
+		static const int32_t seas[] = { 101325, 98000, 103500 };
+		int32_t err_hi = 0;
+		int32_t err_lo = 0;
+		for(int32_t sea : seas) {
+			for(int32_t pa = 50000; pa <= 110000; pa += 7) {
+				// テーブルの範囲（気圧比 0.5 ～ 1.125）の外は、端の値に張り付く
+				if(pa * 2 < sea) continue;
+				double ref = 44330.0 * (1.0 - std::pow(static_cast<double>(pa) / sea, 0.1903)) * 100.0;
+				int32_t h = utils::altitude<>::get(pa, sea);
+				int32_t d = static_cast<int32_t>(std::fabs(h - ref) + 0.5);
+				if(pa >= 90000) {
+					if(d > err_hi) err_hi = d;
+				} else {
+					if(d > err_lo) err_lo = d;
+				}
+			}
+		}
+		printf("altitude: max %d cm (>= 90 kPa), %d cm (50 - 90 kPa)\n", err_hi, err_lo);
+		return err_hi <= 8 && err_lo <= 19;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	srand(1);
+
+	bool ok = true;
+	ok = test_bmp280_() && ok;
+	ok = test_bmp180_() && ok;
+	ok = test_altitude_() && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK\n");
+	return 0;
+}
@@ -3,7 +3,9 @@
 /*!	@file
 	@brief	AD9833 class @n
 			ANALOG DEVICES @n
-			Interface: SPI, Vcc: 3.3V to 5V
+			Interface: SPI, Vcc: 3.3V to 5V @n
+			周波数ワードは整数（逆数の乗算）で求め、スイープは FREQ0/FREQ1 を @n
+			交互に使って、位相が連続したまま切り替える。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -53,6 +55,17 @@ namespace chip {
 
 	private:
 		static const uint32_t POW2_28 = 268435456;		// 2^28 used in frequency word calculation
+
+		// 0.001Hz 単位からの周波数ワード変換係数 RECIP = 2^(60 + RSHIFT) / (REFCLK * 1000) @n
+		// 32 ビットに収まる範囲で、最大の精度を選ぶ（コンパイル時に計算）
+		static constexpr unsigned long long DIV_ = static_cast<unsigned long long>(REFCLK) * 1000;
+		static constexpr unsigned long long P60_ = static_cast<unsigned long long>(1) << 60;
+		static constexpr uint8_t rshift_(uint8_t s) {
+			return ((P60_ / DIV_ + 1) << (s + 1)) >= (static_cast<unsigned long long>(1) << 32) ? s : rshift_(s + 1);
+		}
+		static constexpr uint8_t RSHIFT = rshift_(0);
+		static constexpr uint32_t RECIP = ((P60_ / DIV_) << RSHIFT) + (((P60_ % DIV_) << RSHIFT) + DIV_ / 2) / DIV_;
+		static_assert(REFCLK >= 1000000 && RSHIFT >= 1, "REFCLK out of range");
 		static constexpr float BITS_PER_DEG = 11.3777777777778f;	// 4096 / 360
 
 		static const uint16_t RESET_CMD = 0x0100;		// Reset enabled
@@ -91,6 +104,14 @@ namespace chip {
 		bool		output_enabled_;
 		bool		dac_disabled_;
 		bool		int_clk_disabled_;
+		bool		ctrl_sync_;
+
+		// スイープ
+		const uint32_t*	sweep_tbl_;
+		volatile uint16_t	sweep_num_;
+		volatile uint16_t	sweep_pos_;
+		uint16_t	sweep_ctrl_[2];	///< FREQ0/FREQ1 を選択する制御ワード
+		bool		sweep_loop_;
 
 		void write_(uint16_t cmd)
 		{
@@ -100,21 +121,47 @@ namespace chip {
 			SEL::P = 1;
 		}
 
+		// FSYNC を Low のまま、複数のワードを連続して送る
+		void write_(const uint16_t* cmd, uint8_t num)
+		{
+			SEL::P = 0;	// FSYNC = low
+			for(uint8_t i = 0; i < num; ++i) {
+				spi_.xchg(cmd[i] >> 8);
+				spi_.xchg(cmd[i]);
+			}
+			SEL::P = 1;
+		}
 
-		void write_ctrl_()
+		// 周波数ワードを、LSB、MSB の順に並べる（B28 = 1 の場合）
+		static void freq_cmd_(REGISTERS regs, uint32_t fword, uint16_t* cmd)
 		{
-			uint16_t wave_form;
+			uint16_t reg = (regs == REGISTERS::REG1) ? FREQ1_WRITE_REG : FREQ0_WRITE_REG;
+			cmd[0] = (static_cast<uint16_t>(fword) & 0x3FFF) | reg;
+			cmd[1] = (static_cast<uint16_t>(fword >> 14) & 0x3FFF) | reg;
+		}
 
-			// TODO: can speed things up by keeping a writeReg0 and writeReg1
-			// that presets all bits during the various setup function calls
-			// rather than setting flags. Then we could just call WriteRegister
-			// directly.
-			if(active_freq_ == REGISTERS::REG0) {
-				wave_form = wave_form0_;
-				wave_form &= ~FREQ1_OUTPUT_REG;
-			} else {
-				wave_form = wave_form1_;
+		// 32 x 32 の上位 32 ビット（16 x 16 の乗算だけで求める）
+		static uint32_t mulhi_(uint32_t a, uint32_t b)
+		{
+			uint16_t al = a;
+			uint16_t ah = a >> 16;
+			uint16_t bl = b;
+			uint16_t bh = b >> 16;
+			uint32_t ll = static_cast<uint32_t>(al) * bl;
+			uint32_t lh = static_cast<uint32_t>(al) * bh;
+			uint32_t hl = static_cast<uint32_t>(ah) * bl;
+			uint32_t hh = static_cast<uint32_t>(ah) * bh;
+			uint32_t mid = (ll >> 16) + (lh & 0xFFFF) + (hl & 0xFFFF);
+			return hh + (lh >> 16) + (hl >> 16) + (mid >> 16);
+		}
+
+
+		uint16_t make_ctrl_(REGISTERS fq, uint16_t wave_form) const
+		{
+			if(fq == REGISTERS::REG1) {
 				wave_form |=  FREQ1_OUTPUT_REG;
+			} else {
+				wave_form &= ~FREQ1_OUTPUT_REG;
 			}
 
 			if(active_phase_ == REGISTERS::REG0) {
@@ -140,7 +187,18 @@ namespace chip {
 			} else {
 				wave_form &= ~DISABLE_INT_CLK;
 			}
-			write_(wave_form);
+			return wave_form;
+		}
+
+
+		void write_ctrl_()
+		{
+			if(active_freq_ == REGISTERS::REG0) {
+				write_(make_ctrl_(active_freq_, wave_form0_));
+			} else {
+				write_(make_ctrl_(active_freq_, wave_form1_));
+			}
+			ctrl_sync_ = true;
 		}
 
 
@@ -169,7 +227,9 @@ namespace chip {
 			wave_form0_(SINE_WAVE), wave_form1_(SINE_WAVE),
 			freq0_(1.0f), freq1_(1.0f), phase0_(0.0f), phase1_(0.0f),
 			active_freq_(REGISTERS::REG0), active_phase_(REGISTERS::REG0),
-			output_enabled_(false), dac_disabled_(false), int_clk_disabled_(false)
+			output_enabled_(false), dac_disabled_(false), int_clk_disabled_(false),
+			ctrl_sync_(false),
+			sweep_tbl_(nullptr), sweep_num_(0), sweep_pos_(0), sweep_ctrl_{ 0, 0 }, sweep_loop_(false)
 		{ }
 
 
@@ -191,7 +251,9 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		void reset()
 		{
+			sweep_num_ = 0;
 			write_(RESET_CMD);
+			ctrl_sync_ = false;
 			utils::delay::milli_second(10);
 		}
 
@@ -220,16 +282,157 @@ namespace chip {
 			}
 
 			uint32_t fword = freq * POW2_28 / static_cast<float>(REFCLK);
-			uint16_t upper14 = static_cast<uint16_t>((fword & 0x0FFFC000) >> 14);
-			uint16_t lower14 = static_cast<uint16_t>( fword & 0x00003FFF);
-			uint16_t reg = (regs == REGISTERS::REG0) ? FREQ0_WRITE_REG : FREQ1_WRITE_REG;
-			lower14 |= reg;
-			upper14 |= reg;   
+			set_frequency_word(regs, fword);
+		}
 
-			write_ctrl_();
 
-			write_(lower14);
-			write_(upper14);
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	周波数ワードを求める（0.001Hz 単位、浮動小数点を使わない）
+			@param[in]	mhz	周波数 [0.001Hz]（4294967.295Hz まで）
+			@return 周波数ワード（28 ビット）
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t get_frequency_word(uint32_t mhz)
+		{
+			uint32_t w = mulhi_(mhz, RECIP);
+			w = (w + (static_cast<uint32_t>(1) << (RSHIFT - 1))) >> RSHIFT;
+			if(w > 0x0FFFFFFF) w = 0x0FFFFFFF;
+			return w;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	周波数ワードを設定（２ワードを、１回の FSYNC で送る）
+			@param[in]	regs	レジスター
+			@param[in]	fword	周波数ワード（28 ビット）
+		 */
+		//-----------------------------------------------------------------//
+		void set_frequency_word(REGISTERS regs, uint32_t fword)
+		{
+			if(!ctrl_sync_) write_ctrl_();  // B28 = 1 にする
+			uint16_t cmd[2];
+			freq_cmd_(regs, fword, cmd);
+			write_(cmd, 2);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	周波数を設定（0.001Hz 単位、浮動小数点を使わない）
+			@param[in]	regs	レジスター
+			@param[in]	mhz		周波数 [0.001Hz]（4294967.295Hz まで）
+		 */
+		//-----------------------------------------------------------------//
+		void set_frequency_mhz(REGISTERS regs, uint32_t mhz)
+		{
+			set_frequency_word(regs, get_frequency_word(mhz));
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スイープ・テーブルを作成（周波数ワードを直線で補間）
+			@param[out]	tbl		テーブル
+			@param[in]	num		テーブルの数（２以上）
+			@param[in]	org_mhz	開始周波数 [0.001Hz]
+			@param[in]	end_mhz	終了周波数 [0.001Hz]
+		 */
+		//-----------------------------------------------------------------//
+		static void make_sweep(uint32_t* tbl, uint16_t num, uint32_t org_mhz, uint32_t end_mhz)
+		{
+			if(num == 0) return;
+			uint32_t w = get_frequency_word(org_mhz);
+			tbl[0] = w;
+			if(num < 2) return;
+			uint32_t e = get_frequency_word(end_mhz);
+			bool down = e < w;
+			uint32_t d = down ? w - e : e - w;
+			uint16_t n = num - 1;
+			uint32_t q = d / n;
+			uint16_t r = d % n;
+			uint16_t acc = 0;
+			for(uint16_t i = 1; i < num; ++i) {
+				uint32_t s = q;
+				acc += r;
+				if(acc >= n) {
+					acc -= n;
+					++s;
+				}
+				w = down ? w - s : w + s;
+				tbl[i] = w;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スイープを開始 @n
+					sweep_task() を、TAU のインターバル割り込みから呼ぶと、 @n
+					その周期でテーブルの周波数ワードに切り替わる。
+			@param[in]	tbl		周波数ワードのテーブル（スイープ中は保持する事）
+			@param[in]	num		テーブルの数
+			@param[in]	loop	最後まで行ったら、最初に戻る場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		void start_sweep(const uint32_t* tbl, uint16_t num, bool loop = true)
+		{
+			sweep_num_ = 0;
+			if(tbl == nullptr || num == 0) return;
+			if(!ctrl_sync_) write_ctrl_();  // B28 = 1 にする
+			// 波形は、現在の出力側の設定を使う
+			uint16_t form = (active_freq_ == REGISTERS::REG1) ? wave_form1_ : wave_form0_;
+			sweep_ctrl_[0] = make_ctrl_(REGISTERS::REG0, form);
+			sweep_ctrl_[1] = make_ctrl_(REGISTERS::REG1, form);
+			sweep_tbl_ = tbl;
+			sweep_pos_ = 0;
+			sweep_loop_ = loop;
+			sweep_num_ = num;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スイープを停止（出力は、最後の周波数のまま）
+		 */
+		//-----------------------------------------------------------------//
+		void stop_sweep() { sweep_num_ = 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スイープ中か検査
+			@return スイープ中なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_sweep() const { return sweep_num_ != 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スイープ・タスク（TAU の割り込みから呼ぶ） @n
+					出力していない側のレジスターに次のワードを書き、制御ワードで @n
+					切り替える（３ワードを、１回の FSYNC で送る）。
+		 */
+		//-----------------------------------------------------------------//
+		void sweep_task()
+		{
+			uint16_t num = sweep_num_;
+			if(num == 0) return;
+			uint16_t pos = sweep_pos_;
+			REGISTERS next = (active_freq_ == REGISTERS::REG0) ? REGISTERS::REG1 : REGISTERS::REG0;
+			uint16_t cmd[3];
+			freq_cmd_(next, sweep_tbl_[pos], cmd);
+			cmd[2] = sweep_ctrl_[next == REGISTERS::REG1 ? 1 : 0];
+			write_(cmd, 3);
+			active_freq_ = next;
+			++pos;
+			if(pos >= num) {
+				if(sweep_loop_) pos = 0;
+				else sweep_num_ = 0;
+			}
+			sweep_pos_ = pos;
 		}
 
 
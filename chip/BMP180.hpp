@@ -10,6 +10,7 @@
 //=====================================================================//
 #include <cstdint>
 #include <cmath>
+#include "common/altitude.hpp"
 #include "common/iica_io.hpp"
 #include "common/delay.hpp"
 
@@ -87,6 +88,15 @@ namespace chip {
 			return (reg[0] << 8) | reg[1];
 		}
 
+		// MSB、LSB、XLSB を一回の転送で読む
+		uint32_t read24_(REG adr) {
+			uint8_t reg[3];
+			reg[0] = static_cast<uint8_t>(adr);
+			i2c_.send(BMP180_ADR_, reg, 1);
+			i2c_.recv(BMP180_ADR_, reg, 3);
+			return (static_cast<uint32_t>(reg[0]) << 16) | (static_cast<uint32_t>(reg[1]) << 8) | reg[2];
+		}
+
 		void write8_(REG a, REG b) {
 			uint8_t reg[2];
 			reg[0] = static_cast<uint8_t>(a);
@@ -100,6 +110,34 @@ namespace chip {
 			return X1 + X2;
 		}
 
+		// 圧力補正（３２ビット整数演算）[Pa]
+		int32_t compensate_p_(int32_t B5, int32_t UP) {
+			int32_t B6 = B5 - 4000;
+			int32_t X1 = (static_cast<int32_t>(b2_) * ((B6 * B6) >> 12)) >> 11;
+			int32_t X2 = (static_cast<int32_t>(ac2_) * B6) >> 11;
+			int32_t X3 = X1 + X2;
+			int32_t B3 = (((static_cast<int32_t>(ac1_) * 4 + X3) << static_cast<int8_t>(mode_)) + 2) / 4;
+
+			X1 = (static_cast<int32_t>(ac3_) * B6) >> 13;
+			X2 = (static_cast<int32_t>(b1_) * ((B6 * B6) >> 12)) >> 16;
+			X3 = ((X1 + X2) + 2) >> 2;
+			uint32_t B4 = (static_cast<uint32_t>(ac4_) * static_cast<uint32_t>(X3 + 32768)) >> 15;
+			uint32_t B7 = (static_cast<uint32_t>(UP) - B3) * static_cast<uint32_t>(50000UL >> static_cast<uint8_t>(mode_));
+
+  			int32_t p;
+			if (B7 < 0x80000000) {
+				p = (B7 * 2) / B4;
+			} else {
+				p = (B7 / B4) * 2;
+			}
+			X1 = (p >> 8) * (p >> 8);
+			X1 = (X1 * 3038) >> 16;
+			X2 = (-7357 * p) >> 16;
+
+			p = p + ((X1 + X2 + static_cast<int32_t>(3791)) >> 4);
+			return p;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -181,9 +219,7 @@ namespace chip {
 				break;
 			}
 
-			uint32_t raw = read16_(REG::PRESSUREDATA);
-			raw <<= 8;
-			raw |= read8_(REG::PRESSUREDATA_2);
+			uint32_t raw = read24_(REG::PRESSUREDATA);
 			raw >>= (8 - static_cast<uint8_t>(mode_));
 
 			 /* this pull broke stuff, look at it later?
@@ -239,33 +275,43 @@ namespace chip {
 			mode_ = MODE::ULTRALOWPOWER;
 #endif
 
-			int32_t B5 = computeB5_(UT);
+			return compensate_p_(computeB5_(UT), UP);
+		}
 
-			// do pressure calcs
-			int32_t B6 = B5 - 4000;
-			int32_t X1 = (static_cast<int32_t>(b2_) * ((B6 * B6) >> 12)) >> 11;
-			int32_t X2 = (static_cast<int32_t>(ac2_) * B6) >> 11;
-			int32_t X3 = X1 + X2;
-			int32_t B3 = (((static_cast<int32_t>(ac1_) * 4 + X3) << static_cast<int8_t>(mode_)) + 2) / 4;
 
-			X1 = (static_cast<int32_t>(ac3_) * B6) >> 13;
-			X2 = (static_cast<int32_t>(b1_) * ((B6 * B6) >> 12)) >> 16;
-			X3 = ((X1 + X2) + 2) >> 2;
-			uint32_t B4 = (static_cast<uint32_t>(ac4_) * static_cast<uint32_t>(X3 + 32768)) >> 15;
-			uint32_t B7 = (static_cast<uint32_t>(UP) - B3) * static_cast<uint32_t>(50000UL >> static_cast<uint8_t>(mode_));
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	温度と圧力をまとめて取得（３２ビット整数演算のみ） @n
+					温度変換は一回だけ行い、その B5 で圧力を補正する。
+			@param[out]	temp	温度（℃ * 100）
+			@param[out]	press	圧力 [Pa]
+			@return 常に「true」（BMP280 と同じ形）
+		 */
+		//-----------------------------------------------------------------//
+		bool get(int32_t& temp, int32_t& press)
+		{
+			int32_t UT = get_raw_temperature();
+			int32_t UP = get_raw_pressure();
+			int32_t B5 = computeB5_(UT);
+			temp = ((B5 + 8) >> 3) * 5;
+			press = compensate_p_(B5, UP);
+			return true;
+		}
 
-  			int32_t p;
-			if (B7 < 0x80000000) {
-				p = (B7 * 2) / B4;
-			} else {
-				p = (B7 / B4) * 2;
-			}
-			X1 = (p >> 8) * (p >> 8);
-			X1 = (X1 * 3038) >> 16;
-			X2 = (-7357 * p) >> 16;
 
-			p = p + ((X1 + X2 + static_cast<int32_t>(3791)) >> 4);
-			return p;
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	高度を返す（浮動小数点演算を使わない）
+			@param[in]	sea_pa	海面気圧 [Pa]
+			@return 高度 [cm]
+		 */
+		//-----------------------------------------------------------------//
+		int32_t get_altitude_cm(int32_t sea_pa = 101325)
+		{
+			int32_t temp;
+			int32_t press;
+			get(temp, press);
+			return utils::altitude<>::get(press, sea_pa);
 		}
 
 
@@ -10,6 +10,7 @@
 //=====================================================================//
 #include <cstdint>
 #include <cmath>
+#include "common/altitude.hpp"
 #include "common/iica_io.hpp"
 #include "common/delay.hpp"
 
@@ -119,6 +120,87 @@ namespace chip {
 			return (reg[1] << 8) | reg[0];
 		}
 
+		// 連続するレジスタを一回の転送でまとめて読む
+		void read_burst_(REG adr, uint8_t* dst, uint8_t len) {
+			dst[0] = static_cast<uint8_t>(adr);
+			i2c_.send(addr_, dst, 1);
+			i2c_.recv(addr_, dst, len);
+		}
+
+		// 圧力（0xF7 ～ 0xF9）、温度（0xFA ～ 0xFC）を一回で読み出す
+		void read_raw_(int32_t& adc_T, int32_t& adc_P) {
+			uint8_t tmp[6];
+			read_burst_(REG::PRESSUREDATA, tmp, 6);
+			adc_P = (static_cast<int32_t>(tmp[0]) << 12) | (static_cast<int32_t>(tmp[1]) << 4) | (tmp[2] >> 4);
+			adc_T = (static_cast<int32_t>(tmp[3]) << 12) | (static_cast<int32_t>(tmp[4]) << 4) | (tmp[5] >> 4);
+		}
+
+		// 温度補正（℃ * 100）、t_fine_ を更新する
+		int32_t compensate_t_(int32_t adc_T) {
+  			int32_t var1  = ((((adc_T>>3) - (static_cast<int32_t>(calib_.dig_T1) << 1))) *
+				(static_cast<int32_t>(calib_.dig_T2))) >> 11;
+
+			int32_t var2  = (((((adc_T>>4) - (static_cast<int32_t>(calib_.dig_T1))) *
+				((adc_T>>4) - (static_cast<int32_t>(calib_.dig_T1)))) >> 12) *
+				(static_cast<int32_t>(calib_.dig_T3))) >> 14;
+
+			t_fine_ = var1 + var2;
+
+			return (t_fine_ * 5 + 128) >> 8;
+		}
+
+		// 圧力補正（64 ビット演算版）[Pa]
+		int32_t compensate_p64_(int32_t adc_P) {
+			int64_t var1 = (static_cast<int64_t>(t_fine_)) - 128000;
+			int64_t var2 = var1 * var1 * static_cast<int64_t>(calib_.dig_P6);
+			var2 = var2 + ((var1 * static_cast<int64_t>(calib_.dig_P5)) << 17);
+			var2 = var2 + ((static_cast<int64_t>(calib_.dig_P4)) << 35);
+			var1 = ((var1 * var1 * static_cast<int64_t>(calib_.dig_P3)) >> 8) +
+				((var1 * static_cast<int64_t>(calib_.dig_P2)) << 12);
+			var1 = ((((static_cast<int64_t>(1)) << 47) + var1)) * (static_cast<int64_t>(calib_.dig_P1)) >> 33;
+
+			if(var1 == 0) {
+				return 0;  // avoid exception caused by division by zero
+			}
+
+			int64_t p = 1048576 - adc_P;
+			p = (((p << 31) - var2) * 3125) / var1;
+			var1 = ((static_cast<int64_t>(calib_.dig_P9)) * (p >> 13) * (p >> 13)) >> 25;
+			var2 = ((static_cast<int64_t>(calib_.dig_P8)) * p) >> 19;
+
+			p = ((p + var1 + var2) >> 8) + ((static_cast<int64_t>(calib_.dig_P7)) << 4);
+
+			return p >> 8;
+		}
+
+		// 圧力補正（32 ビット演算版、データシート 8.2 節）[Pa] @n
+		// 64 ビット版との差は、数 Pa 以内
+		int32_t compensate_p32_(int32_t adc_P) {
+			int32_t var1 = (t_fine_ >> 1) - static_cast<int32_t>(64000);
+			int32_t var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * static_cast<int32_t>(calib_.dig_P6);
+			var2 = var2 + ((var1 * static_cast<int32_t>(calib_.dig_P5)) << 1);
+			var2 = (var2 >> 2) + (static_cast<int32_t>(calib_.dig_P4) << 16);
+			var1 = (((static_cast<int32_t>(calib_.dig_P3) * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) +
+				((static_cast<int32_t>(calib_.dig_P2) * var1) >> 1)) >> 18;
+			var1 = ((32768 + var1) * static_cast<int32_t>(calib_.dig_P1)) >> 15;
+
+			if(var1 == 0) {
+				return 0;  // avoid exception caused by division by zero
+			}
+
+			uint32_t p = (static_cast<uint32_t>(static_cast<int32_t>(1048576) - adc_P) -
+				static_cast<uint32_t>(var2 >> 12)) * 3125;
+			if(p < 0x80000000) {
+				p = (p << 1) / static_cast<uint32_t>(var1);
+			} else {
+				p = (p / static_cast<uint32_t>(var1)) * 2;
+			}
+			var1 = (static_cast<int32_t>(calib_.dig_P9) *
+				static_cast<int32_t>(((p >> 3) * (p >> 3)) >> 13)) >> 12;
+			var2 = (static_cast<int32_t>(p >> 2) * static_cast<int32_t>(calib_.dig_P8)) >> 13;
+			return static_cast<int32_t>(p) + ((var1 + var2 + calib_.dig_P7) >> 4);
+		}
+
 		void write8_(REG a, uint8_t data) {
 			uint8_t reg[2];
 			reg[0] = static_cast<uint8_t>(a);
@@ -199,16 +281,7 @@ namespace chip {
 			int32_t adc_T = read24_(REG::TEMPDATA);
 			adc_T >>= 4;
 
-  			int32_t var1  = ((((adc_T>>3) - (static_cast<int32_t>(calib_.dig_T1) << 1))) *
-				(static_cast<int32_t>(calib_.dig_T2))) >> 11;
-
-			int32_t var2  = (((((adc_T>>4) - (static_cast<int32_t>(calib_.dig_T1))) *
-				((adc_T>>4) - (static_cast<int32_t>(calib_.dig_T1)))) >> 12) *
-				(static_cast<int32_t>(calib_.dig_T3))) >> 14;
-
-			t_fine_ = var1 + var2;
-
-			return (t_fine_ * 5 + 128) >> 8;
+			return compensate_t_(adc_T);
 		}
 
 
@@ -255,32 +328,36 @@ namespace chip {
 		{
 			if(addr_ == 0) return 0;
 
-			// Must be done first to get the t_fine variable set up
-			get_temperature();
+			// 温度と圧力を同じ転送で読み、t_fine を先に求める
+			int32_t adc_T;
+			int32_t adc_P;
+			read_raw_(adc_T, adc_P);
+			compensate_t_(adc_T);
 
-			int32_t adc_P = read24_(REG::PRESSUREDATA);
-			adc_P >>= 4;
-
-			int64_t var1 = (static_cast<int64_t>(t_fine_)) - 128000;
-			int64_t var2 = var1 * var1 * static_cast<int64_t>(calib_.dig_P6);
-			var2 = var2 + ((var1 * static_cast<int64_t>(calib_.dig_P5)) << 17);
-			var2 = var2 + ((static_cast<int64_t>(calib_.dig_P4)) << 35);
-			var1 = ((var1 * var1 * static_cast<int64_t>(calib_.dig_P3)) >> 8) +
-				((var1 * static_cast<int64_t>(calib_.dig_P2)) << 12);
-			var1 = ((((static_cast<int64_t>(1)) << 47) + var1)) * (static_cast<int64_t>(calib_.dig_P1)) >> 33;
-
-			if(var1 == 0) {
-				return 0.0f;  // avoid exception caused by division by zero
-			}
+			return compensate_p64_(adc_P);
+		}
 
-			int64_t p = 1048576 - adc_P;
-			p = (((p << 31) - var2) * 3125) / var1;
-			var1 = ((static_cast<int64_t>(calib_.dig_P9)) * (p >> 13) * (p >> 13)) >> 25;
-			var2 = ((static_cast<int64_t>(calib_.dig_P8)) * p) >> 19;
 
-			p = ((p + var1 + var2) >> 8) + ((static_cast<int64_t>(calib_.dig_P7)) << 4);
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	温度と圧力をまとめて取得（３２ビット整数演算のみ） @n
+					レジスタ 0xF7 ～ 0xFC を一回の I2C 転送で読み出し、 @n
+					同じ計測サイクルの温度で圧力を補正する。
+			@param[out]	temp	温度（℃ * 100）
+			@param[out]	press	圧力 [Pa]
+			@return 開始していない場合「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool get(int32_t& temp, int32_t& press)
+		{
+			if(addr_ == 0) return false;
 
-			return p >> 8;
+			int32_t adc_T;
+			int32_t adc_P;
+			read_raw_(adc_T, adc_P);
+			temp = compensate_t_(adc_T);
+			press = compensate_p32_(adc_P);
+			return true;
 		}
 
 
@@ -300,5 +377,20 @@ namespace chip {
 			return altitude;
 		}
 
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	高度を返す（浮動小数点演算を使わない）
+			@param[in]	sea_pa	海面気圧 [Pa]
+			@return 高度 [cm]
+		 */
+		//-----------------------------------------------------------------//
+		int32_t get_altitude_cm(int32_t sea_pa = 101325)
+		{
+			int32_t temp;
+			int32_t press;
+			if(!get(temp, press)) return 0;
+			return utils::altitude<>::get(press, sea_pa);
+		}
 	};
 }
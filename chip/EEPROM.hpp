@@ -1,7 +1,9 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	I2C EEPROM ドライバー
+	@brief	I2C EEPROM ドライバー @n
+			EEPROM_cache は、RAM 上にページを保持して書き込みをまとめ、 @n
+			ACK ポーリングで、１ページずつ非同期に書き込む。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -146,6 +148,28 @@ namespace chip {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ページサイズを取得
+			@return ページサイズ
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get_page_size() const { return pagen_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ACK ポーリング（デバイスアドレスだけを送る） @n
+					書き込みサイクル中のデバイスは、アドレスに ACK を返さない。
+			@param[in]	adr	検査アドレス
+			@return 「true」なら、書き込み可能
+		 */
+		//-----------------------------------------------------------------//
+		bool probe(uint32_t adr) const {
+			return i2c_.send(i2c_adr_(adr), nullptr, 0);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	書き込み状態の検査
@@ -168,16 +192,11 @@ namespace chip {
 		 */
 		//-----------------------------------------------------------------//
 		bool sync_write(uint32_t adr, uint16_t delay = 600) const {
-			bool ok = false;
-			for(uint16_t i = 0; i < delay; ++i) {
-				utils::delay::micro_second(10);
-				uint8_t tmp[1];
-				if(read(adr, tmp, 1)) {
-					ok = true;
-					break;
-				}
+			utils::deadline dl(static_cast<uint32_t>(delay) * 10);
+			while(!dl.expired(10)) {
+				if(probe(adr)) return true;
 			}
-			return ok;
+			return false;
 		}
 
 
@@ -245,4 +264,357 @@ namespace chip {
 			return true;
 		}
 	};
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  EEPROM ライトバック・キャッシュ・テンプレートクラス @n
+				書き込みは RAM 上のラインに蓄え、service() で１ページずつ書き込む。 @n
+				同じラインへの書き込みはまとめられ、値が変わらないバイトは書かない。 @n
+				書き込み待ちの印は、書き込みサイクルの終了を確認してから消す。 @n
+				service() は、タイマーの周期で、他の I2C 通信と同じコンテキストから呼ぶ。
+		@param[in]	EEP		EEPROM クラス
+		@param[in]	LINE	ラインのサイズ（2 のべき乗、デバイスのページを跨ぐ場合は、 @n
+							ページ毎に書き込む）
+		@param[in]	NUM		ラインの数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class EEP, uint8_t LINE = 32, uint8_t NUM = 4>
+	class EEPROM_cache {
+
+		static_assert(LINE >= 8 && LINE <= 128 && (LINE & (LINE - 1)) == 0, "LINE must be 8 to 128 (power of 2)");
+		static_assert(NUM >= 1, "NUM must be 1 or more");
+
+		static const uint8_t MASK_SIZE_ = LINE / 8;
+
+		struct line_t {
+			uint32_t	adr;
+			uint8_t		data[LINE];
+			uint8_t		valid[MASK_SIZE_];	///< RAM 上の値が有効なバイト
+			uint8_t		dirty[MASK_SIZE_];	///< 書き込みが必要なバイト
+			uint16_t	seq;
+			bool		use;
+		};
+
+		enum class task : uint8_t {
+			idle,	///< 待機
+			busy,	///< 書き込みサイクル中（ACK ポーリング）
+		};
+
+		EEP&		eep_;
+		line_t		line_[NUM];
+		uint16_t	seq_;
+		task		task_;
+		uint8_t		busy_line_;				///< 書き込みサイクル中のライン
+		uint8_t		busy_mask_[MASK_SIZE_];	///< 書き込みサイクル中のバイト
+		uint32_t	busy_adr_;
+		uint16_t	wait_;
+		uint16_t	timeout_;
+		bool		error_;
+
+		static bool test_(const uint8_t* m, uint8_t i) {
+			return (m[i >> 3] & (1 << (i & 7))) != 0;
+		}
+
+		static void set_(uint8_t* m, uint8_t i) {
+			m[i >> 3] |= 1 << (i & 7);
+		}
+
+		static bool any_(const uint8_t* m) {
+			for(uint8_t i = 0; i < MASK_SIZE_; ++i) {
+				if(m[i] != 0) return true;
+			}
+			return false;
+		}
+
+		uint8_t find_(uint32_t adr) const {
+			for(uint8_t i = 0; i < NUM; ++i) {
+				if(line_[i].use && line_[i].adr == adr) return i;
+			}
+			return NUM;
+		}
+
+		// 最も古い書き込みを持つラインを探す（dirty = false なら、クリーンなライン）
+		uint8_t oldest_(bool dirty) const {
+			uint8_t n = NUM;
+			for(uint8_t i = 0; i < NUM; ++i) {
+				const line_t& t = line_[i];
+				if(!t.use || any_(t.dirty) != dirty) continue;
+				if(n >= NUM || static_cast<int16_t>(t.seq - line_[n].seq) < 0) n = i;
+			}
+			return n;
+		}
+
+		// 書き込みサイクルの終了（ok が「false」なら失敗、書き込み待ちのまま残す）
+		void done_(bool ok) {
+			task_ = task::idle;
+			if(!ok) {
+				error_ = true;
+				return;
+			}
+			line_t& t = line_[busy_line_];
+			for(uint8_t i = 0; i < MASK_SIZE_; ++i) {
+				t.dirty[i] &= ~busy_mask_[i];
+			}
+		}
+
+		// 書き込みサイクルの終了を待つ（失敗の後は、デバイスが書き込みサイクル中かもしれない）
+		bool wait_ready_(uint32_t adr) {
+			if(task_ == task::busy) {
+				bool ok = eep_.sync_write(busy_adr_);
+				done_(ok);
+				return ok;
+			}
+			if(error_) return eep_.sync_write(adr);
+			return true;
+		}
+
+		// ライン内の最初の連続領域を書き込む（間に有効なバイトがあれば、まとめて書く）
+		bool send_(line_t& t) {
+			uint8_t org = 0;
+			while(org < LINE && !test_(t.dirty, org)) ++org;
+			if(org >= LINE) return true;
+			uint8_t end = org;
+			for(uint8_t i = org; i < LINE && test_(t.valid, i); ++i) {
+				if(test_(t.dirty, i)) end = i;
+			}
+			++end;
+			uint32_t adr = t.adr + org;
+			// ページを跨がない（EEP::write() が、中で書き込みサイクルを待たない様に）
+			uint8_t pg = eep_.get_page_size();
+			if(pg != 0) {
+				uint8_t lim = pg - (adr & (pg - 1));
+				if((end - org) > lim) end = org + lim;
+			}
+			if(!eep_.write(adr, &t.data[org], end - org)) {
+				error_ = true;
+				return false;
+			}
+			busy_line_ = &t - &line_[0];
+			for(uint8_t i = 0; i < MASK_SIZE_; ++i) {
+				busy_mask_[i] = 0;
+			}
+			for(uint8_t i = org; i < end; ++i) {
+				set_(busy_mask_, i);
+			}
+			busy_adr_ = adr;
+			wait_ = 0;
+			task_ = task::busy;
+			return true;
+		}
+
+		// ラインを確保する（空きが無ければ、最も古いラインを書き出す）
+		uint8_t alloc_(uint32_t adr) {
+			uint8_t n = NUM;
+			for(uint8_t i = 0; i < NUM; ++i) {
+				if(!line_[i].use) {
+					n = i;
+					break;
+				}
+			}
+			if(n >= NUM) n = oldest_(false);
+			if(n >= NUM) {
+				n = oldest_(true);
+				while(any_(line_[n].dirty)) {
+					if(!wait_ready_(line_[n].adr)) return NUM;
+					if(!send_(line_[n])) return NUM;
+				}
+			}
+			line_t& t = line_[n];
+			t.adr = adr;
+			for(uint8_t i = 0; i < MASK_SIZE_; ++i) {
+				t.valid[i] = 0;
+				t.dirty[i] = 0;
+			}
+			t.use = true;
+			return n;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	eep	EEPROM クラスを参照で渡す
+		 */
+		//-----------------------------------------------------------------//
+		EEPROM_cache(EEP& eep) : eep_(eep), line_(), seq_(0), task_(task::idle),
+			busy_line_(0), busy_mask_(), busy_adr_(0), wait_(0), timeout_(10), error_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ACK ポーリングのタイムアウトを設定
+			@param[in]	tick	service() の呼び出し回数
+		 */
+		//-----------------------------------------------------------------//
+		void set_timeout(uint16_t tick) { timeout_ = tick; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュを破棄（書き込み待ちのデータも捨てる）
+		 */
+		//-----------------------------------------------------------------//
+		void clear() {
+			for(uint8_t i = 0; i < NUM; ++i) {
+				line_[i].use = false;
+			}
+			task_ = task::idle;
+			error_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み待ちのライン数を取得
+			@return 書き込み待ちのライン数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get_pending() const {
+			uint8_t n = 0;
+			for(uint8_t i = 0; i < NUM; ++i) {
+				if(line_[i].use && any_(line_[i].dirty)) ++n;
+			}
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み中か検査
+			@return 書き込み待ち、又は、書き込みサイクル中なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_busy() const { return task_ == task::busy || get_pending() > 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エラーを取得（書き込み失敗、ACK ポーリングのタイムアウト）
+			@return エラーがあれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool get_error() const { return error_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（タイマーの周期で呼ぶ） @n
+					書き込みサイクルが終わっていれば、次のページを書き込む。
+		 */
+		//-----------------------------------------------------------------//
+		void service() {
+			if(task_ == task::busy) {
+				if(!eep_.probe(busy_adr_)) {
+					++wait_;
+					if(wait_ >= timeout_) {
+						done_(false);
+					}
+					return;
+				}
+				done_(true);
+			}
+			uint8_t n = oldest_(true);
+			if(n < NUM) {
+				send_(line_[n]);
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全ての書き込みを終える（バリア）
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool flush() {
+			while(1) {
+				if(!wait_ready_(busy_adr_)) return false;
+				uint8_t n = oldest_(true);
+				if(n >= NUM) break;
+				if(!wait_ready_(line_[n].adr)) return false;
+				if(!send_(line_[n])) return false;
+			}
+			error_ = false;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	読み出し（書き込み待ちのデータを反映する） @n
+					全てのバイトがキャッシュにあれば、デバイスをアクセスしない。
+			@param[in]	adr	読み出しアドレス
+			@param[out]	dst	先
+			@param[in]	len	長さ
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool read(uint32_t adr, uint8_t* dst, uint16_t len) {
+			while(len > 0) {
+				uint8_t ofs = adr & (LINE - 1);
+				uint8_t l = LINE - ofs;
+				if(len < l) l = len;
+				uint8_t n = find_(adr - ofs);
+				bool hit = n < NUM;
+				for(uint8_t i = 0; hit && i < l; ++i) {
+					if(!test_(line_[n].valid, ofs + i)) hit = false;
+				}
+				if(!hit) {
+					if(!wait_ready_(adr)) return false;
+					if(!eep_.read(adr, dst, l)) return false;
+				}
+				if(n < NUM) {
+					const line_t& t = line_[n];
+					for(uint8_t i = 0; i < l; ++i) {
+						if(test_(t.valid, ofs + i)) dst[i] = t.data[ofs + i];
+					}
+				}
+				adr += l;
+				dst += l;
+				len -= l;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み（キャッシュへ書き込み、すぐに戻る） @n
+					空きラインが無い場合のみ、最も古いラインの書き込みを待つ。
+			@param[in]	adr	書き込みアドレス
+			@param[in]	src	元
+			@param[in]	len	長さ
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool write(uint32_t adr, const uint8_t* src, uint16_t len) {
+			while(len > 0) {
+				uint8_t ofs = adr & (LINE - 1);
+				uint8_t l = LINE - ofs;
+				if(len < l) l = len;
+				uint8_t n = find_(adr - ofs);
+				if(n >= NUM) {
+					n = alloc_(adr - ofs);
+					if(n >= NUM) return false;
+				}
+				line_t& t = line_[n];
+				bool busy = task_ == task::busy && n == busy_line_;
+				for(uint8_t i = 0; i < l; ++i) {
+					uint8_t j = ofs + i;
+					if(!test_(t.valid, j) || t.data[j] != src[i]) {
+						t.data[j] = src[i];
+						set_(t.valid, j);
+						set_(t.dirty, j);
+						// 書き込みサイクル中のバイトは、終わっても書き込み待ちのまま
+						if(busy) busy_mask_[j >> 3] &= ~(1 << (j & 7));
+					}
+				}
+				t.seq = ++seq_;
+				adr += l;
+				src += l;
+				len -= l;
+			}
+			return true;
+		}
+	};
 }
@@ -1,7 +1,9 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	MAX7219 ドライバー
+	@brief	MAX7219 ドライバー @n
+			デージー・チェインの全デバイスに、同じ桁を１回の選択で送り、 @n
+			変更があった桁だけを転送する。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2016 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -9,7 +11,6 @@
 */
 //=====================================================================//
 #include <cstdint>
-#include <cstring>
 #include "common/iica_io.hpp"
 #include "common/time.h"
 
@@ -20,16 +21,20 @@ namespace chip {
 		@brief  MAX7219 テンプレートクラス
 		@param[in]	SPI		SPI クラス
 		@param[in]	SELECT	デバイス選択
-		@param[in]	CHAIN	デージー・チェイン数
+		@param[in]	CHAIN	デージー・チェイン数（インデックス０～７が DIN 側の先頭デバイス）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <class SPI, class SELECT, uint32_t CHAIN = 1>
 	class MAX7219 {
 
+		static const uint16_t NUM_ = CHAIN * 8;
+
 		SPI&		spi_;
 
 		uint16_t	limit_;
-		uint8_t		data_[CHAIN * 8];
+		uint8_t		data_[NUM_];
+		uint8_t		dirty_;		///< 変更があった桁（ビット毎）
+		uint8_t		intensity_;
 
 		enum class command : uint8_t {
 			NO_OP        = 0x00,
@@ -48,13 +53,30 @@ namespace chip {
 			DISPLAY_TEST = 0x0F,
 		};
 
-		// MAX7212 MSB first, 2 bytes
+		// MAX7212 MSB first, 2 bytes @n
+		// チェインの全デバイスに同じコマンドを送る
 		void out_(command cmd, uint8_t dat) {
+			uint8_t tmp[CHAIN * 2];
+			for(uint16_t i = 0; i < (CHAIN * 2); i += 2) {
+				tmp[i + 0] = static_cast<uint8_t>(cmd);
+				tmp[i + 1] = dat;
+			}
 			SELECT::P = 0;
-			uint8_t tmp[2];
-			tmp[0] = static_cast<uint8_t>(cmd);
-			tmp[1] = dat;
-			spi_.send(tmp, 2);
+			spi_.send(tmp, CHAIN * 2);
+			SELECT::P = 1;  // load
+		}
+
+		// 各デバイスの同じ桁を送る（最後に送ったデータが、先頭デバイスに入る）
+		void out_digit_(uint8_t digit) {
+			uint8_t tmp[CHAIN * 2];
+			uint16_t j = 0;
+			for(uint16_t i = CHAIN; i > 0; --i) {
+				tmp[j + 0] = static_cast<uint8_t>(command::DIGIT_0) + digit;
+				tmp[j + 1] = data_[(i - 1) * 8 + digit];
+				j += 2;
+			}
+			SELECT::P = 0;
+			spi_.send(tmp, CHAIN * 2);
 			SELECT::P = 1;  // load
 		}
 
@@ -65,18 +87,18 @@ namespace chip {
 			@param[in]	spi	SPI クラスを参照で渡す
 		 */
 		//-----------------------------------------------------------------//
-		MAX7219(SPI& spi) : spi_(spi), limit_(0) { }
+		MAX7219(SPI& spi) : spi_(spi), limit_(0), dirty_(0), intensity_(0xff) { }
 
 
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	開始
-			@param[in]	limit	スキャン・リミット
+			@param[in]	limit	スキャン・リミット（デバイス毎の桁数、１～８）
 			@return エラーなら「false」を返す
 		 */
 		//-----------------------------------------------------------------//
-		bool start(uint8_t limit = (CHAIN * 8)) {
-			if(limit_ > (8 * CHAIN) || limit == 0) {
+		bool start(uint8_t limit = 8) {
+			if(limit > 8 || limit == 0) {
 				return false;
 			}
 			limit_ = limit;
@@ -85,15 +107,17 @@ namespace chip {
 			SELECT::PU  = 0;  // pull-up disable
 			SELECT::P = 1;    // /CS = H
 
-			for(uint8_t i = 0; i < sizeof(data_); ++i) {
+			for(uint16_t i = 0; i < NUM_; ++i) {
 				data_[i] = 0;
 			}
 
 			out_(command::SHUTDOWN, 0x01);  // ノーマル・モード
 			out_(command::DECODE_MODE, 0x00);  // デコード・モード
 			out_(command::SCAN_LIMIT, limit - 1);  // 表示桁設定
+			intensity_ = 0xff;
 			set_intensity(0);  // 輝度（最低）
 
+			refresh();
 			service();
 
 			return true;
@@ -102,21 +126,32 @@ namespace chip {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief 輝度の設定
+			@brief 輝度の設定（値が変わった場合だけ転送する）
 			@param[in]	inten	輝度値（最小：０、最大：１５）
 			@return エラー（初期化不良）なら「false」
 		 */
 		//-----------------------------------------------------------------//
 		bool set_intensity(uint8_t inten) {
 			if(limit_ == 0) return false;
-			out_(command::INTENSITY, inten);
+			if(inten != intensity_) {
+				intensity_ = inten;
+				out_(command::INTENSITY, inten);
+			}
 			return true;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief データ転送
+			@brief 全ての桁を、次の service() で転送する
+		 */
+		//-----------------------------------------------------------------//
+		void refresh() { dirty_ = 0xff; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief データ転送（変更があった桁だけを、チェイン全体に一度に送る）
 			@return エラー（初期化不良）なら「false」
 		 */
 		//-----------------------------------------------------------------//
@@ -124,8 +159,11 @@ namespace chip {
 			if(limit_ == 0) return false;
 
 			for(uint8_t i = 0; i < limit_; ++i) {
-				out_(static_cast<command>(static_cast<uint8_t>(command::DIGIT_0) + i), data_[i]);
+				if(dirty_ & (1 << i)) {
+					out_digit_(i);
+				}
 			}
+			dirty_ = 0;
 			return true;
 		}
 
@@ -133,12 +171,12 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		/*!
 			@brief 値の取得
-			@param[in]	idx	インデックス（０～７）
+			@param[in]	idx	インデックス（０～ CHAIN * 8 - 1）
 			@return 値
 		 */
 		//-----------------------------------------------------------------//
-		uint8_t get(uint8_t idx) {
-			if(idx < limit_) {
+		uint8_t get(uint16_t idx) const {
+			if(idx < NUM_) {
 				return data_[idx];
 			}
 			return 0;
@@ -148,13 +186,14 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		/*!
 			@brief 値の設定
-			@param[in]	idx	インデックス（０～７）
+			@param[in]	idx	インデックス（０～ CHAIN * 8 - 1）
 			@param[in]	dat	データ
 		 */
 		//-----------------------------------------------------------------//
-		void set(uint8_t idx, uint8_t dat) {
-			if(idx < limit_) {
+		void set(uint16_t idx, uint8_t dat) {
+			if(idx < NUM_ && data_[idx] != dat) {
 				data_[idx] = dat;
+				dirty_ |= 1 << (idx & 7);
 			}
 		}
 
@@ -162,12 +201,12 @@ namespace chip {
 		//-----------------------------------------------------------------//
 		/*!
 			@brief キャラクターの設定
-			@param[in]	idx	インデックス（０～７）
+			@param[in]	idx	インデックス（０～ CHAIN * 8 - 1）
 			@param[in]	cha	キャラクターコード
 			@param[in]	dp	小数点
 		 */
 		//-----------------------------------------------------------------//
-		void set_cha(uint8_t idx, char cha, bool dp = false) {
+		void set_cha(uint16_t idx, char cha, bool dp = false) {
 			uint8_t d = 0;
 			switch(cha) {
 			case ' ':
@@ -327,28 +366,34 @@ namespace chip {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief シフト、バッファ先頭
+			@brief シフト、バッファ先頭（チェイン全体）
 			@param[in]	fill	埋めるデータ
+			@return 押し出された値
 		 */
 		//-----------------------------------------------------------------//
 		uint8_t shift_top(uint8_t fill = 0) {
-			uint8_t full = data_[0];
-			std::memmove(&data_[1], &data_[0], 7);
-			data_[0] = fill;
+			uint8_t full = data_[NUM_ - 1];
+			for(uint16_t i = NUM_ - 1; i > 0; --i) {
+				set(i, data_[i - 1]);
+			}
+			set(0, fill);
 			return full;
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief シフト、バッファ終端
+			@brief シフト、バッファ終端（チェイン全体）
 			@param[in]	fill	埋めるデータ
+			@return 押し出された値
 		 */
 		//-----------------------------------------------------------------//
 		uint8_t shift_end(uint8_t fill = 0) {
-			uint8_t full = data_[7];
-			std::memmove(&data_[0], &data_[1], 7);
-			data_[7] = fill;
+			uint8_t full = data_[0];
+			for(uint16_t i = 0; i < (NUM_ - 1); ++i) {
+				set(i, data_[i + 1]);
+			}
+			set(NUM_ - 1, fill);
 			return full;
 		}
 
@@ -2,6 +2,8 @@
 //=====================================================================//
 /*!	@file
 	@brief	MCP2515 CAN ドライバー @n
+			受信は INT 端子の割り込みから recv_task() を呼び、リングバッファに格納する。 @n
+			RX/TX バッファは、READ RX BUFFER、LOAD TX BUFFER 命令でまとめて転送する。 @n
 			※MCP2515 の電源は２．７Ｖ～５．５Ｖ @n
 			※ドライバーの電源は通常５Ｖなので、電源が分離されていない場合は５Ｖ駆動
     @author 平松邦仁 (hira@rvf-rc45.net)
@@ -11,6 +13,7 @@
 */
 //=====================================================================//
 #include <cstdint>
+#include "common/delay.hpp"
 
 namespace chip {
 
@@ -19,11 +22,98 @@ namespace chip {
 		@brief  MCP2515 テンプレートクラス
 		@param[in]	SPI	SPI クラス
 		@param[in]	SEL	選択クラス
+		@param[in]	RXN	受信リングバッファの数（2 のべき乗）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class SPI, class SEL>
+	template <class SPI, class SEL, uint8_t RXN = 8>
 	class MCP2515 {
 
+		static_assert(RXN >= 2 && (RXN & (RXN - 1)) == 0, "RXN must be power of 2");
+
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  CAN フレーム
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct frame_t {
+			uint32_t	id;		///< 標準 11 ビット、拡張 29 ビット
+			bool		ext;	///< 拡張フレーム
+			bool		rtr;	///< リモート・フレーム
+			uint8_t		dlc;	///< データ長（0 ～ 8）
+			uint8_t		data[8];
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  ID レジスター値（SIDH, SIDL, EID8, EID0 の順）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct id_reg_t {
+			uint8_t	r[4];
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  受信フィルター・テーブル @n
+					RXM0 と RXF0、RXF1 は RXB0、RXM1 と RXF2 ～ RXF5 は RXB1 に使われる。 @n
+					RXB0 が一杯の場合は、RXB1 に受信する（ロールオーバー）。
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct filter_t {
+			id_reg_t	mask[2];	///< RXM0, RXM1
+			id_reg_t	filt[6];	///< RXF0 ～ RXF5
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  動作モード
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class MODE : uint8_t {
+			NORMAL   = 0x00,	///< ノーマル
+			SLEEP    = 0x20,	///< スリープ
+			LOOPBACK = 0x40,	///< ループバック（バスに出力しない）
+			LISTEN   = 0x60,	///< リッスン・オンリー
+			CONFIG   = 0x80,	///< コンフィグレーション
+		};
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ID レジスター値を作る（コンパイル時に評価可能）
+			@param[in]	id	ID（フィルターでは ID、マスクでは比較するビット）
+			@param[in]	ext	拡張 ID の場合「true」
+			@return ID レジスター値
+		 */
+		//-----------------------------------------------------------------//
+		static constexpr id_reg_t id_reg(uint32_t id, bool ext = false) noexcept
+		{
+			return ext ? id_reg_t{ { static_cast<uint8_t>(id >> 21),
+				static_cast<uint8_t>(((id >> 13) & 0xE0) | 0x08 | ((id >> 16) & 0x03)),
+				static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id) } }
+				: id_reg_t{ { static_cast<uint8_t>(id >> 3),
+				static_cast<uint8_t>((id << 5) & 0xE0), 0, 0 } };
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全てのフレームを受け付けるフィルター・テーブル
+			@return フィルター・テーブル
+		 */
+		//-----------------------------------------------------------------//
+		static constexpr filter_t accept_all() noexcept
+		{
+			return filter_t{ { id_reg(0), id_reg(0) },
+				{ id_reg(0), id_reg(0, true), id_reg(0), id_reg(0, true), id_reg(0), id_reg(0, true) } };
+		}
+
+	private:
+
 		enum class REG : uint8_t {
 			RXF0SIDH  = 0x00,
 			RXF0SIDL  = 0x01,
@@ -78,78 +168,397 @@ namespace chip {
 			RXB1SIDH  = 0x71,
 		};
 
-#if 0
-/*
- *   Define SPI Instruction Set
- */
-#define MCP_WRITE           0x02
+		// SPI 命令
+		enum class CMD : uint8_t {
+			WRITE       = 0x02,
+			READ        = 0x03,
+			BITMOD      = 0x05,
+			LOAD_TX     = 0x40,	///< | (n << 1)、TXBnSIDH から
+			RTS         = 0x80,	///< | (1 << n)
+			READ_RX     = 0x90,	///< | (n << 2)、RXBnSIDH から、CS 解除で RXnIF がクリア
+			READ_STATUS = 0xA0,
+			RX_STATUS   = 0xB0,
+			RESET       = 0xC0,
+		};
 
-#define MCP_READ            0x03
+		SPI&		spi_;
 
-#define MCP_BITMOD          0x05
+		frame_t		rx_[RXN];
+		volatile uint8_t	rx_put_;
+		volatile uint8_t	rx_get_;
+		volatile uint16_t	rx_lost_;
 
-#define MCP_LOAD_TX0        0x40
-#define MCP_LOAD_TX1        0x42
-#define MCP_LOAD_TX2        0x44
+		volatile bool	lock_;
+		volatile bool	pend_;
 
-#define MCP_RTS_TX0         0x81
-#define MCP_RTS_TX1         0x82
-#define MCP_RTS_TX2         0x84
-#define MCP_RTS_ALL         0x87
+		void select_() noexcept { SEL::P = 0; }
+		void unselect_() noexcept { SEL::P = 1; }
 
-#define MCP_READ_RX0        0x90
-#define MCP_READ_RX1        0x94
+		void command_(CMD cmd) noexcept
+		{
+			select_();
+			spi_.xchg(static_cast<uint8_t>(cmd));
+			unselect_();
+		}
 
-#define MCP_READ_STATUS     0xA0
+		uint8_t read_(REG adr) noexcept
+		{
+			select_();
+			spi_.xchg(static_cast<uint8_t>(CMD::READ));
+			spi_.xchg(static_cast<uint8_t>(adr));
+			uint8_t ret = spi_.xchg();
+			unselect_();
+			return ret;
+		}
 
-#define MCP_RX_STATUS       0xB0
+		void write_(REG adr, const uint8_t* src, uint8_t len) noexcept
+		{
+			select_();
+			spi_.xchg(static_cast<uint8_t>(CMD::WRITE));
+			spi_.xchg(static_cast<uint8_t>(adr));
+			spi_.send(src, len);
+			unselect_();
+		}
 
-#define MCP_RESET           0xC0
-#endif
+		void write_(REG adr, uint8_t data) noexcept
+		{
+			write_(adr, &data, 1);
+		}
 
-		SPI&		spi_;
+		void modify_(REG adr, uint8_t mask, uint8_t data) noexcept
+		{
+			select_();
+			spi_.xchg(static_cast<uint8_t>(CMD::BITMOD));
+			spi_.xchg(static_cast<uint8_t>(adr));
+			spi_.xchg(mask);
+			spi_.xchg(data);
+			unselect_();
+		}
 
-		uint8_t read_(REG adr) noexcept
+		uint8_t status_() noexcept
 		{
-//    SPI.beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));
-			SEL = 0; // MCP2515_SELECT();
-//    spi_readwrite(READ);
-//    spi_readwrite(address);
-//    ret = spi_read();
-			uint8_t ret = spi_.recv();
-//    MCP2515_UNSELECT();
-//    SPI.endTransaction();
+			select_();
+			spi_.xchg(static_cast<uint8_t>(CMD::READ_STATUS));
+			uint8_t ret = spi_.xchg();
+			unselect_();
 			return ret;
 		}
 
+		bool set_mode_(MODE mode) noexcept
+		{
+			modify_(REG::CANCTRL, 0xE0, static_cast<uint8_t>(mode));
+			for(uint8_t i = 0; i < 10; ++i) {
+				if((read_(REG::CANSTAT) & 0xE0) == static_cast<uint8_t>(mode)) return true;
+				utils::delay::micro_second(10);
+			}
+			return false;
+		}
+
+		// 受信バッファを読み出して、リングに格納（CS 解除で RXnIF がクリアされる）
+		void read_rx_(uint8_t n) noexcept
+		{
+			uint8_t tmp[5];
+			select_();
+			spi_.xchg(static_cast<uint8_t>(CMD::READ_RX) | (n << 2));
+			spi_.recv(tmp, 5);
+			uint8_t dlc = tmp[4] & 0x0F;
+			if(dlc > 8) dlc = 8;
+			uint8_t put = rx_put_;
+			uint8_t next = (put + 1) & (RXN - 1);
+			if(next == rx_get_) {
+				unselect_();
+				++rx_lost_;
+				return;
+			}
+			frame_t& f = rx_[put];
+			if(tmp[1] & 0x08) {
+				f.id = (static_cast<uint32_t>(tmp[0]) << 21)
+					| (static_cast<uint32_t>(tmp[1] & 0xE0) << 13)
+					| (static_cast<uint32_t>(tmp[1] & 0x03) << 16)
+					| (static_cast<uint32_t>(tmp[2]) << 8) | tmp[3];
+				f.ext = true;
+				f.rtr = (tmp[4] & 0x40) != 0;
+			} else {
+				f.id = (static_cast<uint16_t>(tmp[0]) << 3) | (tmp[1] >> 5);
+				f.ext = false;
+				f.rtr = (tmp[1] & 0x10) != 0;
+			}
+			f.dlc = dlc;
+			if(!f.rtr) spi_.recv(f.data, dlc);
+			unselect_();
+			rx_put_ = next;
+		}
+
+		void drain_() noexcept
+		{
+			uint8_t st;
+			while((st = status_() & 0x03) != 0) {
+				if(st & 0x01) read_rx_(0);
+				if(st & 0x02) read_rx_(1);
+			}
+		}
 
+		void lock_spi_() noexcept { lock_ = true; }
+
+		void unlock_spi_() noexcept
+		{
+			lock_ = false;
+			// ロック中に受けた割り込みは、ここで処理する
+			while(pend_) {
+				pend_ = false;
+				lock_ = true;
+				drain_();
+				lock_ = false;
+			}
+		}
 
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクタ
+			@param[in]	spi	SPI クラスを参照で渡す
 		 */
 		//-----------------------------------------------------------------//
-		MCP2515(SPI& spi) noexcept : spi_(spi) { }
+		MCP2515(SPI& spi) noexcept : spi_(spi), rx_put_(0), rx_get_(0), rx_lost_(0),
+			lock_(false), pend_(false) { }
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	開始
+			@brief	開始 @n
+					ビット・タイミングは、１ビットを 16 ～ 8 TQ で割り切れる様に選び、 @n
+					サンプル点を約 75% に設定する。
+			@param[in]	osc		MCP2515 の発振周波数 [Hz]（8000000、16000000 など）
+			@param[in]	bps		ビットレート [bps]（500000 など）
+			@param[in]	filt	受信フィルター・テーブル
+			@param[in]	mode	動作モード
 			@return 成功なら「true」
 		 */
 		//-----------------------------------------------------------------//
-		bool start() noexcept
+		bool start(uint32_t osc, uint32_t bps, const filter_t& filt = accept_all(),
+			MODE mode = MODE::NORMAL) noexcept
 		{
 			SEL::DIR = 1;  // output
 			SEL::P = 1;    // device disable
-			// SPI.beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));
-			// MCP2515_SELECT();
-			// spi_readwrite(MCP_RESET);
-			// MCP2515_UNSELECT();
-			// SPI.endTransaction();
-			// delayMicroseconds(10);
+
+			uint8_t tq = 16;
+			uint32_t brp = 0;
+			while(tq >= 8) {
+				uint32_t d = 2 * bps * tq;
+				if(d > 0 && (osc % d) == 0) {
+					brp = osc / d;
+					break;
+				}
+				--tq;
+			}
+			if(tq < 8 || brp == 0 || brp > 64) return false;
+
+			uint8_t ps2 = (tq + 2) / 4;
+			if(ps2 < 2) ps2 = 2;
+			uint8_t ps1 = (tq - 1 - ps2) / 2;
+			uint8_t prop = tq - 1 - ps2 - ps1;
+
+			lock_spi_();
+			command_(CMD::RESET);
+			utils::delay::micro_second(10);
+			if(!set_mode_(MODE::CONFIG)) {
+				unlock_spi_();
+				return false;
+			}
+
+			uint8_t cnf[3];
+			cnf[0] = ps2 - 1;  // CNF3
+			cnf[1] = 0x80 | ((ps1 - 1) << 3) | (prop - 1);  // CNF2 (BTLMODE)
+			cnf[2] = brp - 1;  // CNF1 (SJW = 1TQ)
+			write_(REG::CNF3, cnf, 3);
+
+			// フィルターとマスク（連続したレジスターをまとめて書く）
+			write_(REG::RXF0SIDH, filt.filt[0].r, 12);
+			write_(REG::RXF3SIDH, filt.filt[3].r, 12);
+			write_(REG::RXM0SIDH, filt.mask[0].r, 8);
+
+			write_(REG::RXB0CTRL, 0x04);  // BUKT: RXB0 が一杯なら RXB1 へ
+			write_(REG::RXB1CTRL, 0x00);
+			write_(REG::BFPCTRL, 0x00);
+			write_(REG::TXRTSCTRL, 0x00);
+			write_(REG::CANINTF, 0x00);
+			write_(REG::CANINTE, 0x03);  // RX0IE, RX1IE
+
+			rx_put_ = rx_get_ = 0;
+			rx_lost_ = 0;
+
+			bool ret = set_mode_(mode);
+			unlock_spi_();
+			return ret;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フィルター・テーブルの変更（一時的にコンフィグレーション・モード）
+			@param[in]	filt	受信フィルター・テーブル
+			@param[in]	mode	復帰する動作モード
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool set_filter(const filter_t& filt, MODE mode = MODE::NORMAL) noexcept
+		{
+			lock_spi_();
+			bool ret = set_mode_(MODE::CONFIG);
+			if(ret) {
+				write_(REG::RXF0SIDH, filt.filt[0].r, 12);
+				write_(REG::RXF3SIDH, filt.filt[3].r, 12);
+				write_(REG::RXM0SIDH, filt.mask[0].r, 8);
+				ret = set_mode_(mode);
+			}
+			unlock_spi_();
+			return ret;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信タスク（INT 端子の割り込みから呼ぶ） @n
+					メイン側が SPI を使っている場合は、使用後に処理する。 @n
+					ポーリングで使う場合は、メインループから呼んでも良い。
+		 */
+		//-----------------------------------------------------------------//
+		void recv_task() noexcept
+		{
+			if(lock_) {
+				pend_ = true;
+				return;
+			}
+			lock_ = true;
+			drain_();
+			lock_ = false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信フレーム数を取得
+			@return 受信フレーム数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get_recv_num() const noexcept
+		{
+			return (rx_put_ - rx_get_) & (RXN - 1);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信フレームを取得
+			@param[out]	f	フレーム
+			@return 受信フレームが無ければ「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool recv(frame_t& f) noexcept
+		{
+			uint8_t get = rx_get_;
+			if(get == rx_put_) return false;
+			f = rx_[get];
+			rx_get_ = (get + 1) & (RXN - 1);
 			return true;
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リングバッファが一杯で、捨てたフレーム数を取得
+			@return フレーム数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_lost_num() const noexcept { return rx_lost_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信 @n
+					空いている TX バッファに格納し、送信を要求する。 @n
+					複数のバッファが送信待ちの場合、優先度の高いバッファから送信される。
+			@param[in]	f		フレーム
+			@param[in]	prio	優先度（0 ～ 3、3 が最高）
+			@return 全ての TX バッファが送信待ちなら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool send(const frame_t& f, uint8_t prio = 0) noexcept
+		{
+			lock_spi_();
+			// READ STATUS: TXB0REQ(2), TXB1REQ(4), TXB2REQ(6)
+			uint8_t st = status_();
+			uint8_t n = 0;
+			while(n < 3 && (st & (0x04 << (n * 2))) != 0) ++n;
+			if(n >= 3) {
+				unlock_spi_();
+				return false;
+			}
+
+			write_(static_cast<REG>(static_cast<uint8_t>(REG::TXB0CTRL) + (n << 4)), prio & 0x03);
+
+			uint8_t dlc = f.dlc > 8 ? 8 : f.dlc;
+			id_reg_t id = id_reg(f.id, f.ext);
+			select_();
+			spi_.xchg(static_cast<uint8_t>(CMD::LOAD_TX) | (n << 1));
+			spi_.send(id.r, 4);
+			spi_.xchg(dlc | (f.rtr ? 0x40 : 0x00));
+			if(!f.rtr) spi_.send(f.data, dlc);
+			unselect_();
+
+			command_(static_cast<CMD>(static_cast<uint8_t>(CMD::RTS) | (1 << n)));
+			unlock_spi_();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信待ちの TX バッファ数を取得
+			@return 送信待ちの TX バッファ数（0 ～ 3）
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get_send_pending() noexcept
+		{
+			lock_spi_();
+			uint8_t st = status_();
+			unlock_spi_();
+			return ((st >> 2) & 1) + ((st >> 4) & 1) + ((st >> 6) & 1);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エラー・フラグ（EFLG）を取得 @n
+					受信オーバーフロー（RX0OVR、RX1OVR）はクリアする。
+			@return EFLG
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get_error() noexcept
+		{
+			lock_spi_();
+			uint8_t eflg = read_(REG::EFLG);
+			if(eflg & 0xC0) {
+				modify_(REG::EFLG, 0xC0, 0x00);
+			}
+			unlock_spi_();
+			return eflg;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信、受信エラー・カウンターを取得
+			@param[out]	tec	送信エラー・カウンター
+			@param[out]	rec	受信エラー・カウンター
+		 */
+		//-----------------------------------------------------------------//
+		void get_error_count(uint8_t& tec, uint8_t& rec) noexcept
+		{
+			lock_spi_();
+			tec = read_(REG::TEC);
+			rec = read_(REG::REC);
+			unlock_spi_();
+		}
 	};
 }
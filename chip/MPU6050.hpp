@@ -34,7 +34,25 @@ namespace chip {
 			int16_t z;
 		};
 
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	FIFO フレーム（加速度、ジャイロ）
+		 */
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct frame_t {
+			int16_vec	accel;
+			int16_vec	gyro;
+		};
+
+		static constexpr uint8_t	FRAME_SIZE = 12;	///< FIFO の１フレームのバイト数
+		static constexpr uint16_t	FIFO_SIZE = 1024;	///< FIFO の容量
+
 	private:
+		static_assert(sizeof(frame_t) == FRAME_SIZE, "frame_t must be packed");
+
+		// １回の受信で読める最大フレーム数（iica_io::recv の長さは８ビット）
+		static constexpr uint8_t	BURST_MAX = 255 / FRAME_SIZE;
 		// R/W ビットを含まない７ビット値
 		static const uint8_t MPU6050_ADR_ = 0x68;  // AD0 = 0; (GY-521 module default)
 //		static const uint8_t MPU6050_ADR_ = 0x69;  // AD0 = 1;
@@ -411,6 +429,8 @@ DMP_MEMORY_CHUNK_SIZE   16
 
 		I2C_IO& i2c_;
 
+		uint8_t	gyro_fs_;
+
 		uint8_t recv_(REG reg) const {
 			uint8_t tmp[1];
 			tmp[0] = static_cast<uint8_t>(reg);
@@ -441,7 +461,7 @@ DMP_MEMORY_CHUNK_SIZE   16
 			tmp[0] = static_cast<uint8_t>(reg);
 			i2c_.send(MPU6050_ADR_, tmp, 1);
 			i2c_.recv(MPU6050_ADR_, &tmp[1], 1);
-			tmp[1] &= ((1 << len) - 1) << bpos;
+			tmp[1] &= ~(((1 << len) - 1) << bpos);
 			tmp[1] |= v << bpos;
  			i2c_.send(MPU6050_ADR_, tmp, 2);
 		}
@@ -479,7 +499,7 @@ DMP_MEMORY_CHUNK_SIZE   16
 			@param[in]	i2c	iica_io クラスを参照で渡す
 		 */
 		//-----------------------------------------------------------------//
-		MPU6050(I2C_IO& i2c) : i2c_(i2c) { }
+		MPU6050(I2C_IO& i2c) : i2c_(i2c), gyro_fs_(GYRO_CONFIG::FS_250) { }
 
 		void set_sleep_enable(bool f) { set_bit_(REG::PWR_MGMT_1, PWR1::SLEEP_BIT, f); }
 
@@ -488,6 +508,7 @@ DMP_MEMORY_CHUNK_SIZE   16
 		}
 
 		void set_full_scale_gyro_range(uint8_t range) {
+			gyro_fs_ = range & 3;
     		set_bits_(REG::GYRO_CONFIG, GYRO_CONFIG::FS_SEL_BIT, GYRO_CONFIG::FS_SEL_LENGTH, range);
 		}
 
@@ -558,6 +579,106 @@ DMP_MEMORY_CHUNK_SIZE   16
 			get_vec_(REG::GYRO_XOUT_H, vec);
 			return vec;
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ジャイロ感度を取得
+			@return ジャイロ感度 [LSB/(deg/s) * 10]
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_gyro_sens10() const {
+			static const uint16_t tbl[4] = { 1310, 655, 328, 164 };
+			return tbl[gyro_fs_];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	FIFO ストリーミングを開始 @n
+					加速度、ジャイロ（各３軸）を、指定レートで FIFO に積む。 @n
+					INT ピンには、データレディを出力する。
+			@param[in]	rate	サンプリングレート [Hz]（4 ～ 1000）
+			@param[in]	dlpf	デジタル LPF 設定（1 ～ 6、3: 44Hz）
+		 */
+		//-----------------------------------------------------------------//
+		void start_fifo(uint16_t rate, uint8_t dlpf = 3) {
+			if(rate < 4) rate = 4;
+			else if(rate > 1000) rate = 1000;
+			if(dlpf < 1) dlpf = 1;
+			else if(dlpf > 6) dlpf = 6;
+
+			// DLPF 有効時のジャイロ出力レートは 1kHz
+			send_(REG::CONFIG, dlpf);
+			send_(REG::SMPLRT_DIV, (1000 / rate) - 1);
+			send_(REG::FIFO_EN, 0x00);
+			send_(REG::USER_CTRL, 0x04);	// FIFO_RESET
+			send_(REG::USER_CTRL, 0x40);	// FIFO_EN
+			send_(REG::FIFO_EN, 0x78);		// XG, YG, ZG, ACCEL
+			send_(REG::INT_ENABLE, 0x01);	// DATA_RDY
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	FIFO ストリーミングを停止
+		 */
+		//-----------------------------------------------------------------//
+		void stop_fifo() {
+			send_(REG::INT_ENABLE, 0x00);
+			send_(REG::FIFO_EN, 0x00);
+			send_(REG::USER_CTRL, 0x04);	// FIFO_RESET
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	FIFO に溜まっているバイト数を取得
+			@return バイト数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_fifo_count() const {
+			uint16_t n;
+			get_16_(REG::FIFO_COUNTH, n);
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	FIFO からフレームをまとめて読み出す @n
+					フレーム数の確認と、データの読み出しの２回の転送で済む。 @n
+					FIFO が溢れた場合（フレームの境界が分からなくなる）は、 @n
+					FIFO をリセットして「0」を返す。
+			@param[out]	dst	フレームの格納先
+			@param[in]	max	最大フレーム数
+			@return 読み出したフレーム数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t read_fifo(frame_t* dst, uint8_t max) {
+			uint16_t cnt = get_fifo_count();
+			if(cnt > (FIFO_SIZE - FRAME_SIZE)) {
+				send_(REG::USER_CTRL, 0x44);	// FIFO_EN | FIFO_RESET
+				return 0;
+			}
+			uint16_t n = cnt / FRAME_SIZE;
+			if(n > max) n = max;
+			if(n > BURST_MAX) n = BURST_MAX;
+			if(n == 0) return 0;
+
+			uint8_t* p = reinterpret_cast<uint8_t*>(dst);
+			p[0] = static_cast<uint8_t>(REG::FIFO_R_W);
+			i2c_.send(MPU6050_ADR_, p, 1);
+			i2c_.recv(MPU6050_ADR_, p, n * FRAME_SIZE);
+
+			// ビッグエンディアンから RL78 のリトルエンディアンへ（その場で変換）
+			for(uint16_t i = 0; i < (n * FRAME_SIZE); i += 2) {
+				uint8_t t = p[i];
+				p[i] = p[i + 1];
+				p[i + 1] = t;
+			}
+			return n;
+		}
 	};
 }
 
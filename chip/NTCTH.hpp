@@ -32,10 +32,84 @@ namespace chip {
 		@param[in]	THM		サーミスタの型
 		@param[in]	REFR	分圧抵抗値（単位オーム）
 		@param[in]	thup	サーミスタが VCC 側の場合「true」、GND 側の場合「false」
+		@param[in]	TBITS	変換テーブルの分割数（2^TBITS 区間）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <uint32_t ADNUM, thermistor THM, uint32_t REFR, bool thup>
+	template <uint32_t ADNUM, thermistor THM, uint32_t REFR, bool thup, uint8_t TBITS = 6>
 	class NTCTH {
+	public:
+		static constexpr uint8_t FIXED_BITS = 4;	///< get_fixed の小数部ビット数（1/16 ℃）
+
+	private:
+		static constexpr uint8_t log2_(uint32_t n)
+		{
+			uint8_t b = 0;
+			while(n > 1) { n >>= 1; ++b; }
+			return b;
+		}
+
+		static_assert(((ADNUM + 1) & ADNUM) == 0, "ADNUM must be 2^n - 1");
+		static_assert(log2_(ADNUM + 1) >= TBITS, "TBITS too large for ADNUM");
+
+		static constexpr uint16_t TNUM = 1 << TBITS;
+		static constexpr uint8_t SHIFT = log2_(ADNUM + 1) - TBITS;
+
+		// コンパイル時に使う自然対数（ln(x) = 2 atanh((x-1)/(x+1))）
+		static constexpr double ln_(double x)
+		{
+			double k = 0.0;
+			while(x > 2.0) { x *= 0.5; k += 1.0; }
+			while(x < 1.0) { x *= 2.0; k -= 1.0; }
+			double y = (x - 1.0) / (x + 1.0);
+			double y2 = y * y;
+			double s = 0.0;
+			double t = y;
+			for(uint8_t n = 1; n < 40; n += 2) {
+				s += t / n;
+				t *= y2;
+			}
+			return 2.0 * s + k * 0.693147180559945309;
+		}
+
+		static constexpr double get_thb_()
+		{
+			return THM == thermistor::NT103_34G ? 3435.0
+				: (THM == thermistor::NT103_41G ? 4126.0 : 3380.0);
+		}
+
+		static constexpr double get_tr25_() { return 10e3; }
+
+		// A/D 変換値から温度（℃）、operator () と同じ式
+		static constexpr double temp_(uint32_t raw)
+		{
+			double thr = thup ? (static_cast<double>(REFR) * ADNUM / raw - REFR)
+				: (static_cast<double>(REFR) * raw / (ADNUM - raw));
+			double d = ln_(thr / get_tr25_()) / get_thb_() + (1.0 / 298.15);
+			// 表現範囲外（極端な高温）は、上限に張り付ける
+			if(d <= (1.0 / (2047.0 + 273.15))) return 2047.0;
+			return 1.0 / d - 273.15;
+		}
+
+		struct table_t {
+			int16_t	t[TNUM + 1];
+		};
+
+		static constexpr table_t make_table_()
+		{
+			table_t tbl{ };
+			for(uint16_t i = 0; i <= TNUM; ++i) {
+				uint32_t raw = static_cast<uint32_t>(i) << SHIFT;
+				if(raw < 1) raw = 1;
+				if(raw > (ADNUM - 1)) raw = ADNUM - 1;
+				double t = temp_(raw) * (1 << FIXED_BITS);
+				if(t > 32767.0) t = 32767.0;
+				else if(t < -32768.0) t = -32768.0;
+				tbl.t[i] = static_cast<int16_t>(t >= 0.0 ? t + 0.5 : t - 0.5);
+			}
+			return tbl;
+		}
+
+		static constexpr table_t table_ = make_table_();
 
 		// サーミスタの型に応じたパラメーター
 		// THB:  B 定数
@@ -97,5 +171,31 @@ namespace chip {
 			float t = 1.0f / (std::log(thr / TR25) / THB + (1.0f / T0));
 			return t - 273.15f;
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	温度を固定小数点で取得（浮動小数点演算を使わない） @n
+					コンパイル時に生成したテーブルを引く。 @n
+					TBITS = 6 の場合、-20 ～ 85 ℃で 0.15 ℃、-40 ～ 125 ℃で 1.0 ℃ 以内の誤差 @n
+					TBITS = 8 の場合、-40 ～ 125 ℃で 0.1 ℃ 以内の誤差（ntcth_test で検査）
+			@param[in]	adn		A/D 変換値
+			@param[in]	lerp	テーブル間を直線補間しない場合「false」
+			@return 温度（小数部 FIXED_BITS ビットの固定小数点、1/16 ℃）
+		 */
+		//-----------------------------------------------------------------//
+		int16_t get_fixed(uint16_t adn, bool lerp = true) const
+		{
+			if(adn > ADNUM) adn = ADNUM;
+			uint16_t i = adn >> SHIFT;
+			int16_t t0 = table_.t[i];
+			if(!lerp || i >= TNUM) return t0;
+			uint16_t f = adn & ((1 << SHIFT) - 1);
+			int32_t d = static_cast<int32_t>(table_.t[i + 1]) - t0;
+			return t0 + static_cast<int16_t>((d * f) >> SHIFT);
+		}
 	};
+
+	template <uint32_t ADNUM, thermistor THM, uint32_t REFR, bool thup, uint8_t TBITS>
+		constexpr typename NTCTH<ADNUM, THM, REFR, thup, TBITS>::table_t NTCTH<ADNUM, THM, REFR, thup, TBITS>::table_;
 }
@@ -156,5 +156,43 @@ namespace chip {
 			chip_enable_(false);
 		}
 
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  更新範囲だけをコピー @n
+					ビットマップの更新があるページのカラム範囲だけを転送し、 @n
+					更新範囲をクリアする。
+			@param[in]	bmp	ビットマップ（monograph）
+		*/
+		//-----------------------------------------------------------------//
+		template <class BITMAP>
+		void flush_dirty(BITMAP& bmp) {
+			if(!bmp.is_dirty()) return;
+
+			chip_enable_();
+			reg_select_(0);
+			utils::delay::micro_second(1);
+			for(uint8_t j = 0; j < bmp.page_num(); ++j) {
+				uint8_t beg;
+				uint8_t end;
+				if(!bmp.get_dirty(j, beg, end)) continue;
+				csi_.xchg(0xb0 + j);				// set page address 0 to 7
+				csi_.xchg(0x00 | (beg & 0x0f));	// lower collum start address
+				csi_.xchg(0x10 | (beg >> 4));		// higher collum start address
+				utils::delay::micro_second(1);
+				reg_select_(1);
+				utils::delay::micro_second(1);
+				const uint8_t* p = &bmp.fb()[j * bmp.get_width() + beg];
+				for(uint16_t i = beg; i <= end; ++i) {
+					csi_.xchg(*p++);
+				}
+				utils::delay::micro_second(1);
+				reg_select_(0);
+			}
+			reg_select_(1);
+			chip_enable_(false);
+			bmp.clear_dirty();
+		}
+
 	};
 }
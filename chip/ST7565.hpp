@@ -205,5 +205,35 @@ namespace chip {
 			chip_enable_(false);
 		}
 
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  更新範囲だけをコピー @n
+					ビットマップの更新があるページのカラム範囲だけを転送し、 @n
+					更新範囲をクリアする。
+			@param[in]	bmp	ビットマップ（monograph）
+		*/
+		//-----------------------------------------------------------------//
+		template <class BITMAP>
+		void flush_dirty(BITMAP& bmp) {
+			if(!bmp.is_dirty()) return;
+
+			chip_enable_();
+			for(uint8_t page = 0; page < bmp.page_num(); ++page) {
+				uint8_t beg;
+				uint8_t end;
+				if(!bmp.get_dirty(page, beg, end)) continue;
+				reg_select_(0);
+				write_(CMD::SET_PAGE, page);
+				write_(CMD::SET_COLUMN_LOWER, beg & 0x0f);
+				write_(CMD::SET_COLUMN_UPPER, beg >> 4);
+				reg_select_(1);
+				csi_.send(&bmp.fb()[page * bmp.get_width() + beg], end - beg + 1);
+			}
+			reg_select_(0);
+			chip_enable_(false);
+			bmp.clear_dirty();
+		}
+
 	};
 }
@@ -18,12 +18,39 @@ namespace chip {
 	/*!
 		@brief  VL53L0X テンプレートクラス
 		@param[in]	I2C_IO	i2c I/O クラス
+		@param[in]	RING	計測サービスのサンプル・リングの大きさ（2^n）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class I2C_IO>
+	template <class I2C_IO, uint8_t RING = 8>
 	class VL53L0X {
+
+		static_assert(RING >= 2 && (RING & (RING - 1)) == 0, "RING must be 2^n");
+
 	public:
 
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  計測サンプル、構造体
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct sample_t {
+			uint16_t	time;	///< service に渡された時間
+			uint16_t	range;	///< 距離（ミリメートル）
+			uint8_t		status;	///< レンジ・ステータス（11: 有効）
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  VCSEL パルス周期の種類（set_vcsel_pulse_period）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class vcselPeriod {
+			PreRange,
+			FinalRange
+		};
+
+
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 		/*!
 			@brief  シーケンスステップ許可、構造体
@@ -155,16 +182,11 @@ namespace chip {
 		};
 
 
-		enum class vcselPeriod {
-			PreRange,
-			FinalRange
-		};
-
 		I2C_IO&		i2c_io_;
 
 		uint32_t	measurement_timing_budget_us_;
 
-		uint16_t	timeout_start_ms_;
+		utils::deadline	timeout_;
 		uint16_t	io_timeout_;
 
 		// read by init and used when starting measurement; is StopVariable field of VL53L0X_
@@ -173,16 +195,26 @@ namespace chip {
 		bool		last_status_;
 		bool		did_timeout_;
 
+		sample_t	ring_[RING];
+		uint8_t		ring_put_;
+		uint8_t		ring_num_;
+		bool		intr_mode_;
+		volatile bool	ready_;
+
+		// RESULT_INTERRUPT_STATUS から距離（RESULT_RANGE_STATUS + 10、11）までの長さ
+		static const uint8_t RESULT_LEN_ = 13;
+		// 範囲外の場合の距離
+		static const uint16_t RANGE_OUT_ = 8190;
+
 
 		void start_timeout_() {
-			timeout_start_ms_ = 0;
+			timeout_.start(static_cast<uint32_t>(io_timeout_) * 1000);
 		}
 
 
 		bool check_timeout_expired_() {
-			++timeout_start_ms_;
-			utils::delay::micro_second(1000 - 100);  // 1ms から、他の処理を大雑把に100uS引く
-			return (io_timeout_ > 0 && timeout_start_ms_ > io_timeout_);
+			// タイマーが無い場合、1ms から、他の処理を大雑把に100uS引いて待つ
+			return timeout_.expired(1000 - 100) && io_timeout_ > 0;
 		}
 
 
@@ -359,9 +391,10 @@ namespace chip {
 		 */
 		//-----------------------------------------------------------------//
 		VL53L0X(I2C_IO& i2c) : i2c_io_(i2c),
-			measurement_timing_budget_us_(0), timeout_start_ms_(0), io_timeout_(500), 
+			measurement_timing_budget_us_(0), timeout_(), io_timeout_(500), 
 			stop_variable_(0),
-			last_status_(true), did_timeout_(false) { }
+			last_status_(true), did_timeout_(false),
+			ring_(), ring_put_(0), ring_num_(0), intr_mode_(false), ready_(false) { }
 
 
 		//-----------------------------------------------------------------//
@@ -642,8 +675,8 @@ namespace chip {
 			SequenceStepEnables enables;
 			SequenceStepTimeouts timeouts;
 
-			get_sequence_step_enables_(enables);
-			get_sequence_step_timeouts_(enables, timeouts);
+			get_sequence_step_enables(enables);
+			get_sequence_step_timeouts(enables, timeouts);
 
 			// "Apply specific settings for the requested clock period"
 			// "Re-calculate and apply timeouts, in macro periods"
@@ -1104,6 +1137,131 @@ namespace chip {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	計測サービスを開始（連続モード） @n
+					以後は、service() を定期的に呼ぶ。 @n
+					intr を有効にした場合、GPIO1（データレディ、アクティブ・ロー）の @n
+					割り込みから ready_task() を呼ぶ。
+			@param[in]	period_ms	計測間隔（0 の場合 back-to-back）
+			@param[in]	intr		GPIO1 割り込みを使う場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		void start_service(uint32_t period_ms, bool intr = false)
+		{
+			clear_samples();
+			intr_mode_ = intr;
+			ready_ = false;
+			start_continuous(period_ms);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	データレディ通知（GPIO1 の割り込みから呼ぶ）
+		 */
+		//-----------------------------------------------------------------//
+		void ready_task() { ready_ = true; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	計測サービス（ブロックしない） @n
+					計測が完了していれば、ステータスと距離を一回の転送で読み、 @n
+					割り込みをクリアしてリングに積む。 @n
+					割り込みを使わない場合は、タイマーのタイミングで呼ぶ。
+			@param[in]	time	タイムスタンプ（itimer のカウンター等）
+			@return 新しいサンプルを積んだ場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool service(uint16_t time)
+		{
+			if(intr_mode_) {
+				if(!ready_) return false;
+				ready_ = false;
+			}
+
+			uint8_t tmp[RESULT_LEN_];
+			last_status_ = read_(reg_addr::RESULT_INTERRUPT_STATUS, tmp, RESULT_LEN_);
+			if(!last_status_) return false;
+			if((tmp[0] & 0x07) == 0) return false;
+
+			write_(reg_addr::SYSTEM_INTERRUPT_CLEAR, 0x01);
+
+			sample_t& s = ring_[ring_put_];
+			s.time = time;
+			s.range = (static_cast<uint16_t>(tmp[11]) << 8) | tmp[12];
+			s.status = (tmp[1] & 0x78) >> 3;
+			ring_put_ = (ring_put_ + 1) & (RING - 1);
+			if(ring_num_ < RING) ++ring_num_;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サンプルを消去
+		 */
+		//-----------------------------------------------------------------//
+		void clear_samples()
+		{
+			ring_put_ = 0;
+			ring_num_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リング内のサンプル数を取得
+			@return サンプル数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get_sample_num() const { return ring_num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サンプルを取得
+			@param[in]	idx	インデックス（0 が最新）
+			@return サンプル
+		 */
+		//-----------------------------------------------------------------//
+		const sample_t& get_sample(uint8_t idx = 0) const
+		{
+			return ring_[(ring_put_ - 1 - idx) & (RING - 1)];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	最新の数サンプルのメディアンを取得 @n
+					範囲外（8190 以上）のサンプルは除く。
+			@param[in]	num	対象とするサンプル数（RING 以下）
+			@return 距離（ミリメートル）、有効なサンプルが無い場合 65535
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_median(uint8_t num = 5) const
+		{
+			if(num > ring_num_) num = ring_num_;
+			uint16_t tmp[RING];
+			uint8_t n = 0;
+			for(uint8_t i = 0; i < num; ++i) {
+				uint16_t v = get_sample(i).range;
+				if(v >= RANGE_OUT_) continue;
+				// 挿入ソート
+				uint8_t j = n;
+				while(j > 0 && tmp[j - 1] > v) {
+					tmp[j] = tmp[j - 1];
+					--j;
+				}
+				tmp[j] = v;
+				++n;
+			}
+			if(n == 0) return 65535;
+			return tmp[n / 2];
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	タイムアウトのデコード @n
@@ -13,6 +13,7 @@
 #include "common/csi_io.hpp"
 #include "common/delay.hpp"
 #include "common/format.hpp"
+#include "common/pt.hpp"
 #include "ff12a/src/ff.h"
 
 extern "C" {
@@ -62,6 +63,11 @@ namespace chip {
 
 		bool	pause_;
 
+		// service_pt() の状態
+		utils::pt		pt_;
+		const uint8_t*	ptr_;
+		UINT			len_;
+
 		inline void sleep_() { asm("nop"); }
 
 
@@ -137,7 +143,7 @@ namespace chip {
 			@brief  コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		VS1063(CSI& csi) : csi_(csi), frame_(0), pause_(false) { }
+		VS1063(CSI& csi) : csi_(csi), frame_(0), pause_(false), pt_(), ptr_(nullptr), len_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -211,6 +217,35 @@ namespace chip {
 		}
 
 
+		//----------------------------------------------------------------//
+		/*!
+			@brief  サービス（コルーチン） @n
+					DREQ を待つ間は「WAITING」で戻るので、他の処理を進められる。
+			@param[in]	fp	ファイル・ディスクリプタ
+			@return １ブロック送ったら「ENDED」、ファイルの終端、エラーなら「EXITED」
+		*/
+		//----------------------------------------------------------------//
+		utils::pt_state service_pt(FIL* fp)
+		{
+			PT_BEGIN(pt_);
+			if(f_read(fp, buff_, sizeof(buff_), &len_) != FR_OK || len_ == 0) {
+				PT_EXIT(pt_);
+			}
+			ptr_ = buff_;
+			while(len_ > 0) {
+				PT_WAIT_UNTIL(pt_, get_status_());
+				{
+					uint16_t l = 32;
+					if(l > len_) l = len_;
+					csi_.send(ptr_, l);
+					ptr_ += l;
+					len_ -= l;
+				}
+			}
+			PT_END(pt_);
+		}
+
+
 		//----------------------------------------------------------------//
 		/*!
 			@brief  再生
@@ -231,15 +266,19 @@ namespace chip {
 			{
 				frame_ = 0;
 				pause_ = false;
+				pt_.reset();
 				DCS::P = 0;
 				while(1) {
 					if(!pause_) {
-						if(!service(fp)) break;
-
-						++frame_;
-						if(frame_ >= 40) {
-							device::P4.B3 = !device::P4.B3();
-							frame_ = 0;
+						// DREQ 待ちの間も、コマンドを受け付ける
+						auto st = service_pt(fp);
+						if(st == utils::pt_state::EXITED) break;
+						if(st == utils::pt_state::ENDED) {
+							++frame_;
+							if(frame_ >= 40) {
+								device::P4.B3 = !device::P4.B3();
+								frame_ = 0;
+							}
 						}
 					} else {
 						if(frame_ < 192) {
@@ -21,7 +21,7 @@ namespace device {
 				  +25度：1.05V @n
 				  + 1度：-3.6mV
 		@param[in]	NUM		最大チャネル数
-		@param[in]	TASK	割り込みタスク
+		@param[in]	TASK	割り込みタスク（スキャン終了で呼ばれる）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <uint16_t NUM, class TASK>
@@ -82,6 +82,7 @@ namespace device {
 					adc::ADM0.ADCS = 1;  // start 1st
 				} else {
 					conv_fin_ = true;
+					task_();
 				}
 			} else if(ch == 0x80) {  // temp
 				if(temp_task_ == 1) {
@@ -90,9 +91,9 @@ namespace device {
 				} else {
 					temp_ = adc::ADCR();
 					conv_fin_ = true;
+					task_();
 				}
 			}
-			task_();
 		}
 
 
@@ -139,8 +140,8 @@ namespace device {
 			if(level > 0) {
 				--level;
 				level ^= 0x03;
-				intr::set_level(adc::get_peripheral(), level);
-				intr::enable(adc::get_peripheral());
+				intr::set_level<adc::get_peripheral()>(level);
+				intr::enable<adc::get_peripheral()>();
 			}
 
 			utils::delay::micro_second(1);
@@ -206,8 +207,8 @@ namespace device {
 			if(level_ == 0) {
 				adc::ADS = ch;
 				adc::ADM0.ADCS = 1;  // start
-				while(intr::get_request(adc::get_peripheral()) == 0) sleep_();
-				intr::set_request(adc::get_peripheral(), 0);
+				while(intr::get_request<adc::get_peripheral()>() == 0) sleep_();
+				intr::set_request<adc::get_peripheral()>(0);
 				return adc::ADCR();
 			} else {
 				return value_[ch];
@@ -227,8 +228,8 @@ namespace device {
 			if(level_ == 0) {
 				adc::ADS = 0x80;
 				adc::ADM0.ADCS = 1;  // start
-				while(intr::get_request(adc::get_peripheral()) == 0) sleep_();
-				intr::set_request(adc::get_peripheral(), 0);
+				while(intr::get_request<adc::get_peripheral()>() == 0) sleep_();
+				intr::set_request<adc::get_peripheral()>(0);
 				return adc::ADCR();
 			} else {
 				return temp_;
@@ -0,0 +1,131 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	気圧から高度を求める（整数演算のみ） @n
+			h = 44330 * (1 - (P / P0)^0.1903) をコンパイル時にテーブル化し、 @n
+			実行時は、32 ビットの除算と直線補間だけで求める。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  高度計算テンプレートクラス @n
+				気圧比（P / P0）0.5 ～ 1.125（およそ -950m ～ 5500m）の範囲を扱う。 @n
+				STEP_BITS = 9 の場合、テーブルは 81 要素（324 バイト）で、pow() との差は、 @n
+				90 kPa 以上で 8 cm、50 kPa まで 19 cm 以内（bmp_test で検査）
+		@param[in]	STEP_BITS	テーブルの刻み（気圧比 1/65536 単位での 2^STEP_BITS）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t STEP_BITS = 9>
+	class altitude {
+
+		static constexpr uint32_t RATIO_MIN = 0x800000;		///< 0.5 (Q24)
+		static constexpr uint32_t RATIO_MAX = 0x1200000;	///< 1.125 (Q24)
+		static constexpr uint8_t SHIFT = STEP_BITS + 8;		///< Q24 での刻み
+		static constexpr uint16_t TNUM = (RATIO_MAX - RATIO_MIN) >> SHIFT;
+
+		static_assert(STEP_BITS >= 4 && STEP_BITS <= 12, "STEP_BITS out of range");
+
+		// コンパイル時に使う自然対数（ln(x) = 2 atanh((x-1)/(x+1))）
+		static constexpr double ln_(double x)
+		{
+			double y = (x - 1.0) / (x + 1.0);
+			double y2 = y * y;
+			double s = 0.0;
+			double t = y;
+			for(uint8_t n = 1; n < 40; n += 2) {
+				s += t / n;
+				t *= y2;
+			}
+			return 2.0 * s;
+		}
+
+		// コンパイル時に使う指数関数（|x| が小さい範囲のみ）
+		static constexpr double exp_(double x)
+		{
+			double s = 1.0;
+			double t = 1.0;
+			for(uint8_t n = 1; n < 20; ++n) {
+				t *= x / n;
+				s += t;
+			}
+			return s;
+		}
+
+		// 気圧比から高度 [cm]
+		static constexpr double height_(double r)
+		{
+			return 4433000.0 * (1.0 - exp_(0.1903 * ln_(r)));
+		}
+
+		struct table_t {
+			int32_t	h[TNUM + 1];
+		};
+
+		static constexpr table_t make_table_()
+		{
+			table_t tbl{ };
+			for(uint16_t i = 0; i <= TNUM; ++i) {
+				double r = static_cast<double>(RATIO_MIN + (static_cast<uint32_t>(i) << SHIFT)) / 16777216.0;
+				double h = height_(r);
+				tbl.h[i] = static_cast<int32_t>(h >= 0.0 ? h + 0.5 : h - 0.5);
+			}
+			return tbl;
+		}
+
+		static constexpr table_t table_ = make_table_();
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	気圧比を Q24 の固定小数点で求める（32 ビット演算のみ） @n
+					Q16 では１LSB が約 13cm に相当するので、Q24 まで求める。
+			@param[in]	pa		気圧 [Pa]（131071 以下）
+			@param[in]	sea_pa	海面気圧 [Pa]（131071 以下）
+			@return 気圧比（Q24）
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t get_ratio(int32_t pa, int32_t sea_pa)
+		{
+			if(pa <= 0 || sea_pa <= 0 || pa > 0x1ffff || sea_pa > 0x1ffff) return 0;
+			// (pa << 24) / sea_pa は 32 ビットに収まらないので、余りを使って２段階で割る
+			uint32_t n = static_cast<uint32_t>(pa) << 15;
+			uint32_t q = n / static_cast<uint32_t>(sea_pa);
+			uint32_t r = n % static_cast<uint32_t>(sea_pa);
+			return (q << 9) + ((r << 9) / static_cast<uint32_t>(sea_pa));
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	高度を取得
+			@param[in]	pa		気圧 [Pa]
+			@param[in]	sea_pa	海面気圧 [Pa]
+			@return 高度 [cm]（範囲外は、端の値に張り付ける）
+		 */
+		//-----------------------------------------------------------------//
+		static int32_t get(int32_t pa, int32_t sea_pa = 101325)
+		{
+			uint32_t r = get_ratio(pa, sea_pa);
+			if(r <= RATIO_MIN) return table_.h[0];
+			if(r >= RATIO_MAX) return table_.h[TNUM];
+			r -= RATIO_MIN;
+			uint16_t i = r >> SHIFT;
+			// 積が 32 ビットを超えないよう、補間係数は下位４ビットを捨てる
+			int32_t f = (r & ((static_cast<uint32_t>(1) << SHIFT) - 1)) >> 4;
+			int32_t h0 = table_.h[i];
+			int32_t d = table_.h[i + 1] - h0;
+			return h0 + ((d * f) >> (SHIFT - 4));
+		}
+	};
+
+	template <uint8_t STEP_BITS>
+		constexpr typename altitude<STEP_BITS>::table_t altitude<STEP_BITS>::table_;
+}
@@ -0,0 +1,541 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	Arithmetic バイトコード・コンパイラーと VM @n
+			テキストの数式（シンボルを含む）を、一度だけ逆ポーランドの @n
+			バイトコードに変換して、評価は小さなスタック VM で行う。 @n
+			ADC のサンプル毎に同じ式を評価する場合などで、basic_arith の @n
+			様に、毎回文字を解析する必要が無い。 @n
+			演算子と優先順位は basic_arith と同じ（「%」は除算、「//」は剰余）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include "common/basic_arith.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	整数型の演算
+		@param[in]	T	基本型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <typename T>
+	struct arith_ops {
+		static constexpr bool BITOP = true;	///< ビット演算が使えるか
+
+		static T from_num(uint32_t v, uint32_t fp, uint32_t fs) {
+			return static_cast<T>(v) + static_cast<T>(fp) / static_cast<T>(fs);
+		}
+		static T mul(T a, T b) { return a * b; }
+		static T div(T a, T b) { return a / b; }
+		static T mod(T a, T b) { return a % b; }
+		static T inv(T a) { return ~a; }
+		static T band(T a, T b) { return a & b; }
+		static T bor(T a, T b) { return a | b; }
+		static T bxor(T a, T b) { return a ^ b; }
+		static T shl(T a, T b) { return a << b; }
+		static T shr(T a, T b) { return a >> b; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	浮動小数点型の演算（ビット演算、剰余は使えない）
+		@param[in]	T	基本型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <typename T>
+	struct arith_float_ops {
+		static constexpr bool BITOP = false;
+
+		static T from_num(uint32_t v, uint32_t fp, uint32_t fs) {
+			return static_cast<T>(v) + static_cast<T>(fp) / static_cast<T>(fs);
+		}
+		static T mul(T a, T b) { return a * b; }
+		static T div(T a, T b) { return a / b; }
+		static T mod(T, T) { return 0; }
+		static T inv(T) { return 0; }
+		static T band(T, T) { return 0; }
+		static T bor(T, T) { return 0; }
+		static T bxor(T, T) { return 0; }
+		static T shl(T, T) { return 0; }
+		static T shr(T, T) { return 0; }
+	};
+
+	template <> struct arith_ops<float> : public arith_float_ops<float> { };
+	template <> struct arith_ops<double> : public arith_float_ops<double> { };
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	固定小数点型の演算 @n
+				シフトの量は、整数部を使う。
+		@param[in]	Q	小数部のビット数
+		@param[in]	T	基本型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t Q, typename T = int32_t>
+	struct arith_fixed {
+		static constexpr bool BITOP = true;
+
+		static T from_num(uint32_t v, uint32_t fp, uint32_t fs) {
+			return static_cast<T>((v << Q) + ((static_cast<uint64_t>(fp) << Q) / fs));
+		}
+		static T mul(T a, T b) { return (static_cast<int64_t>(a) * b) >> Q; }
+		static T div(T a, T b) { return (static_cast<int64_t>(a) << Q) / b; }
+		static T mod(T a, T b) { return a % b; }
+		static T inv(T a) { return ~a; }
+		static T band(T a, T b) { return a & b; }
+		static T bor(T a, T b) { return a | b; }
+		static T bxor(T a, T b) { return a ^ b; }
+		static T shl(T a, T b) { return a << (b >> Q); }
+		static T shr(T a, T b) { return a >> (b >> Q); }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	Arithmetic バイトコード VM クラス @n
+				スタックの深さはコンパイル時に検査するので、評価では検査しない。
+		@param[in]	VTYPE	基本型
+		@param[in]	OPS		演算クラス（arith_ops、arith_fixed など）
+		@param[in]	CSIZE	バイトコードの最大長
+		@param[in]	CNUM	定数の最大数
+		@param[in]	STACK	スタックの深さ
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <typename VTYPE, class OPS = arith_ops<VTYPE>,
+		uint8_t CSIZE = 48, uint8_t CNUM = 8, uint8_t STACK = 8>
+	class arith_vm {
+	public:
+		typedef typename basic_arith<VTYPE>::error error;
+		typedef typename basic_arith<VTYPE>::error_t error_t;
+
+	private:
+		enum class op : uint8_t {
+			END,
+			CONST,	///< 定数（次のバイトは定数の番号）
+			VAR,	///< シンボル（次のバイトはシンボルの番号）
+			NEG,
+			INV,
+			ADD,
+			SUB,
+			MUL,
+			DIV,
+			MOD,
+			AND,
+			OR,
+			XOR,
+			SHL,
+			SHR,
+		};
+
+		// コンパイル中のスタック要素（定数の畳み込み用）
+		struct item_t {
+			uint8_t	pos;
+			bool	cst;
+		};
+
+		uint8_t		code_[CSIZE];
+		VTYPE		const_[CNUM];
+		uint8_t		cnum_;
+
+		// コンパイル中だけ使う
+		const char*			tx_;
+		const char* const*	sym_;
+		uint8_t		symnum_;
+		uint8_t		pos_;
+		uint8_t		depth_;
+		item_t		item_[STACK];
+
+		error_t		error_;
+
+		void skip_space_() {
+			while(*tx_ == ' ' || *tx_ == '\t') ++tx_;
+		}
+
+		bool put_(uint8_t v) {
+			if(pos_ >= CSIZE) {
+				error_.set(error::fatal);
+				return false;
+			}
+			code_[pos_++] = v;
+			return true;
+		}
+
+		void push_item_(uint8_t pos, bool cst) {
+			if(depth_ >= STACK) {
+				error_.set(error::fatal);
+				return;
+			}
+			item_[depth_].pos = pos;
+			item_[depth_].cst = cst;
+			++depth_;
+		}
+
+		void emit_const_(VTYPE v) {
+			if(cnum_ >= CNUM) {
+				error_.set(error::num_fatal);
+				return;
+			}
+			uint8_t pos = pos_;
+			if(!put_(static_cast<uint8_t>(op::CONST))) return;
+			if(!put_(cnum_)) return;
+			const_[cnum_++] = v;
+			push_item_(pos, true);
+		}
+
+		void emit_var_(uint8_t idx) {
+			uint8_t pos = pos_;
+			if(!put_(static_cast<uint8_t>(op::VAR))) return;
+			if(!put_(idx)) return;
+			push_item_(pos, false);
+		}
+
+		static bool is_bitop_(op o) {
+			return o == op::MOD || o == op::INV || o == op::AND || o == op::OR
+				|| o == op::XOR || o == op::SHL || o == op::SHR;
+		}
+
+		static VTYPE calc_(op o, VTYPE a, VTYPE b) {
+			switch(o) {
+			case op::ADD: return a + b;
+			case op::SUB: return a - b;
+			case op::MUL: return OPS::mul(a, b);
+			case op::DIV: return OPS::div(a, b);
+			case op::MOD: return OPS::mod(a, b);
+			case op::AND: return OPS::band(a, b);
+			case op::OR:  return OPS::bor(a, b);
+			case op::XOR: return OPS::bxor(a, b);
+			case op::SHL: return OPS::shl(a, b);
+			case op::SHR: return OPS::shr(a, b);
+			default: return 0;
+			}
+		}
+
+		// 単項演算（定数なら畳み込む）
+		void emit_unary_(op o) {
+			if(error_() != 0 || depth_ < 1) return;
+			if(!OPS::BITOP && is_bitop_(o)) {
+				error_.set(error::fatal);
+				return;
+			}
+			auto& a = item_[depth_ - 1];
+			if(a.cst) {
+				VTYPE& v = const_[cnum_ - 1];
+				v = o == op::NEG ? -v : OPS::inv(v);
+				return;
+			}
+			put_(static_cast<uint8_t>(o));
+		}
+
+		// ２項演算（両方が定数なら畳み込む）
+		void emit_binary_(op o) {
+			if(error_() != 0 || depth_ < 2) return;
+			if(!OPS::BITOP && is_bitop_(o)) {
+				error_.set(error::fatal);
+				return;
+			}
+			auto& a = item_[depth_ - 2];
+			auto& b = item_[depth_ - 1];
+			if(a.cst && b.cst) {
+				VTYPE vb = const_[cnum_ - 1];
+				VTYPE va = const_[cnum_ - 2];
+				if((o == op::DIV || o == op::MOD) && vb == 0) {
+					error_.set(error::zero_divide);
+					return;
+				}
+				cnum_ -= 2;
+				pos_ = a.pos;
+				depth_ -= 2;
+				emit_const_(calc_(o, va, vb));
+				return;
+			}
+			put_(static_cast<uint8_t>(o));
+			--depth_;
+			item_[depth_ - 1].cst = false;
+		}
+
+		static bool is_sym_(char ch, bool top) {
+			if(ch >= 'A' && ch <= 'Z') return true;
+			if(ch >= 'a' && ch <= 'z') return true;
+			if(ch == '_') return true;
+			if(!top && ch >= '0' && ch <= '9') return true;
+			return false;
+		}
+
+		void symbol_() {
+			const char* org = tx_;
+			while(is_sym_(*tx_, tx_ == org)) ++tx_;
+			uint8_t len = tx_ - org;
+			for(uint8_t i = 0; i < symnum_; ++i) {
+				const char* s = sym_[i];
+				uint8_t j = 0;
+				while(j < len && s[j] == org[j]) ++j;
+				if(j == len && s[j] == 0) {
+					emit_var_(i);
+					return;
+				}
+			}
+			error_.set(error::symbol_fatal);
+		}
+
+		void number_() {
+			bool point = false;
+			uint32_t v = 0;
+			uint32_t fp = 0;
+			uint32_t fs = 1;
+			const char* org = tx_;
+			while(1) {
+				char ch = *tx_;
+				if(ch == '.') {
+					if(point) {
+						error_.set(error::number_fatal);
+						return;
+					}
+					point = true;
+				} else if(ch >= '0' && ch <= '9') {
+					if(point) {
+						fp *= 10;
+						fp += ch - '0';
+						fs *= 10;
+					} else {
+						v *= 10;
+						v += ch - '0';
+					}
+				} else {
+					break;
+				}
+				++tx_;
+			}
+			if(tx_ == org) {
+				error_.set(error::fatal);
+				return;
+			}
+			emit_const_(OPS::from_num(v, fp, fs));
+		}
+
+		void factor_() {
+			skip_space_();
+			char ch = *tx_;
+			if(ch == '-' || ch == '+' || ch == '~') {
+				++tx_;
+				factor_();
+				if(ch == '-') emit_unary_(op::NEG);
+				else if(ch == '~') emit_unary_(op::INV);
+			} else if(ch == '(') {
+				++tx_;
+				expression_();
+				skip_space_();
+				if(*tx_ == ')') {
+					++tx_;
+				} else {
+					error_.set(error::fatal);
+				}
+			} else if(is_sym_(ch, true)) {
+				symbol_();
+			} else {
+				number_();
+			}
+		}
+
+		void term_() {
+			factor_();
+			while(error_() == 0) {
+				skip_space_();
+				op o;
+				char ch = *tx_;
+				if(ch == '*') {
+					o = op::MUL;
+				} else if(ch == '%') {
+					o = op::DIV;
+				} else if(ch == '/') {
+					if(tx_[1] == '/') {
+						++tx_;
+						o = op::MOD;
+					} else {
+						o = op::DIV;
+					}
+				} else if((ch == '<' || ch == '>') && tx_[1] == ch) {
+					++tx_;
+					o = ch == '<' ? op::SHL : op::SHR;
+				} else {
+					return;
+				}
+				++tx_;
+				factor_();
+				emit_binary_(o);
+			}
+		}
+
+		void expression_() {
+			term_();
+			while(error_() == 0) {
+				skip_space_();
+				op o;
+				switch(*tx_) {
+				case '+': o = op::ADD; break;
+				case '-': o = op::SUB; break;
+				case '&': o = op::AND; break;
+				case '^': o = op::XOR; break;
+				case '|': o = op::OR;  break;
+				default:
+					return;
+				}
+				++tx_;
+				term_();
+				emit_binary_(o);
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		arith_vm() : cnum_(0), tx_(nullptr), sym_(nullptr), symnum_(0),
+			pos_(0), depth_(0), error_() {
+			code_[0] = static_cast<uint8_t>(op::END);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンパイル
+			@param[in]	text	数式
+			@param[in]	sym		シンボル名の配列（run() の vars と同じ順番）
+			@param[in]	num		シンボルの数
+			@return	文法にエラーがあった場合、「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool compile(const char* text, const char* const* sym = nullptr, uint8_t num = 0) {
+			error_.clear();
+			cnum_ = 0;
+			pos_ = 0;
+			depth_ = 0;
+			code_[0] = static_cast<uint8_t>(op::END);
+			if(text == nullptr) {
+				error_.set(error::fatal);
+				return false;
+			}
+			tx_ = text;
+			sym_ = sym;
+			symnum_ = num;
+
+			expression_();
+			skip_space_();
+			if(error_() == 0 && (*tx_ != 0 || depth_ != 1)) {
+				error_.set(error::fatal);
+			}
+			if(error_() == 0) put_(static_cast<uint8_t>(op::END));
+			if(error_() != 0) {
+				pos_ = 0;
+				code_[0] = static_cast<uint8_t>(op::END);
+				return false;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	評価（コンパイルされていない場合「０」）
+			@param[in]	vars	シンボルの値
+			@return	結果（０除算の場合、エラーを設定して「０」）
+		*/
+		//-----------------------------------------------------------------//
+		VTYPE run(const VTYPE* vars = nullptr) {
+			error_.clear();
+			VTYPE stk[STACK];
+			VTYPE* sp = stk;
+			const uint8_t* pc = code_;
+			while(1) {
+				switch(static_cast<op>(*pc++)) {
+				case op::END:
+					return sp != stk ? sp[-1] : 0;
+				case op::CONST:
+					*sp++ = const_[*pc++];
+					break;
+				case op::VAR:
+					*sp++ = vars[*pc++];
+					break;
+				case op::NEG:
+					sp[-1] = -sp[-1];
+					break;
+				case op::INV:
+					sp[-1] = OPS::inv(sp[-1]);
+					break;
+				case op::ADD:
+					--sp;
+					sp[-1] += sp[0];
+					break;
+				case op::SUB:
+					--sp;
+					sp[-1] -= sp[0];
+					break;
+				case op::MUL:
+					--sp;
+					sp[-1] = OPS::mul(sp[-1], sp[0]);
+					break;
+				case op::DIV:
+				case op::MOD:
+					--sp;
+					if(sp[0] == 0) {
+						error_.set(error::zero_divide);
+						return 0;
+					}
+					sp[-1] = pc[-1] == static_cast<uint8_t>(op::DIV)
+						? OPS::div(sp[-1], sp[0]) : OPS::mod(sp[-1], sp[0]);
+					break;
+				case op::AND:
+					--sp;
+					sp[-1] = OPS::band(sp[-1], sp[0]);
+					break;
+				case op::OR:
+					--sp;
+					sp[-1] = OPS::bor(sp[-1], sp[0]);
+					break;
+				case op::XOR:
+					--sp;
+					sp[-1] = OPS::bxor(sp[-1], sp[0]);
+					break;
+				case op::SHL:
+					--sp;
+					sp[-1] = OPS::shl(sp[-1], sp[0]);
+					break;
+				case op::SHR:
+					--sp;
+					sp[-1] = OPS::shr(sp[-1], sp[0]);
+					break;
+				default:
+					error_.set(error::fatal);
+					return 0;
+				}
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	バイトコードの長さを取得
+			@return	長さ（END を含む）
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t size() const { return pos_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エラーを受け取る
+			@return エラー
+		*/
+		//-----------------------------------------------------------------//
+		const error_t& get_error() const { return error_; }
+	};
+}
@@ -217,7 +217,7 @@ namespace utils {
 					ch_ = *tx_++;
 					if(ch_ == '>') {
 						ch_ = *tx_++;
-						v <<= factor_();
+						v >>= factor_();
 					} else {
 						error_.set(error::fatal);
 					}
@@ -146,8 +146,8 @@ namespace device {
 			if(intr_level_ > 0) {
 				--level;
 				level ^= 0x03;
-				intr::set_level(SAU::get_peripheral(), level);
-				intr::enable(SAU::get_peripheral());
+				intr::set_level<SAU::get_peripheral()>(level);
+				intr::enable<SAU::get_peripheral()>();
 			}
 
 			return true;
@@ -168,8 +168,8 @@ namespace device {
 			} else {
 				SAU::SDR_L = ch;
 // utils::delay::micro_second(200);
-				while(intr::get_request(SAU::get_peripheral()) == 0) sleep_();
-				intr::set_request(itm::get_peripheral(), 0);
+				while(intr::get_request<SAU::get_peripheral()>() == 0) sleep_();
+				intr::set_request<SAU::get_peripheral()>(0);
 				return SAU::SDR_L();
 			}
 		}
@@ -218,7 +218,7 @@ namespace device {
 		//-----------------------------------------------------------------//
 		void destroy()
 		{
-			intr::enable(SAU::get_peripheral(), false);
+			intr::enable<SAU::get_peripheral()>(false);
 			SAU::ST = 1;  // SAU stop
 			SAU::SS = 0;	// unit disable
 			SAU::SOE = 0;
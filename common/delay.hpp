@@ -1,7 +1,8 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	delay ユーティリティー (RL78/G13 32MHz)
+	@brief	delay ユーティリティー (RL78/G13 32MHz) @n
+			time_base にタイマーが登録されている場合、待ちはタイマーで測る。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2016, 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -9,8 +10,9 @@
 */
 //=====================================================================//
 #include <cstdint>
+#include "common/time_base.hpp"
 
-/// F_CLK が３２、２４以外はエラーにする
+/// F_CLK が３２、２４以外はエラーにする（タイマーが無い時の NOP ループが合わない）
 #if (F_CLK != 32000000) && (F_CLK != 24000000)
 #  error "delay.hpp requires F_CLK to be defined"
 #endif
@@ -30,6 +32,36 @@ namespace utils {
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	class delay {
+
+		static void wait_tick_(uint32_t t) {
+			uint32_t org = time_base::now();
+			while((time_base::now() - org) < t) ;
+		}
+
+		static void loop_(uint16_t us) {
+			while(us > 0) {
+#if (F_CLK == 32000000)
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+#elif (F_CLK == 24000000)
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+				asm("nop"); asm("nop"); asm("nop"); asm("nop");
+#endif
+				--us;
+			}
+			// (2) decw	0xffef0
+			// (1) movw	ax, 0xffef0
+    		// (1) cmpw	ax, #0
+    		// (1) skz
+    		// (3) br	!!4922 <.L629>
+		}
+
 	public:
 
 		//-----------------------------------------------------------------//
@@ -62,27 +94,11 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		static void micro_second(uint16_t us) {
-			while(us > 0) {
-#if (F_CLK == 32000000)
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-#elif (F_CLK == 24000000)
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-				asm("nop"); asm("nop"); asm("nop"); asm("nop");
-#endif
-				--us;
+			if(time_base::is_start()) {
+				wait_tick_(time_base::from_us(us));
+			} else {
+				loop_(us);
 			}
-			// (2) decw	0xffef0
-			// (1) movw	ax, 0xffef0
-    		// (1) cmpw	ax, #0
-    		// (1) skz
-    		// (3) br	!!4922 <.L629>
 		}
 
 
@@ -93,10 +109,123 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		static void milli_second(uint16_t ms) {
+			if(time_base::is_start()) {
+				wait_tick_(time_base::from_ms(ms));
+				return;
+			}
 			while(ms > 0) {
-				micro_second(1000);
+				loop_(1000);
 				--ms;
 			}
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  他の処理を進めながら待つ @n
+					YIELD は「void operator() ()」を持つクラス（スケジューラーの @n
+					service() など）で、待ちの間、繰り返し呼ばれる。 @n
+					タイマーが無い場合、YIELD の処理時間は待ちに含まれない。
+			@param[in]	us		待ち時間（マイクロ秒）
+			@param[in]	yield	待ちの間に呼ぶ処理
+		*/
+		//-----------------------------------------------------------------//
+		template <class YIELD>
+		static void micro_second(uint32_t us, YIELD& yield) {
+			if(time_base::is_start()) {
+				uint32_t org = time_base::now();
+				uint32_t t = time_base::from_us(us);
+				while((time_base::now() - org) < t) {
+					yield();
+				}
+				return;
+			}
+			while(us > 0) {
+				uint16_t n = us > 100 ? 100 : us;
+				loop_(n);
+				us -= n;
+				yield();
+			}
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  期限（タイムアウト）クラス @n
+				タイマーが無い場合、expired() の度に step [uS] 待って、 @n
+				その分を経過時間とする（従来のループと同じ動作）。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class deadline {
+		uint32_t	org_;
+		uint32_t	len_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	us	期限までの時間 [uS]
+		 */
+		//-----------------------------------------------------------------//
+		deadline(uint32_t us = 0) { start(us); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始
+			@param[in]	us	期限までの時間 [uS]
+		 */
+		//-----------------------------------------------------------------//
+		void start(uint32_t us) {
+			if(time_base::is_start()) {
+				org_ = time_base::now();
+				len_ = time_base::from_us(us);
+			} else {
+				org_ = 0;
+				len_ = us;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	期限を過ぎたか
+			@param[in]	step	タイマーが無い場合の待ち時間 [uS]
+			@return 期限を過ぎたら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool expired(uint16_t step = 1) {
+			if(time_base::is_start()) {
+				return (time_base::now() - org_) >= len_;
+			}
+			if(org_ >= len_) return true;
+			delay::micro_second(step);
+			org_ += step;
+			return false;
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  経過時間クラス（タイマーが必要）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class elapsed {
+		uint32_t	org_;
+
+	public:
+		elapsed() : org_(time_base::now()) { }
+
+		void start() { org_ = time_base::now(); }
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	経過時間を取得
+			@return 経過時間 [uS]
+		 */
+		//-----------------------------------------------------------------//
+		uint32_t get_us() const { return time_base::to_us(time_base::now() - org_); }
 	};
 }
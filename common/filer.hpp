@@ -105,7 +105,7 @@ namespace graphics {
 		*/
 		//-----------------------------------------------------------------//
 		bool start() {
-			file_num_ = sdc_.dir_loop("", nullptr, true);
+			file_num_ = sdc_.dir_index("");
 			if(file_num_ > 0) {
 				file_ofs_ = 0;
 				file_pos_ = 0;
@@ -222,15 +222,19 @@ namespace graphics {
 
 			bool fbcopy = false;
 			if(task_ == task::create_list) {
+				// 表示範囲のエントリーだけを読む
+				int16_t kh = bitmap_.get_kfont_height();
+				int16_t top = 0;
+				if(file_ofs_ < 0) top = -file_ofs_ / kh;
 				option_t opt;
 				opt.bmp_ = &bitmap_;
-				opt.ofsy_ = file_ofs_;
-				opt.cnt_ = 0;
+				opt.ofsy_ = file_ofs_ + top * kh;
+				opt.cnt_ = top;
 				opt.match_ = file_pos_;
 				opt.size_ = 0;
 				select_path_[0] = 0;
 				opt.path_ = select_path_;
-				sdc_.dir_loop("", dir_task_, true, &opt);
+				sdc_.dir_page("", top, bitmap_.get_height() / kh + 1, dir_task_, true, &opt);
 				select_size_ = opt.size_;
 				int16_t y = file_pos_ * bitmap_.get_kfont_height() + file_ofs_;
 				bitmap_.reverse(0, y, bitmap_.get_width() - 1, bitmap_.get_kfont_height() - 1);
@@ -0,0 +1,507 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RL78 グループ・データ・フラッシュ・キー／バリュー・ストア @n
+			データ・フラッシュをブロック単位のリング（ログ）として使い、 @n
+			レコードを追記していく。 @n
+			・各ブロックの先頭には、消去回数、マジック、順番を、それぞれ反転と @n
+			  組にして置く（組が合わなければ、書き込み、消去途中の電源断）。 @n
+			・レコードは、キー、長さ、CRC16 と値（４バイト境界）で構成する。 @n
+			・開始時に一度だけ全体を走査して、キー毎の最新レコードの位置を @n
+			  RAM に作る（以後の読み出しは、走査無し）。 @n
+			・アクティブ・ブロックの次のブロックは、常に消去済み（予備）とし、 @n
+			  ブロックが一杯になったら予備に移り、最も古いブロックの有効な @n
+			  レコードを移してから消去する（ブロックは順番に使われるので、 @n
+			  消去回数は均等になる）。 @n
+			・ブロックを消去する前に、消去後の消去回数をアクティブ・ブロックに @n
+			  記録し、消去後に消去回数、マジックの順でヘッダーを書く（マジックが @n
+			  有れば、消去とヘッダーは完了している）。記録の消去回数がヘッダー @n
+			  より大きいブロックは、消去を始めていたので使わない。 @n
+			・書き込み途中の電源断は、CRC で検出して無視する（値を書いてから @n
+			  ヘッダーを書くので、ヘッダーが揃ったレコードは完全）。コンパクション @n
+			  途中の電源断は、次の開始時に続きを行う。消去、ヘッダー書き込み @n
+			  途中の電源断は、次の開始時にブロック全体を検査して消去し直し、 @n
+			  消去回数は記録から戻す。 @n
+			・flash_io を使う場合は、common/flash_io.hpp をインクルードする事。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+
+namespace device {
+	class flash_io;
+}
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  フラッシュ・キー／バリュー・ストア・クラス
+		@param[in]	KEY_NUM	キーの数（0 ～ KEY_NUM - 1）
+		@param[in]	VAL_MAX	値の最大バイト数
+		@param[in]	IO		フラッシュ I/O クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t KEY_NUM = 8, uint8_t VAL_MAX = 28, class IO = device::flash_io>
+	class flash_kvs {
+
+		static constexpr uint16_t BLOCK = IO::data_flash_block;
+		static constexpr uint8_t  BLOCK_MAX = 8;	///< 最大ブロック数（8K バイト）
+		static constexpr uint8_t  HDR = 12;			///< ブロック・ヘッダーのバイト数
+		static constexpr uint8_t  HDR_WEAR = 0;		///< 消去回数
+		static constexpr uint8_t  HDR_MAGIC = 4;	///< マジック
+		static constexpr uint8_t  HDR_SEQ = 8;		///< 順番
+		static constexpr uint16_t MAGIC = 0x4B56;
+		static constexpr uint16_t REC_MAX = (4 + VAL_MAX + 3) & ~3;
+		static constexpr uint16_t NONE = 0xffff;
+		static constexpr uint8_t  NO_BLOCK = 0xff;
+		static constexpr uint8_t  WEAR_KEY = 0xfe;		///< 消去回数レコードのキー
+		static constexpr uint8_t  WEAR_LEN = 3;			///< ブロック番号、消去回数
+		static constexpr uint16_t WEAR_REC = (4 + WEAR_LEN + 3) & ~3;
+		/// 値のレコードは LIMIT まで（残りは、消去回数レコード用）
+		static constexpr uint16_t LIMIT = BLOCK - WEAR_REC * BLOCK_MAX;
+
+		static_assert(KEY_NUM >= 1 && KEY_NUM < WEAR_KEY, "KEY_NUM out of range");
+		static_assert(VAL_MAX >= 1 && VAL_MAX <= 252, "VAL_MAX out of range");
+		// 新しいブロックに、古いブロックの有効なレコードが全て移せる事
+		static_assert((static_cast<uint32_t>(KEY_NUM) * REC_MAX) <= ((BLOCK - HDR) / 2),
+			"KEY_NUM * VAL_MAX too large for a block");
+
+		IO&			io_;
+
+		uint16_t	addr_[KEY_NUM];		///< キー毎の最新レコードの位置
+		uint8_t		len_[KEY_NUM];		///< キー毎の値の長さ
+		uint16_t	seq_[BLOCK_MAX];	///< ブロックの順番
+		uint16_t	wear_[BLOCK_MAX];	///< ブロックの消去回数
+		uint8_t		used_;				///< 使用中ブロックのビット
+		uint16_t	seq_top_;
+		uint16_t	put_;				///< アクティブ・ブロック内の書き込み位置
+		uint8_t		block_num_;
+		uint8_t		active_;
+
+		static uint16_t crc16_(uint16_t crc, const uint8_t* p, uint8_t len)
+		{
+			// CRC-16/CCITT (x^16 + x^12 + x^5 + 1)
+			while(len > 0) {
+				crc ^= static_cast<uint16_t>(*p++) << 8;
+				for(uint8_t i = 0; i < 8; ++i) {
+					if(crc & 0x8000) crc = (crc << 1) ^ 0x1021;
+					else crc <<= 1;
+				}
+				--len;
+			}
+			return crc;
+		}
+
+		static uint16_t rec_size_(uint8_t len) { return (4 + len + 3) & ~3; }
+
+		uint16_t base_(uint8_t b) const { return static_cast<uint16_t>(b) * BLOCK; }
+
+		bool is_used_(uint8_t b) const { return (used_ >> b) & 1; }
+
+		// 順番の比較（一周しても良いように、差の符号で比べる）
+		static bool before_(uint16_t a, uint16_t b)
+		{
+			return static_cast<int16_t>(a - b) < 0;
+		}
+
+		uint8_t next_(uint8_t b) const
+		{
+			++b;
+			return b >= block_num_ ? 0 : b;
+		}
+
+		// 値と反転の組を書く
+		bool write_pair_(uint16_t org, uint16_t v)
+		{
+			uint16_t inv = ~v;
+			uint8_t h[4];
+			h[0] = v & 0xff;
+			h[1] = v >> 8;
+			h[2] = inv & 0xff;
+			h[3] = inv >> 8;
+			return io_.write(org, h, 4);
+		}
+
+		// 値と反転の組を読む（消去済み、組が合わない場合「false」）
+		bool read_pair_(uint16_t org, uint16_t& v)
+		{
+			if(io_.erase_check(org, 4)) return false;
+			uint8_t h[4];
+			if(!io_.read(org, h, 4)) return false;
+			v = h[0] | (static_cast<uint16_t>(h[1]) << 8);
+			uint16_t inv = h[2] | (static_cast<uint16_t>(h[3]) << 8);
+			return v == static_cast<uint16_t>(~inv);
+		}
+
+		// 消去回数、マジックの順に書く（途中の電源断では、マジックが無い）
+		bool write_header_(uint8_t b)
+		{
+			if(!write_pair_(base_(b) + HDR_WEAR, wear_[b])) return false;
+			return write_pair_(base_(b) + HDR_MAGIC, MAGIC);
+		}
+
+		// 消去後の消去回数を、アクティブ・ブロックに記録
+		bool log_wear_(uint8_t b)
+		{
+			if(active_ == NO_BLOCK || active_ == b) return true;
+			// 記録する場所が無い（開始時の修復で、何度も電源断した等）場合は諦める
+			if((put_ + WEAR_REC) > BLOCK) return true;
+			uint8_t v[WEAR_LEN];
+			v[0] = b;
+			v[1] = wear_[b] & 0xff;
+			v[2] = wear_[b] >> 8;
+			return append_(WEAR_KEY, v, WEAR_LEN, BLOCK);
+		}
+
+		// 消去回数を記録してから消去し、ヘッダーを書く
+		bool format_block_(uint8_t b)
+		{
+			used_ &= ~(1 << b);
+			if(wear_[b] < 0xffff) ++wear_[b];
+			if(!log_wear_(b)) return false;
+			if(!io_.erase(base_(b))) return false;
+			return write_header_(b);
+		}
+
+		// 予備ブロックの検査（順番から後ろが全て消去済みで、消去回数とマジックが @n
+		// 有る事）、消去途中の電源断では、先頭だけ消去済みに見える事が有るので、 @n
+		// ブロック全体を検査し、そうでなければ消去し直す。
+		bool prepare_(uint8_t b)
+		{
+			uint16_t org = base_(b);
+			if(io_.erase_check(org + HDR_SEQ, BLOCK - HDR_SEQ)) {
+				if(io_.erase_check(org, HDR_SEQ)) return write_header_(b);
+				uint16_t w;
+				uint16_t m;
+				if(read_pair_(org + HDR_WEAR, w) && w == wear_[b]
+					&& read_pair_(org + HDR_MAGIC, m) && m == MAGIC) {
+					return true;
+				}
+			}
+			return format_block_(b);
+		}
+
+		// 予備ブロックに順番を書いて、アクティブにする
+		bool open_block_(uint8_t b)
+		{
+			if(!prepare_(b)) return false;
+			++seq_top_;
+			if(!write_pair_(base_(b) + HDR_SEQ, seq_top_)) return false;
+			seq_[b] = seq_top_;
+			used_ |= 1 << b;
+			active_ = b;
+			put_ = HDR;
+			return true;
+		}
+
+		// レコードを追記して、インデックスを更新
+		bool append_(uint8_t key, const void* src, uint8_t len, uint16_t limit = LIMIT)
+		{
+			uint16_t sz = rec_size_(len);
+			if((put_ + sz) > limit) return false;
+
+			uint8_t tmp[REC_MAX];
+			tmp[0] = key;
+			tmp[1] = len;
+			std::memcpy(&tmp[4], src, len);
+			for(uint16_t i = 4 + len; i < sz; ++i) tmp[i] = 0xff;
+			uint16_t crc = crc16_(0xffff, tmp, 2);
+			crc = crc16_(crc, &tmp[4], len);
+			tmp[2] = crc & 0xff;
+			tmp[3] = crc >> 8;
+
+			uint16_t org = base_(active_) + put_;
+			put_ += sz;  // 書き込みに失敗しても、その領域は使わない
+			// 値、ヘッダーの順に書く（ヘッダーが揃っていれば、値は書き終わっている）
+			if(sz > 4 && !io_.write(org + 4, &tmp[4], sz - 4)) return false;
+			if(!io_.write(org, tmp, 4)) return false;
+			if(key >= KEY_NUM) return true;
+			addr_[key] = len != 0 ? org : NONE;
+			len_[key] = len;
+			return true;
+		}
+
+		// ブロックを走査してインデックスを更新、書き込み位置を返す
+		uint16_t scan_(uint8_t b)
+		{
+			uint16_t org = base_(b);
+			uint16_t pos = HDR;
+			while((pos + 4) <= BLOCK) {
+				if(io_.erase_check(org + pos, 4)) {
+					if(io_.erase_check(org + pos, BLOCK - pos)) break;  // ログの終端
+					pos += REC_MAX;  // 値だけ書いた所で電源断
+					continue;
+				}
+
+				uint8_t tmp[REC_MAX];
+				if(!io_.read(org + pos, tmp, 4)) return BLOCK;
+				uint8_t key = tmp[0];
+				uint8_t len = tmp[1];
+				uint16_t sz = rec_size_(len);
+				bool wear = key == WEAR_KEY && len == WEAR_LEN;
+				// 壊れたヘッダー（書き込み途中の電源断）の後ろは、REC_MAX 先から続ける @n
+				// （書き込み途中のレコードは REC_MAX を越えないので、その先は消去済み）
+				if((!wear && (key >= KEY_NUM || len > VAL_MAX)) || (pos + sz) > BLOCK) {
+					pos += REC_MAX;
+					continue;
+				}
+
+				if(len > 0 && !io_.read(org + pos + 4, &tmp[4], len)) return BLOCK;
+				uint16_t crc = crc16_(0xffff, tmp, 2);
+				crc = crc16_(crc, &tmp[4], len);
+				bool ok = tmp[2] == (crc & 0xff) && tmp[3] == (crc >> 8);
+				if(ok && wear) {  // 消去回数は、大きい方（ヘッダーより新しい）
+					uint16_t w = tmp[5] | (static_cast<uint16_t>(tmp[6]) << 8);
+					if(tmp[4] < block_num_ && w > wear_[tmp[4]]) wear_[tmp[4]] = w;
+				} else if(ok) {
+					addr_[key] = len != 0 ? (org + pos) : NONE;
+					len_[key] = len;
+				}
+				pos += sz;
+			}
+			return pos < BLOCK ? pos : BLOCK;
+		}
+
+		// 使用中のブロックを古い順に走査して、インデックスを作る（消去回数の記録も戻す）
+		void replay_()
+		{
+			for(uint8_t k = 0; k < KEY_NUM; ++k) {
+				addr_[k] = NONE;
+				len_[k] = 0;
+			}
+			active_ = NO_BLOCK;
+			uint8_t rest = used_;
+			while(rest != 0) {
+				uint8_t b = NO_BLOCK;
+				for(uint8_t i = 0; i < block_num_; ++i) {
+					if(((rest >> i) & 1) == 0) continue;
+					if(b == NO_BLOCK || before_(seq_[i], seq_[b])) b = i;
+				}
+				rest &= ~(1 << b);
+				put_ = scan_(b);
+				seq_top_ = seq_[b];
+				active_ = b;
+			}
+		}
+
+		// ブロック内の有効なレコードをアクティブ・ブロックへ移して消去
+		bool compact_(uint8_t b)
+		{
+			if(b == active_ || !is_used_(b)) return true;
+
+			uint16_t org = base_(b);
+			for(uint8_t k = 0; k < KEY_NUM; ++k) {
+				if(addr_[k] == NONE || addr_[k] < org || addr_[k] >= (org + BLOCK)) continue;
+				uint8_t tmp[REC_MAX];
+				if(!io_.read(addr_[k] + 4, tmp, len_[k])) return false;
+				if(!append_(k, tmp, len_[k])) return false;
+			}
+			return format_block_(b);
+		}
+
+		// 予備ブロックに移り、最も古いブロックを空ける
+		bool rotate_()
+		{
+			uint8_t nb = next_(active_);
+			if(is_used_(nb)) return false;  // 予備が無い（開始時に保証される）
+			if(!open_block_(nb)) return false;
+			return compact_(next_(nb));
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	io		フラッシュ I/O（参照）
+		*/
+		//-----------------------------------------------------------------//
+		flash_kvs(IO& io) : io_(io), addr_(), len_(), seq_(), wear_(), used_(0),
+			seq_top_(0), put_(0), block_num_(0), active_(NO_BLOCK)
+		{ }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  開始（全ブロックを走査して、インデックスを作る） @n
+					※flash_io は、開始済みである事
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool start()
+		{
+			block_num_ = io_.size() / BLOCK;
+			if(block_num_ > BLOCK_MAX) block_num_ = BLOCK_MAX;
+			if(block_num_ < 2) return false;
+
+			used_ = 0;
+			uint16_t hw[BLOCK_MAX];
+			for(uint8_t b = 0; b < block_num_; ++b) {
+				seq_[b] = 0;
+				wear_[b] = 0;
+				hw[b] = 0;
+				// 消去回数、マジックの無いブロック（消去、ヘッダー書き込み途中の電源断等）、 @n
+				// 未使用、順番の書き込み途中の電源断は、再生の後で修復する。
+				uint16_t w;
+				uint16_t m;
+				uint16_t seq;
+				if(!read_pair_(base_(b) + HDR_WEAR, w)) continue;
+				wear_[b] = w;
+				hw[b] = w;
+				if(!read_pair_(base_(b) + HDR_MAGIC, m) || m != MAGIC) continue;
+				if(!read_pair_(base_(b) + HDR_SEQ, seq)) continue;
+				seq_[b] = seq;
+				used_ |= 1 << b;
+			}
+
+			replay_();
+			// 記録の消去回数がヘッダーより大きいブロックは、消去を始めていた（消去途中の電源断）
+			uint8_t bad = 0;
+			for(uint8_t b = 0; b < block_num_; ++b) {
+				if(is_used_(b) && wear_[b] != hw[b]) bad |= 1 << b;
+			}
+			if(bad != 0) {
+				used_ &= ~bad;
+				replay_();
+			}
+
+			if(active_ == NO_BLOCK) {
+				seq_top_ = 0;
+				if(!open_block_(0)) return false;
+			}
+
+			// 使っていないブロックを、予備にする
+			for(uint8_t b = 0; b < block_num_; ++b) {
+				if(!is_used_(b) && !prepare_(b)) return false;
+			}
+
+			// コンパクションの途中で止まっていたら、続きを行う
+			return compact_(next_(active_));
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  書き込み（同じ値が書かれている場合は、何もしない）
+			@param[in]	key	キー
+			@param[in]	src	値
+			@param[in]	len	値の長さ（0 の場合は削除）
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool write(uint8_t key, const void* src, uint8_t len)
+		{
+			if(active_ == NO_BLOCK || key >= KEY_NUM || len > VAL_MAX) return false;
+
+			if(len == len_[key]) {
+				if(len == 0) return true;
+				uint8_t tmp[VAL_MAX];
+				if(io_.read(addr_[key] + 4, tmp, len) && std::memcmp(tmp, src, len) == 0) {
+					return true;
+				}
+			}
+
+			if((put_ + rec_size_(len)) > LIMIT) {
+				if(!rotate_()) return false;
+			}
+			return append_(key, src, len);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  削除
+			@param[in]	key	キー
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool erase(uint8_t key) { return write(key, nullptr, 0); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  読み込み
+			@param[in]	key	キー
+			@param[out]	dst	値の格納先
+			@param[in]	len	格納先の大きさ
+			@return 値の長さ（無い場合「0」）
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t read(uint8_t key, void* dst, uint8_t len)
+		{
+			if(key >= KEY_NUM || addr_[key] == NONE) return 0;
+			if(len > len_[key]) len = len_[key];
+			if(!io_.read(addr_[key] + 4, dst, len)) return 0;
+			return len_[key];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  キーが有効か検査
+			@param[in]	key	キー
+			@return 有効なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool exist(uint8_t key) const { return key < KEY_NUM && addr_[key] != NONE; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ブロック数を取得
+			@return ブロック数
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t get_block_num() const { return block_num_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  ブロックの消去回数を取得
+			@param[in]	b	ブロック番号
+			@return 消去回数
+		*/
+		//-----------------------------------------------------------------//
+		uint16_t get_wear(uint8_t b) const { return b < block_num_ ? wear_[b] : 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  アクティブ・ブロックの空きバイト数を取得
+			@return 空きバイト数
+		*/
+		//-----------------------------------------------------------------//
+		uint16_t get_free() const {
+			if(active_ == NO_BLOCK || put_ >= LIMIT) return 0;
+			return LIMIT - put_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  全て消去して初期化
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool format()
+		{
+			if(block_num_ == 0) return false;
+			// 消去回数を記録する為、アクティブ・ブロックは、最後に消去する
+			uint8_t old = active_;
+			for(uint8_t b = 0; b < block_num_; ++b) {
+				if(b != old && !format_block_(b)) return false;
+			}
+			for(uint8_t k = 0; k < KEY_NUM; ++k) {
+				addr_[k] = NONE;
+				len_[k] = 0;
+			}
+			if(old == NO_BLOCK) return open_block_(0);
+			if(!open_block_(next_(old))) return false;
+			return format_block_(old);
+		}
+	};
+}
@@ -9,46 +9,35 @@
 */
 //=====================================================================//
 #include "common/flash_io.hpp"
+#include "common/flash_kvs.hpp"
 #include "common/format.hpp"
 
 namespace utils {
 
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
-		@brief  フラッシュ・マネージャー・クラス
+		@brief  フラッシュ・マネージャー・クラス @n
+				flash_kvs のキー「0」に、構造体を一つ保存する。
 		@param[in]	ST	構造体
+		@param[in]	IO	フラッシュ I/O クラス
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class ST>
+	template <class ST, class IO = device::flash_io>
 	class flash_man {
 
-		typedef device::flash_io IO;
-
-		IO&		io_;
-
 		struct stt_t {
 			uint32_t	magic_;
 			ST			st_;
 			stt_t(uint32_t magic) : magic_(magic), st_() { }
 		};
 
-		stt_t		stt_;
+		typedef flash_kvs<1, sizeof(stt_t), IO> KVS;
 
-		uint16_t	pacs_;
+		KVS			kvs_;
 
-		uint32_t	magic_;
+		stt_t		stt_;
 
-		uint16_t scan_free_()
-		{
-			uint16_t adr = 0;
-			for(uint16_t i = 0; i < io_.size(); i += pacs_) {
-				adr = i;
-				if(io_.erase_check(adr, sizeof(stt_t))) {
-					return adr;
-				}
-			}
-			return io_.size();  // full !
-		}
+		uint32_t	magic_;
 
 	public:
 		//-----------------------------------------------------------------//
@@ -58,29 +47,23 @@ namespace utils {
 			@param[in]	magic	マジックワード
 		*/
 		//-----------------------------------------------------------------//
-		flash_man(IO& io, uint32_t magic = 0x329F4B71) : io_(io),
-			stt_(magic), pacs_(0), magic_(magic)
+		flash_man(IO& io, uint32_t magic = 0x329F4B71) : kvs_(io),
+			stt_(magic), magic_(magic)
 		{ }
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  開始
+			@brief  開始（インデックスを作る）
 			@return 成功なら「true」
 		*/
 		//-----------------------------------------------------------------//
 		bool start()
 		{
-			uint16_t pacs = 0;
-			for(uint16_t i = 4; i < 15; ++i) {
-				pacs = 1 << i;
-				if(sizeof(stt_t) < pacs) {
-					break;
-				}
-			}
-			pacs_ = pacs;  // パックサイズ
-			utils::format("FlashMan: pac size: %d\n") % pacs_;
-			return true;
+			bool ret = kvs_.start();
+			utils::format("FlashMan: %d blocks, rec size: %d (%d)\n")
+				% static_cast<int>(kvs_.get_block_num()) % sizeof(stt_t) % static_cast<int>(ret);
+			return ret;
 		}
 
 
@@ -93,13 +76,11 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		bool write(const ST& st)
 		{
-			uint16_t adr = scan_free_();
-			if(adr >= io_.size()) return false;
 			stt_.magic_ = magic_;
 			stt_.st_ = st;
-			bool ret = io_.write(adr, &stt_, sizeof(stt_t));
-			utils::format("Write Flash: %04X at %d bytes (%d)\n")
-				% adr % sizeof(stt_t) % static_cast<int>(ret);
+			bool ret = kvs_.write(0, &stt_, sizeof(stt_t));
+			utils::format("Write Flash: %d bytes, free %d (%d)\n")
+				% sizeof(stt_t) % kvs_.get_free() % static_cast<int>(ret);
 			return ret;
 		}
 
@@ -113,31 +94,16 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		bool read(ST& st)
 		{
-			bool ret = false;
-			uint16_t adr;
-			for(adr = 0; adr < io_.size(); adr += pacs_) {
-				if(io_.erase_check(adr, sizeof(stt_t))) {
-					break;
-				}
-				if(!io_.read(adr, &stt_, sizeof(stt_t))) {
-					ret = false;
-					break;
-				} else {
-					ret = true;
-				}
+			if(kvs_.read(0, &stt_, sizeof(stt_t)) != sizeof(stt_t)) {
+				return false;
 			}
-			if(ret) {
-				utils::format("Read Flash: %04X at %d bytes (%d)\n")
-					% adr % sizeof(stt_t) % static_cast<int>(ret);
-				if(stt_.magic_ == magic_) {
-					st = stt_.st_;
-				} else {
-					ret = false;
-					utils::format("Read Flash: magic id error: %08X (%08X)\n")
-						% stt_.magic_ % magic_; 
-				}
+			if(stt_.magic_ != magic_) {
+				utils::format("Read Flash: magic id error: %08X (%08X)\n")
+					% stt_.magic_ % magic_;
+				return false;
 			}
-			return ret;
+			st = stt_.st_;
+			return true;
 		}
 	};
 }
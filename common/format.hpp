@@ -514,11 +514,12 @@ namespace utils {
 				break;
 			case mode::FIXED_REAL:
 				if(num_ == 0) num_ = 6;
-				if(val < 0) {
-					sign = true;
+				if(sign && val < 0) {
 					val = -val;
+				} else {
+					sign = false;
 				}
-				out_fixed_point_<uint64_t>(val, bitlen_, sign);
+				out_fixed_point_<uint64_t>(static_cast<uint32_t>(val), bitlen_, sign);
 				break;
 			default:
 				error_ = error::different;
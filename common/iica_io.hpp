@@ -3,7 +3,8 @@
 /*!	@file
 	@brief	RL78/ (G13/L1C) グループ IICA 制御 @n
 			※マスター動作のみ実装 @n
-			※割り込みに対応していない、ポーリングのみ動作可能
+			※割り込みに対応していない、ポーリングのみ動作可能 @n
+			※send_pt()、recv_pt() は、転送完了を待たずに戻るコルーチン版
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2016, 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -11,6 +12,7 @@
 */
 //=====================================================================//
 #include "common/renesas.hpp"
+#include "common/pt.hpp"
 
 /// F_CLK はボーレートパラメーター計算で必要、設定が無いとエラーにします。
 #ifndef F_CLK
@@ -64,6 +66,17 @@ namespace device {
 		uint8_t		speed_;
 		error		error_;
 
+		// コルーチン用
+		utils::pt	sub_;
+		union {
+			const uint8_t*	src_;
+			uint8_t*		dst_;
+		};
+		uint8_t		len_;
+		uint8_t		idx_;
+		utils::deadline	dl_;
+		bool		fail_;
+
 		inline void sleep_() {
 			asm("nop");
 		} 
@@ -71,13 +84,12 @@ namespace device {
 
 		bool sync_intr_(uint8_t loop)
 		{
-			// 最終クロック検出割り込み
-			while(intr::get_request(IICA::get_peripheral()) == 0) {
-				utils::delay::micro_second(1);
-				if(loop == 0) return false;
-				--loop;
+			// 最終クロック検出割り込み（loop [uS] でタイムアウト）
+			utils::deadline dl(loop);
+			while(intr::get_request<IICA::get_peripheral()>() == 0) {
+				if(dl.expired()) return false;
 			}
-			intr::set_request(IICA::get_peripheral(), 0);
+			intr::set_request<IICA::get_peripheral()>(0);
 			return true;
 		}
 
@@ -123,6 +135,64 @@ namespace device {
 			return f;
 		}
 
+		// コルーチン用の完了待ち（dl_.start() からの時間でタイムアウト）
+		// タイマー（time_base）が無い場合は、呼ばれる度に 1uS 待つ
+		bool poll_intr_()
+		{
+			if(intr::get_request<IICA::get_peripheral()>() != 0) {
+				intr::set_request<IICA::get_peripheral()>(0);
+				fail_ = false;
+				return true;
+			}
+			if(dl_.expired()) {
+				fail_ = true;
+				return true;
+			}
+			return false;
+		}
+
+		void abort_()
+		{
+			IICA::IICCTL0.WREL = 1;
+			IICA::IICCTL0.SPT  = 1;
+		}
+
+		// アドレスの転送（コルーチン）
+		utils::pt_state send_adr_pt_(uint8_t adr)
+		{
+			PT_BEGIN(sub_);
+			if(IICA::IICS.SPD() == 0 || IICA::IICF.IICBSY() != 0) {
+				error_ = error::bus_open;
+				abort_();
+				PT_EXIT(sub_);
+			}
+			IICA::IICCTL0.STT = 1;  // スタート・コンディション（開始）
+			utils::delay::micro_second(1);
+			IICA::IICA = adr;
+			dl_.start(speed_);
+			PT_WAIT_UNTIL(sub_, poll_intr_());
+			if(IICA::IICS.ACKD() == 0) {
+				error_ = error::address;
+				abort_();
+				PT_EXIT(sub_);
+			}
+			PT_END(sub_);
+		}
+
+		// ストップ・コンディション（コルーチン）
+		utils::pt_state out_stop_pt_()
+		{
+			PT_BEGIN(sub_);
+			IICA::IICCTL0.SPT = 1;
+			dl_.start(speed_ / 2);
+			PT_WAIT_UNTIL(sub_, poll_intr_());
+			if(fail_) {
+				error_ = error::stop;
+				PT_EXIT(sub_);
+			}
+			PT_END(sub_);
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -141,7 +211,8 @@ namespace device {
 			@param[in]	sadr	スレーブ・アドレス
 		*/
 		//-----------------------------------------------------------------//
-		iica_io(uint8_t sadr = 0x00) : intr_lvl_(0), sadr_(sadr), speed_(0), error_(error::none) { }
+		iica_io(uint8_t sadr = 0x00) : intr_lvl_(0), sadr_(sadr), speed_(0), error_(error::none),
+			sub_(), src_(nullptr), len_(0), idx_(0), dl_(), fail_(false) { }
 
 
 		//-----------------------------------------------------------------//
@@ -220,7 +291,7 @@ namespace device {
 			manage::set_iica_port(IICA::get_peripheral());
 
 			// 割り込みフラグ・クリア
-			intr::set_request(IICA::get_peripheral(), 0);
+			intr::set_request<IICA::get_peripheral()>(0);
 
 			return out_stop_();
 		}
@@ -408,6 +479,95 @@ namespace device {
 
 			return out_stop_();
 		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信（コルーチン） @n
+					完了するまで、同じ引数で呼び続ける。@n
+					転送中は、他の送受信を呼ばない事。
+			@param[in]	pt	コルーチンの状態
+			@param[in]	adr	７ビットアドレス
+			@param[in]	src	転送元
+			@param[in]	len	送信バイト数
+			@return 転送中なら WAITING、完了で ENDED、エラーなら EXITED
+		 */
+		//-----------------------------------------------------------------//
+		utils::pt_state send_pt(utils::pt& pt, uint8_t adr, const void* src, uint8_t len)
+		{
+			PT_BEGIN(pt);
+			error_ = error::none;
+			src_ = static_cast<const uint8_t*>(src);
+			len_ = len;
+
+			PT_SPAWN(pt, sub_, send_adr_pt_(adr << 1));
+			if(error_ != error::none) PT_EXIT(pt);
+
+			for(idx_ = 0; idx_ < len_; ++idx_) {
+				IICA::IICA = src_[idx_];
+				dl_.start(speed_);
+				PT_WAIT_UNTIL(pt, poll_intr_());
+				if(IICA::IICS.ACKD() == 0) {
+					IICA::IICCTL0.SPT = 1;
+					error_ = error::send_data;
+					PT_EXIT(pt);
+				}
+			}
+
+			PT_SPAWN(pt, sub_, out_stop_pt_());
+			if(error_ != error::none) PT_EXIT(pt);
+			PT_END(pt);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	受信（コルーチン） @n
+					完了するまで、同じ引数で呼び続ける。@n
+					転送中は、他の送受信を呼ばない事。
+			@param[in]	pt	コルーチンの状態
+			@param[in]	adr	７ビットアドレス
+			@param[out]	dst	転送先
+			@param[in]	len	受信バイト数
+			@return 転送中なら WAITING、完了で ENDED、エラーなら EXITED
+		 */
+		//-----------------------------------------------------------------//
+		utils::pt_state recv_pt(utils::pt& pt, uint8_t adr, void* dst, uint8_t len)
+		{
+			PT_BEGIN(pt);
+			error_ = error::none;
+			dst_ = static_cast<uint8_t*>(dst);
+			len_ = len;
+
+			PT_SPAWN(pt, sub_, send_adr_pt_((adr << 1) | 1));
+			if(error_ != error::none) PT_EXIT(pt);
+
+			if(len_ > 1) {
+				IICA::IICCTL0.ACKE = 1;  // ACK 自動生成
+			}
+			IICA::IICCTL0.WREL = 1;  // Wait 削除
+
+			for(idx_ = 0; idx_ < len_; ++idx_) {
+				if(idx_ == (len_ - 1)) {  // last data..
+					IICA::IICCTL0.ACKE = 0;
+				}
+				dl_.start(speed_);
+				PT_WAIT_UNTIL(pt, poll_intr_());
+				if(fail_) {
+					error_ = error::recv_data;
+					abort_();
+					PT_EXIT(pt);
+				}
+				dst_[idx_] = IICA::IICA();
+				if(idx_ != (len_ - 1)) {
+					IICA::IICCTL0.WREL = 1;  // Wait 削除
+				}
+			}
+
+			PT_SPAWN(pt, sub_, out_stop_pt_());
+			if(error_ != error::none) PT_EXIT(pt);
+			PT_END(pt);
+		}
 	};
 
 	template <class IICA> volatile uint8_t iica_io<IICA>::sync_ = 0;
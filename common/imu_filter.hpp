@@ -0,0 +1,224 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	姿勢推定（相補フィルター）クラス @n
+			加速度から求めた傾きと、ジャイロの積分値を混合して、 @n
+			ロール、ピッチ角を求める。浮動小数点演算は使わない。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  相補フィルター・テンプレートクラス @n
+				角度の単位は、0.01 度（centi-degree）
+		@param[in]	ALPHA_SHIFT	加速度側の重み（1 / 2^ALPHA_SHIFT） @n
+								5 の場合、ジャイロ 0.97、加速度 0.03
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t ALPHA_SHIFT = 5>
+	class imu_filter {
+
+		static constexpr uint8_t	FRAC = 4;	///< 内部状態の小数部ビット数
+		static constexpr int32_t	DEG180 = static_cast<int32_t>(18000) << FRAC;
+		static constexpr int32_t	DEG360 = static_cast<int32_t>(36000) << FRAC;
+
+		// atan(i / 32) [0.01 度]、i = 0 ～ 32
+		static constexpr uint16_t atan_tbl_[33] = {
+			   0,  179,  358,  536,  713,  888, 1062, 1234,
+			1404, 1571, 1735, 1897, 2056, 2211, 2363, 2511,
+			2657, 2798, 2936, 3070, 3201, 3327, 3451, 3571,
+			3687, 3800, 3909, 4016, 4119, 4218, 4315, 4409,
+			4500
+		};
+
+		int32_t		roll_;
+		int32_t		pitch_;
+		int32_t		k_;
+		uint8_t		sh_;
+		bool		init_;
+		int16_t		bias_x_;
+		int16_t		bias_y_;
+
+		static int32_t wrap_(int32_t a)
+		{
+			while(a > DEG180) a -= DEG360;
+			while(a <= -DEG180) a += DEG360;
+			return a;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	atan2 を求める（テーブル補間、誤差 0.02 度以内）
+			@param[in]	y	Y（絶対値 131071 以下）
+			@param[in]	x	X（絶対値 131071 以下）
+			@return 角度 [0.01 度]（-17999 ～ 18000）
+		 */
+		//-----------------------------------------------------------------//
+		static int16_t atan2(int32_t y, int32_t x)
+		{
+			if(x == 0 && y == 0) return 0;
+
+			uint32_t ax = x < 0 ? -x : x;
+			uint32_t ay = y < 0 ? -y : y;
+			bool swap = ay > ax;
+			uint32_t mn = swap ? ax : ay;
+			uint32_t mx = swap ? ay : ax;
+			uint32_t z = (mn << 15) / mx;  // 0 ～ 1 (Q15)
+			uint16_t i = z >> 10;
+			int32_t a = atan_tbl_[i];
+			if(i < 32) {
+				int32_t d = static_cast<int32_t>(atan_tbl_[i + 1]) - a;
+				a += (d * static_cast<int32_t>(z & 1023)) >> 10;
+			}
+			if(swap) a = 9000 - a;
+			if(x < 0) a = 18000 - a;
+			if(y < 0) a = -a;
+			return a;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	整数平方根
+			@param[in]	n	値
+			@return 平方根（切り捨て）
+		 */
+		//-----------------------------------------------------------------//
+		static uint16_t isqrt(uint32_t n)
+		{
+			uint32_t r = 0;
+			uint32_t b = static_cast<uint32_t>(1) << 30;
+			while(b > n) b >>= 2;
+			while(b != 0) {
+				if(n >= r + b) {
+					n -= r + b;
+					r = (r >> 1) + b;
+				} else {
+					r >>= 1;
+				}
+				b >>= 2;
+			}
+			return r;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		imu_filter() : roll_(0), pitch_(0), k_(0), sh_(0), init_(false),
+			bias_x_(0), bias_y_(0) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始
+			@param[in]	rate	サンプリング周波数 [Hz]
+			@param[in]	sens10	ジャイロ感度 [LSB/(deg/s) * 10] @n
+								MPU6050 の ±250 deg/s レンジでは 1310
+		 */
+		//-----------------------------------------------------------------//
+		void start(uint16_t rate, uint16_t sens10 = 1310)
+		{
+			// １サンプル当たりの角度 = g * 16000 / (sens10 * rate) [0.01 度 << FRAC]
+			// 積が 32 ビットを超えないよう、係数を 16 ビットに収める
+			uint32_t den = static_cast<uint32_t>(sens10) * rate;
+			if(den == 0) den = 1;
+			uint32_t k = (static_cast<uint32_t>(16000) << 16) / den;
+			uint8_t sh = 16;
+			while(k >= 32768 && sh > 0) {
+				k >>= 1;
+				--sh;
+			}
+			k_ = k;
+			sh_ = sh;
+			reset();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リセット（次の update で加速度から初期化する）
+		 */
+		//-----------------------------------------------------------------//
+		void reset() { init_ = false; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ジャイロのオフセットを設定（静止時の平均値）
+			@param[in]	x	X 軸オフセット
+			@param[in]	y	Y 軸オフセット
+		 */
+		//-----------------------------------------------------------------//
+		void set_gyro_bias(int16_t x, int16_t y)
+		{
+			bias_x_ = x;
+			bias_y_ = y;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１サンプル分の更新
+			@param[in]	ax	加速度 X
+			@param[in]	ay	加速度 Y
+			@param[in]	az	加速度 Z
+			@param[in]	gx	ジャイロ X（ロール角速度）
+			@param[in]	gy	ジャイロ Y（ピッチ角速度）
+		 */
+		//-----------------------------------------------------------------//
+		void update(int16_t ax, int16_t ay, int16_t az, int16_t gx, int16_t gy)
+		{
+			uint32_t yz = static_cast<uint32_t>(static_cast<int32_t>(ay) * ay)
+				+ static_cast<uint32_t>(static_cast<int32_t>(az) * az);
+			int32_t ar = static_cast<int32_t>(atan2(ay, az)) << FRAC;
+			int32_t ap = static_cast<int32_t>(atan2(-static_cast<int32_t>(ax), isqrt(yz))) << FRAC;
+
+			if(!init_) {
+				roll_  = ar;
+				pitch_ = ap;
+				init_ = true;
+				return;
+			}
+
+			roll_  += (static_cast<int32_t>(gx - bias_x_) * k_) >> sh_;
+			pitch_ += (static_cast<int32_t>(gy - bias_y_) * k_) >> sh_;
+
+			roll_ = wrap_(roll_);
+			roll_ += wrap_(ar - roll_) >> ALPHA_SHIFT;
+			roll_ = wrap_(roll_);
+			pitch_ += (ap - pitch_) >> ALPHA_SHIFT;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ロール角を取得
+			@return ロール角 [0.01 度]
+		 */
+		//-----------------------------------------------------------------//
+		int16_t get_roll() const { return roll_ >> FRAC; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ピッチ角を取得
+			@return ピッチ角 [0.01 度]
+		 */
+		//-----------------------------------------------------------------//
+		int16_t get_pitch() const { return pitch_ >> FRAC; }
+	};
+
+	template <uint8_t ALPHA_SHIFT>
+		constexpr uint16_t imu_filter<ALPHA_SHIFT>::atan_tbl_[33];
+}
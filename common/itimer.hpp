@@ -27,9 +27,11 @@ namespace device {
 	class itimer {
 
 		static volatile T counter_;
+		static volatile uint16_t scale_;
 		static TASK task_;
 
-		uint8_t	intr_level_;
+		uint16_t	count_;
+		uint8_t		intr_level_;
 
 		inline void sleep_() const noexcept { asm("nop"); }
 
@@ -41,7 +43,7 @@ namespace device {
 		//-----------------------------------------------------------------//
 		static void task() noexcept __attribute__ ((section (".lowtext")))
 		{
-			++counter_;
+			counter_ += scale_;
 			task_();
 		}
 
@@ -51,7 +53,7 @@ namespace device {
 			@brief  コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		itimer() noexcept : intr_level_(0) { }
+		itimer() noexcept : count_(0), intr_level_(0) { }
 
 
 		//-----------------------------------------------------------------//
@@ -76,6 +78,8 @@ namespace device {
 
 			system::OSMC.WUTMMCK0 = 1;
 
+			count_ = v;
+			scale_ = 1;
 			itm::ITMC = (v - 1) | 0x8000;
 
 			counter_ = 0;
@@ -84,8 +88,8 @@ namespace device {
 			if(level > 0) {
 				--level;
 				level ^= 0x03;
-				intr::set_level(itm::get_peripheral(), level);
-				intr::enable(itm::get_peripheral());
+				intr::set_level<itm::get_peripheral()>(level);
+				intr::enable<itm::get_peripheral()>();
 			}
 
 			return true;
@@ -94,7 +98,40 @@ namespace device {
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief  同期回数を取得
+			@brief  割り込み周期の倍率を設定（tickless 用） @n
+					比較値を変更すると、カウントは０から再開するので、 @n
+					割り込みの直後（sync() の後）に呼ぶ。
+			@param[in]	n	start() で設定した周期に対する倍率
+			@return 設定した倍率（範囲外は制限される）
+		*/
+		//-----------------------------------------------------------------//
+		uint16_t set_scale(uint16_t n) noexcept
+		{
+			if(count_ == 0) return 0;
+			uint16_t max = 4096 / count_;
+			if(n > max) n = max;
+			else if(n == 0) n = 1;
+			if(n == scale_) return n;
+
+			itm::ITMC = 0;  // RINTE = 0 の時に比較値を変更する
+			scale_ = n;
+			itm::ITMC = (count_ * n - 1) | 0x8000;
+			return n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  割り込み周期の倍率を取得
+			@return 倍率
+		*/
+		//-----------------------------------------------------------------//
+		static uint16_t get_scale() noexcept { return scale_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  同期回数を取得（start() で設定した周期単位）
 			@return 同期回数
 		*/
 		//-----------------------------------------------------------------//
@@ -112,8 +149,8 @@ namespace device {
 				volatile T counter = counter_;
 				while(counter == counter_) sleep_();
 			} else {
-				while(intr::get_request(itm::get_peripheral()) == 0) sleep_();
-				intr::set_request(itm::get_peripheral(), 0);
+				while(intr::get_request<itm::get_peripheral()>() == 0) sleep_();
+				intr::set_request<itm::get_peripheral()>(0);
 				++counter_;
 			}
 		}
@@ -122,6 +159,9 @@ namespace device {
 	template<typename T, class TASK>
 		volatile T itimer<T, TASK>::counter_ = 0;
 
+	template<typename T, class TASK>
+		volatile uint16_t itimer<T, TASK>::scale_ = 1;
+
 	template<typename T, class TASK>
 		TASK itimer<T, TASK>::task_;
 }
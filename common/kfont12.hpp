@@ -21,14 +21,40 @@ namespace graphics {
 	template <uint8_t CASH_SIZE>
 	class kfont12 {
 
+		static_assert(CASH_SIZE >= 2 && (CASH_SIZE & (CASH_SIZE - 1)) == 0,
+			"CASH_SIZE must be a power of two (2 or more)");
+
+		// セット・アソシエイティブ（セット内は LRU で置換）
+		static constexpr uint8_t WAYS = CASH_SIZE >= 8 ? 4 : 2;
+		static constexpr uint8_t SETS = CASH_SIZE / WAYS;
+
+		// kfont12.bin のクラスタ・リンク・マップ（断片化が少なければ数エントリで足りる）
+		static constexpr uint8_t CLMT_SIZE = 16;
+
+		static constexpr uint8_t FONT_SIZE = 18;
+
 		struct kanji_cash {
 			uint16_t	code;
-			uint8_t		bitmap[18];
+			uint8_t		age;  ///< 最後に参照した時の tick_（大きい程新しい）
+			uint8_t		bitmap[FONT_SIZE];
 		};
-		kanji_cash cash_[CASH_SIZE];
-		uint8_t cash_idx_;
+		kanji_cash cash_[SETS][WAYS];
+		uint8_t	tick_;
+		uint8_t	mark_;  ///< 先読みを始めた時の tick_（これより新しい物は追い出さない）
+
+		uint16_t	hit_;
+		uint16_t	miss_;
 
 		bool	mount_;
+#if _USE_FASTSEEK
+		bool	clmt_valid_;
+		DWORD	clmt_[CLMT_SIZE];
+#endif
+
+		struct load_t {
+			uint16_t	code;
+			uint16_t	lin;
+		};
 
 		static uint16_t sjis_to_liner_(uint16_t sjis)
 		{
@@ -56,15 +82,126 @@ namespace graphics {
 			return code;
 		}
 
+		static uint8_t hash_(uint16_t code)
+		{
+			return (code ^ (code >> 4) ^ (code >> 8)) & (SETS - 1);
+		}
+
+		// tick_ が一杯になったら、全ての age を半分にする（順番は保たれる）
+		void touch_(kanji_cash& c)
+		{
+			if(tick_ == 0xff) {
+				for(uint8_t i = 0; i < SETS; ++i) {
+					for(uint8_t j = 0; j < WAYS; ++j) {
+						cash_[i][j].age >>= 1;
+					}
+				}
+				tick_ >>= 1;
+				mark_ >>= 1;
+			}
+			c.age = ++tick_;
+		}
+
+		kanji_cash* find_(uint16_t code)
+		{
+			uint8_t set = hash_(code);
+			for(uint8_t i = 0; i < WAYS; ++i) {
+				if(cash_[set][i].code == code) {
+					touch_(cash_[set][i]);
+					return &cash_[set][i];
+				}
+			}
+			return nullptr;
+		}
+
+		// protect が「true」の場合、mark_ より後に使った物しか無ければ nullptr
+		kanji_cash* victim_(uint16_t code, bool protect)
+		{
+			uint8_t set = hash_(code);
+			uint8_t way = 0;
+			for(uint8_t i = 0; i < WAYS; ++i) {
+				if(cash_[set][i].code == 0) {
+					way = i;
+					break;
+				}
+				if(cash_[set][i].age < cash_[set][way].age) way = i;
+			}
+			if(protect && cash_[set][way].code != 0 && cash_[set][way].age > mark_) {
+				return nullptr;
+			}
+			touch_(cash_[set][way]);
+			return &cash_[set][way];
+		}
+
+		bool open_(FIL& fp)
+		{
+			if(f_open(&fp, "/kfont12.bin", FA_READ) != FR_OK) {
+				return false;
+			}
+#if _USE_FASTSEEK
+			// クラスタ・リンク・マップは、マウント中一度だけ作り、以降は使いまわす。
+			fp.cltbl = clmt_;
+			if(!clmt_valid_) {
+				clmt_[0] = CLMT_SIZE;
+				if(f_lseek(&fp, CREATE_LINKMAP) == FR_OK) {
+					clmt_valid_ = true;
+				} else {
+					fp.cltbl = nullptr;
+				}
+			}
+#endif
+			return true;
+		}
+
+		// オフセット順に並べ、一度のオープンで順次読み込む
+		void load_(load_t* list, uint8_t num, bool protect)
+		{
+			for(uint8_t i = 1; i < num; ++i) {
+				load_t t = list[i];
+				uint8_t j = i;
+				while(j > 0 && list[j - 1].lin > t.lin) {
+					list[j] = list[j - 1];
+					--j;
+				}
+				list[j] = t;
+			}
+
+			FIL fp;
+			if(!open_(fp)) return;
+
+			for(uint8_t i = 0; i < num; ++i) {
+				if(f_lseek(&fp, static_cast<uint32_t>(list[i].lin) * FONT_SIZE) != FR_OK) {
+					break;
+				}
+				auto p = victim_(list[i].code, protect);
+				if(p == nullptr) continue;  // 描画時に読む
+				p->code = 0;
+				UINT rs;
+				if(f_read(&fp, &p->bitmap[0], FONT_SIZE, &rs) != FR_OK || rs != FONT_SIZE) {
+					break;
+				}
+				p->code = list[i].code;
+			}
+
+			f_close(&fp);
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		kfont12() : cash_idx_(0), mount_(false) {
-			for(uint8_t i = 0; i < CASH_SIZE; ++i) {
-				cash_[i].code = 0;
+		kfont12() : tick_(0), mark_(0), hit_(0), miss_(0), mount_(false)
+#if _USE_FASTSEEK
+			, clmt_valid_(false)
+#endif
+		{
+			for(uint8_t i = 0; i < SETS; ++i) {
+				for(uint8_t j = 0; j < WAYS; ++j) {
+					cash_[i][j].code = 0;
+					cash_[i][j].age = 0;
+				}
 			}
 		}
 
@@ -90,68 +227,127 @@ namespace graphics {
 			@brief	マウント状態の設定
 		*/
 		//-----------------------------------------------------------------//
-		void set_mount(bool f) { mount_ = f; }
+		void set_mount(bool f) {
+#if _USE_FASTSEEK
+			if(mount_ != f) clmt_valid_ = false;
+#endif
+			mount_ = f;
+		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
-			@brief	文字のビットマップを取得
-			@param[in]	code	文字コード（unicode）
-			@return 文字のビットマップ
+			@brief	キャッシュのヒット数を取得
+			@return ヒット数
 		*/
 		//-----------------------------------------------------------------//
-		const uint8_t* get(uint16_t code) {
+		uint16_t get_hit() const { return hit_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュのミス数を取得
+			@return ミス数
+		*/
+		//-----------------------------------------------------------------//
+		uint16_t get_miss() const { return miss_; }
 
-			if(code == 0) return nullptr;
 
-			// キャッシュ内検索
-			int8_t n = -1;
-			for(uint8_t i = 0; i < CASH_SIZE; ++i) {
-				if(cash_[i].code == code) {
-					return &cash_[i].bitmap[0];
-				} else if(cash_[i].code == 0) {
-					n = i;
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ヒット数、ミス数をリセット
+		*/
+		//-----------------------------------------------------------------//
+		void reset_stat() { hit_ = 0; miss_ = 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	文字列の漢字を先読みする @n
+					キャッシュに無い文字をまとめて、一度のオープンで読み込む。 @n
+					この文字列で使う（先読み中に参照、読み込みした）文字を @n
+					追い出す場合は読まずに、描画時の get() に任せる。
+			@param[in]	text	テキスト（UTF-8）
+		*/
+		//-----------------------------------------------------------------//
+		void prefetch(const char* text) {
+			if(!mount_ || text == nullptr) return;
+
+			mark_ = tick_;
+			load_t list[CASH_SIZE];
+			uint8_t num = 0;
+			uint16_t code = 0;
+			uint8_t cnt = 0;
+			char ch;
+			while((ch = *text++) != 0 && num < CASH_SIZE) {
+				uint8_t c = static_cast<uint8_t>(ch);
+				if(c < 0x80) {
+					cnt = 0;
+					continue;
+				} else if((c & 0xf0) == 0xe0) {
+					code = c & 0x0f;
+					cnt = 2;
+					continue;
+				} else if((c & 0xe0) == 0xc0) {
+					code = c & 0x1f;
+					cnt = 1;
+					continue;
+				} else if((c & 0xc0) != 0x80 || cnt == 0) {
+					cnt = 0;
+					continue;
 				}
-			}
-			if(n >= 0) cash_idx_ = n;
-			else {
-				for(uint8_t i = 0; i < CASH_SIZE; ++i) {
-					++cash_idx_;
-					if(cash_idx_ >= CASH_SIZE) cash_idx_ = 0;
-					if(cash_[cash_idx_].code != 0) {
-						break;
-					}
+				code <<= 6;
+				code |= c & 0x3f;
+				--cnt;
+				if(cnt != 0 || code < 0x80) continue;
+
+				if(find_(code) != nullptr) continue;
+				bool dup = false;
+				for(uint8_t i = 0; i < num; ++i) {
+					if(list[i].code == code) { dup = true; break; }
 				}
+				if(dup) continue;
+				uint16_t lin = sjis_to_liner_(ff_convert(code, 0));
+				if(lin == 0xffff) continue;
+				list[num].code = code;
+				list[num].lin = lin;
+				++num;
 			}
+			if(num > 0) load_(list, num, true);
+		}
 
-			if(!mount_) return nullptr;
 
-			uint32_t lin = sjis_to_liner_(ff_convert(code, 0));
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	文字のビットマップを取得
+			@param[in]	code	文字コード（unicode）
+			@return 文字のビットマップ
+		*/
+		//-----------------------------------------------------------------//
+		const uint8_t* get(uint16_t code) {
+
+			if(code == 0) return nullptr;
 
-			if(lin == 0xffff) {
-				return nullptr;
+			auto p = find_(code);
+			if(p != nullptr) {
+				++hit_;
+				return &p->bitmap[0];
 			}
+			++miss_;
 
-			FIL fp;
-			if(f_open(&fp, "/kfont12.bin", FA_READ) != FR_OK) {
-				return nullptr;
-			}
- 
-			if(f_lseek(&fp, lin * 18) != FR_OK) {
-				f_close(&fp);
-				return nullptr;
-			}
+			if(!mount_) return nullptr;
 
-			UINT rs;
-			if(f_read(&fp, &cash_[cash_idx_].bitmap[0], 18, &rs) != FR_OK) {
-				f_close(&fp);
+			load_t t;
+			t.code = code;
+			t.lin = sjis_to_liner_(ff_convert(code, 0));
+			if(t.lin == 0xffff) {
 				return nullptr;
 			}
-			cash_[cash_idx_].code = code;
-
-			f_close(&fp);
+			load_(&t, 1, false);
 
-			return &cash_[cash_idx_].bitmap[0];
+			p = find_(code);
+			if(p != nullptr) return &p->bitmap[0];
+			return nullptr;
 		}
 	};
 }
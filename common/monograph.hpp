@@ -36,6 +36,7 @@ namespace graphics {
 		static const int8_t width = 0;
 		static const int8_t height = 0;
 		const uint8_t* get(uint16_t code) { return nullptr; }
+		void prefetch(const char* text) { }
 	};
 
 
@@ -51,20 +52,144 @@ namespace graphics {
 	template <uint16_t WIDTH, uint16_t HEIGHT, class AFONT = afont_null, class KFONT = kfont_null>
 	class monograph {
 
+		static_assert(WIDTH <= 256, "WIDTH must be 256 or less (dirty column is 8 bits)");
+
+		static constexpr uint8_t PAGE_NUM = HEIGHT / 8;
+
 		KFONT& kfont_;
 
 		uint8_t	fb_[WIDTH * HEIGHT / 8];
 
+		// ページ毎の更新カラム範囲（beg > end なら更新無し）
+		uint8_t	dirty_beg_[PAGE_NUM];
+		uint8_t	dirty_end_[PAGE_NUM];
+
 		uint16_t	code_;
 		uint8_t		cnt_;
 
+		void dirty_(int16_t x, int16_t y, int16_t w, int16_t h) {
+			if(w <= 0 || h <= 0) return;
+			int16_t xe = x + w - 1;
+			int16_t ye = y + h - 1;
+			if(x < 0) x = 0;
+			if(y < 0) y = 0;
+			if(xe >= static_cast<int16_t>(WIDTH)) xe = WIDTH - 1;
+			if(ye >= static_cast<int16_t>(HEIGHT)) ye = HEIGHT - 1;
+			if(x > xe || y > ye) return;
+			for(uint8_t page = y >> 3; page <= (ye >> 3); ++page) {
+				if(dirty_beg_[page] > x) dirty_beg_[page] = x;
+				if(dirty_end_[page] < xe) dirty_end_[page] = xe;
+			}
+		}
+
+		void set_(int16_t x, int16_t y) {
+			if(static_cast<uint16_t>(x) >= WIDTH) return;
+			if(static_cast<uint16_t>(y) >= HEIGHT) return;
+#ifdef LED16X16
+			fb_[((x & 8) >> 3) + (y << 1)] |= (1 << (x & 7));
+#else
+			fb_[(y >> 3) * WIDTH + x] |= (1 << (y & 7));
+#endif
+		}
+
+		void reset_(int16_t x, int16_t y) {
+			if(static_cast<uint16_t>(x) >= WIDTH) return;
+			if(static_cast<uint16_t>(y) >= HEIGHT) return;
+#ifdef LED16X16
+			fb_[((x & 8) >> 3) + (y << 1)] &= ~(1 << (x & 7));
+#else
+			fb_[(y >> 3) * WIDTH + x] &= ~(1 << (y & 7));
+#endif
+		}
+
+		void reverse_(int16_t x, int16_t y) {
+			if(static_cast<uint16_t>(x) >= WIDTH) return;
+			if(static_cast<uint16_t>(y) >= HEIGHT) return;
+#ifdef LED16X16
+			fb_[((x & 8) >> 3) + (y << 1)] ^= (1 << (x & 7));
+#else
+			fb_[(y >> 3) * WIDTH + x] ^= (1 << (y & 7));
+#endif
+		}
+
+		enum class OP : uint8_t {
+			RESET,
+			SET,
+			REVERSE,
+		};
+
+		// 矩形をページ（縦８ピクセル）単位のマスクで塗る
+		void span_(int16_t x, int16_t y, int16_t w, int16_t h, OP op) {
+			if(w <= 0 || h <= 0) return;
+			int16_t xe = x + w - 1;
+			int16_t ye = y + h - 1;
+			if(x < 0) x = 0;
+			if(y < 0) y = 0;
+			if(xe >= static_cast<int16_t>(WIDTH)) xe = WIDTH - 1;
+			if(ye >= static_cast<int16_t>(HEIGHT)) ye = HEIGHT - 1;
+			if(x > xe || y > ye) return;
+#ifdef LED16X16
+			for(int16_t i = y; i <= ye; ++i) {
+				for(int16_t j = x; j <= xe; ++j) {
+					if(op == OP::SET) set_(j, i);
+					else if(op == OP::RESET) reset_(j, i);
+					else reverse_(j, i);
+				}
+			}
+#else
+			uint16_t n = xe - x + 1;
+			uint8_t pe = ye >> 3;
+			for(uint8_t page = y >> 3; page <= pe; ++page) {
+				uint8_t m = 0xff;
+				if(page == (y >> 3)) m &= 0xff << (y & 7);
+				if(page == pe) m &= 0xff >> (7 - (ye & 7));
+				uint8_t* p = &fb_[page * WIDTH + x];
+				if(op == OP::SET) {
+					for(uint16_t i = 0; i < n; ++i) *p++ |= m;
+				} else if(op == OP::RESET) {
+					m = ~m;
+					for(uint16_t i = 0; i < n; ++i) *p++ &= m;
+				} else {
+					for(uint16_t i = 0; i < n; ++i) *p++ ^= m;
+				}
+			}
+#endif
+		}
+
+		// 縦長の線（dy >= dx）：同じバイトのピクセルをまとめて書く
+		template <bool DOWN>
+		void steep_(uint8_t* p, uint8_t k, int16_t dx, int16_t dy, int16_t sx, uint8_t clr) {
+			int16_t m = 0;
+			uint8_t acc = 0;
+			for(int16_t i = 0; i < dy; i++) {
+				acc |= k;
+				if(DOWN) k <<= 1;
+				else k >>= 1;
+				if(k == 0) {
+					*p = (*p | acc) ^ (acc & clr);
+					acc = 0;
+					k = DOWN ? 0x01 : 0x80;
+					p += DOWN ? WIDTH : -WIDTH;
+				}
+				m += dx;
+				if(m >= dy) {
+					m -= dy;
+					*p = (*p | acc) ^ (acc & clr);
+					acc = 0;
+					p += sx;
+				}
+			}
+			acc |= k;
+			*p = (*p | acc) ^ (acc & clr);
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		monograph(KFONT& kf) : kfont_(kf), code_(0), cnt_(0) { }
+		monograph(KFONT& kf) : kfont_(kf), code_(0), cnt_(0) { set_dirty_all(); }
 
 
 		//-----------------------------------------------------------------//
@@ -139,6 +264,63 @@ namespace graphics {
 		uint8_t page_num() const { return HEIGHT / 8; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ページの更新範囲を取得
+			@param[in]	page	ページ
+			@param[out]	beg		更新開始カラム
+			@param[out]	end		更新終了カラム（この位置を含む）
+			@return 更新がある場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_dirty(uint8_t page, uint8_t& beg, uint8_t& end) const {
+			if(page >= PAGE_NUM) return false;
+			beg = dirty_beg_[page];
+			end = dirty_end_[page];
+			return beg <= end;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	更新があるか検査
+			@return 更新がある場合「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_dirty() const {
+			for(uint8_t i = 0; i < PAGE_NUM; ++i) {
+				if(dirty_beg_[i] <= dirty_end_[i]) return true;
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	更新範囲をクリア（転送後に呼ぶ）
+		*/
+		//-----------------------------------------------------------------//
+		void clear_dirty() {
+			for(uint8_t i = 0; i < PAGE_NUM; ++i) {
+				dirty_beg_[i] = 0xff;
+				dirty_end_[i] = 0;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	全画面を更新範囲にする
+		*/
+		//-----------------------------------------------------------------//
+		void set_dirty_all() {
+			for(uint8_t i = 0; i < PAGE_NUM; ++i) {
+				dirty_beg_[i] = 0;
+				dirty_end_[i] = WIDTH - 1;
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	点を描画する
@@ -149,11 +331,9 @@ namespace graphics {
 		void point_set(int16_t x, int16_t y) {
 			if(static_cast<uint16_t>(x) >= WIDTH) return;
 			if(static_cast<uint16_t>(y) >= HEIGHT) return;
-#ifdef LED16X16
-			fb_[((x & 8) >> 3) + (y << 1)] |= (1 << (x & 7));
-#else
-			fb_[((y & 0xf8) << 4) + x] |= (1 << (y & 7));
-#endif
+			set_(x, y);
+			if(dirty_beg_[y >> 3] > x) dirty_beg_[y >> 3] = x;
+			if(dirty_end_[y >> 3] < x) dirty_end_[y >> 3] = x;
 		}
 
 
@@ -167,11 +347,9 @@ namespace graphics {
 		void point_reset(int16_t x, int16_t y) {
 			if(static_cast<uint16_t>(x) >= WIDTH) return;
 			if(static_cast<uint16_t>(y) >= HEIGHT) return;
-#ifdef LED16X16
-			fb_[((x & 8) >> 3) + (y << 1)] &= ~(1 << (x & 7));
-#else
-			fb_[((y & 0xf8) << 4) + x] &= ~(1 << (y & 7));
-#endif
+			reset_(x, y);
+			if(dirty_beg_[y >> 3] > x) dirty_beg_[y >> 3] = x;
+			if(dirty_end_[y >> 3] < x) dirty_end_[y >> 3] = x;
 		}
 
 
@@ -185,11 +363,9 @@ namespace graphics {
 		void point_reverse(int16_t x, int16_t y) {
 			if(static_cast<uint16_t>(x) >= WIDTH) return;
 			if(static_cast<uint16_t>(y) >= HEIGHT) return;
-#ifdef LED16X16
-			fb_[((x & 8) >> 3) + (y << 1)] ^= (1 << (x & 7));
-#else
-			fb_[((y & 0xf8) << 4) + x] ^= (1 << (y & 7));
-#endif
+			reverse_(x, y);
+			if(dirty_beg_[y >> 3] > x) dirty_beg_[y >> 3] = x;
+			if(dirty_end_[y >> 3] < x) dirty_end_[y >> 3] = x;
 		}
 
 
@@ -204,19 +380,8 @@ namespace graphics {
 		*/
 		//-----------------------------------------------------------------//
 		void fill(int16_t x, int16_t y, int16_t w, int16_t h, bool c) {
-			if(c) {
-				for(int16_t i = y; i < (y + h); ++i) {
-					for(int16_t j = x; j < (x + w); ++j) {
-						point_set(j, i);
-					}
-				}
-			} else {
-				for(int16_t i = y; i < (y + h); ++i) {
-					for(int16_t j = x; j < (x + w); ++j) {
-						point_reset(j, i);
-					}
-				}
-			}
+			dirty_(x, y, w, h);
+			span_(x, y, w, h, c ? OP::SET : OP::RESET);
 		}
 
 
@@ -230,11 +395,8 @@ namespace graphics {
 		*/
 		//-----------------------------------------------------------------//
 		void reverse(int16_t x, int16_t y, int16_t w, int16_t h) {
-			for(int16_t i = y; i < (y + h); ++i) {
-				for(int16_t j = x; j < (x + w); ++j) {
-					point_reverse(j, i);
-				}
-			}
+			dirty_(x, y, w, h);
+			span_(x, y, w, h, OP::REVERSE);
 		}
 
 
@@ -248,6 +410,7 @@ namespace graphics {
 			for(uint16_t i = 0; i < (WIDTH * HEIGHT / 8); ++i) {
 				fb_[i] = c;
 			}
+			set_dirty_all();
 		}
 
 
@@ -258,7 +421,7 @@ namespace graphics {
 		*/
 		//-----------------------------------------------------------------//
 		void clear(bool c) {
-			fill(0, 0, WIDTH, HEIGHT, c);
+			flash(c ? 0xff : 0x00);
 		}
 
 
@@ -279,14 +442,47 @@ namespace graphics {
 			int16_t sy;
 			if(x2 >= x1) { dx = x2 - x1; sx = 1; } else { dx = x1 - x2; sx = -1; }
 			if(y2 >= y1) { dy = y2 - y1; sy = 1; } else { dy = y1 - y2; sy = -1; }
+			dirty_(sx > 0 ? x1 : x2, sy > 0 ? y1 : y2, dx + 1, dy + 1);
 
 			int16_t m = 0;
 			int16_t x = x1;
 			int16_t y = y1;
+#ifndef LED16X16
+			// 画面内の線は、アドレスとマスクを差分で更新し、範囲の検査を省く。
+			// 縦長の線は、同じバイトのピクセルをまとめて、１バイト毎に書く。
+			if(static_cast<uint16_t>(x1) < WIDTH && static_cast<uint16_t>(x2) < WIDTH
+				&& static_cast<uint16_t>(y1) < HEIGHT && static_cast<uint16_t>(y2) < HEIGHT) {
+				uint8_t* p = &fb_[(y >> 3) * WIDTH + x];
+				uint8_t k = 1 << (y & 7);
+				uint8_t clr = c ? 0x00 : 0xff;
+				if(dx > dy) {
+					for(int16_t i = 0; i <= dx; i++) {
+						*p = (*p | k) ^ (k & clr);
+						m += dy;
+						if(m >= dx) {
+							m -= dx;
+							if(sy > 0) {
+								k <<= 1;
+								if(k == 0) { k = 0x01; p += WIDTH; }
+							} else {
+								k >>= 1;
+								if(k == 0) { k = 0x80; p -= WIDTH; }
+							}
+						}
+						p += sx;
+					}
+				} else if(sy > 0) {
+					steep_<true>(p, k, dx, dy, sx, clr);
+				} else {
+					steep_<false>(p, k, dx, dy, sx, clr);
+				}
+				return;
+			}
+#endif
 			if(dx > dy) {
 				for(int16_t i = 0; i <= dx; i++) {
-					if(c) point_set(x, y);
-					else point_reset(x, y);
+					if(c) set_(x, y);
+					else reset_(x, y);
 					m += dy;
 					if(m >= dx) {
 						m -= dx;
@@ -296,8 +492,8 @@ namespace graphics {
 				}
 			} else {
 				for(int16_t i = 0; i <= dy; i++) {
-					if(c) point_set(x, y);
-					else point_reset(x, y);
+					if(c) set_(x, y);
+					else reset_(x, y);
 					m += dx;
 					if(m >= dy) {
 						m -= dy;
@@ -320,22 +516,23 @@ namespace graphics {
 		*/
 		//-----------------------------------------------------------------//
 		void frame(int16_t x, int16_t y, int16_t w, int16_t h, bool c) {
+			dirty_(x, y, w, h);
 			for(int16_t i = 0; i < w; ++i) {
 				if(c) {
-					point_set(x + i, y);
-					point_set(x + i, y + h - 1);
+					set_(x + i, y);
+					set_(x + i, y + h - 1);
 				} else {
-					point_reset(x + i, y);
-					point_reset(x + i, y + h - 1);
+					reset_(x + i, y);
+					reset_(x + i, y + h - 1);
 				}
 			}
 			for(int16_t i = 0; i < h; ++i) {
 				if(c) {
-					point_set(x, y + i);
-					point_set(x + w - 1, y + i);
+					set_(x, y + i);
+					set_(x + w - 1, y + i);
 				} else {
-					point_reset(x, y + i);
-					point_reset(x + w - 1, y + i);
+					reset_(x, y + i);
+					reset_(x + w - 1, y + i);
 				}
 			}
 		}
@@ -355,12 +552,14 @@ namespace graphics {
 		{
 			if(img == nullptr) return;
 
+			dirty_(x, y, w, h);
+#ifdef LED16X16
 			uint8_t k = 1;
 			uint8_t c = *img++;
 			for(uint8_t i = 0; i < h; ++i) {
 				int16_t xx = x;
 				for(uint8_t j = 0; j < w; ++j) {
-					if(c & k) point_set(xx, y);
+					if(c & k) set_(xx, y);
 					k <<= 1;
 					if(k == 0) {
 						k = 1;
@@ -370,6 +569,73 @@ namespace graphics {
 				}
 				++y;
 			}
+#else
+			// 横８ピクセル、縦８ラインのブロック毎に、ソースの行（横８ビット）を
+			// 縦のバイト（ページのカラム）に転置し、カラム毎にシフトして書く。
+			uint8_t js = 0;
+			if(x < 0) {
+				if(-x >= w) return;
+				js = -x;
+			}
+			uint8_t je = w;
+			if((x + w) > static_cast<int16_t>(WIDTH)) {
+				if(x >= static_cast<int16_t>(WIDTH)) return;
+				je = WIDTH - x;
+			}
+			for(uint8_t i0 = 0; i0 < h; i0 += 8) {
+				int16_t yy = y + i0;
+				if(yy >= static_cast<int16_t>(HEIGHT)) break;
+				if((yy + 8) <= 0) continue;
+				// 書き込むページ（上側と下側）とシフト量
+				int16_t page = yy >> 3;
+				uint8_t sft = yy & 7;
+				uint8_t* p0 = (page >= 0) ? &fb_[page * WIDTH + x] : nullptr;
+				uint8_t* p1 = (sft != 0 && (page + 1) < static_cast<int16_t>(PAGE_NUM))
+					? &fb_[(page + 1) * WIDTH + x] : nullptr;
+				uint8_t rows = (h - i0) < 8 ? (h - i0) : 8;
+				for(uint8_t j0 = js; j0 < je; j0 += 8) {
+					uint8_t n = (je - j0) < 8 ? (je - j0) : 8;
+					uint8_t nm = 0xff >> (8 - n);
+					// ソースの行を８ビットずつ取り出す（x、y 共に下位ビットが先）
+					uint8_t r[8] = { 0 };
+					uint16_t b = static_cast<uint16_t>(i0) * w + j0;
+					for(uint8_t i = 0; i < rows; ++i) {
+						const uint8_t* src = &img[b >> 3];
+						uint8_t bs = b & 7;
+						uint16_t v = src[0];
+						if((bs + n) > 8) v |= static_cast<uint16_t>(src[1]) << 8;
+						r[i] = (v >> bs) & nm;
+						b += w;
+					}
+					// ８ｘ８ビットの転置（t[k] のビット i は、r[i] のビット k）
+					uint32_t lo = static_cast<uint32_t>(r[0]) | (static_cast<uint32_t>(r[1]) << 8)
+						| (static_cast<uint32_t>(r[2]) << 16) | (static_cast<uint32_t>(r[3]) << 24);
+					uint32_t hi = static_cast<uint32_t>(r[4]) | (static_cast<uint32_t>(r[5]) << 8)
+						| (static_cast<uint32_t>(r[6]) << 16) | (static_cast<uint32_t>(r[7]) << 24);
+					if((lo | hi) == 0) continue;
+					uint32_t t;
+					t = (hi ^ (hi >> 7)) & 0x00AA00AA;  hi = hi ^ t ^ (t << 7);
+					t = (lo ^ (lo >> 7)) & 0x00AA00AA;  lo = lo ^ t ^ (t << 7);
+					t = (hi ^ (hi >> 14)) & 0x0000CCCC; hi = hi ^ t ^ (t << 14);
+					t = (lo ^ (lo >> 14)) & 0x0000CCCC; lo = lo ^ t ^ (t << 14);
+					t = (hi & 0xF0F0F0F0) | ((lo >> 4) & 0x0F0F0F0F);
+					lo = ((hi << 4) & 0xF0F0F0F0) | (lo & 0x0F0F0F0F);
+					hi = t;
+					uint8_t col[8] = {
+						static_cast<uint8_t>(lo), static_cast<uint8_t>(lo >> 8),
+						static_cast<uint8_t>(lo >> 16), static_cast<uint8_t>(lo >> 24),
+						static_cast<uint8_t>(hi), static_cast<uint8_t>(hi >> 8),
+						static_cast<uint8_t>(hi >> 16), static_cast<uint8_t>(hi >> 24)
+					};
+					for(uint8_t k = 0; k < n; ++k) {
+						uint8_t c = col[k];
+						if(c == 0) continue;
+						if(p0 != nullptr) p0[j0 + k] |= c << sft;
+						if(p1 != nullptr) p1[j0 + k] |= c >> (8 - sft);
+					}
+				}
+			}
+#endif
 		}
 
 
@@ -484,6 +750,9 @@ namespace graphics {
 		//-----------------------------------------------------------------//
 		int16_t draw_text(int16_t x, int16_t y, const char* text, bool prop = false)
 		{
+			if(y > -KFONT::height && y < static_cast<int16_t>(HEIGHT)) {
+				kfont_.prefetch(text);
+			}
 			char ch;
 			while((ch = *text++) != 0) {
 				x = draw_font(x, y, ch, prop);
@@ -532,14 +801,14 @@ namespace graphics {
 				for(uint8_t i = 0; i < w; ++i) {
 					if(i < l) {
 						if((i ^ j) & 1) {
-							point_set(x + i, y + j);
+							set_(x + i, y + j);
 						} else {
-							point_reset(x + i, y + j);
+							reset_(x + i, y + j);
 						}
 					} else if(i == l && i != 0) {
-						point_set(x + i, y + j);
+						set_(x + i, y + j);
 					} else {
-						point_reset(x + i, y + j);
+						reset_(x + i, y + j);
 					}
 				}
 			}
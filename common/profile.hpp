@@ -0,0 +1,367 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	プロファイラー（サイクル計測） @n
+			TAU の１チャネルを F_CLK（又はその分周）のフリーランにして、 @n
+			区間のサイクル数を ID 毎に、最小、最大、平均、ヒストグラムで集計する。 @n
+			PROFILE が定義されていない場合、PROF_XXX マクロは空になり、 @n
+			コードもＲＡＭも消費しない。 @n
+			※計測できる区間は 65535 カウントまで（32MHz、分周無しで約 2mS）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+/// 集計する ID の数
+#ifndef PROF_NUM
+#  define PROF_NUM 8
+#endif
+
+#ifdef PROFILE
+#include "common/renesas.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  プロファイラー・クラス @n
+				dump() の出力は「#PROF 」に続く１６進の１行で、 @n
+				prof_decode（ホスト・ツール）で表にする。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class _>
+	struct profile_t {
+
+		typedef uint16_t (*count_func)();
+
+		static constexpr uint8_t HIST_NUM = 8;	///< ヒストグラムの数（４倍毎）
+		static constexpr uint8_t VERSION = 2;
+
+		struct stat_t {
+			uint16_t	min;
+			uint16_t	max;
+			uint32_t	sum;
+			uint16_t	num;
+			uint16_t	hist[HIST_NUM];
+			uint8_t		shift;	///< カウントの単位（F_CLK / 2^shift）
+		};
+
+		static count_func	count_;
+		static uint16_t		ovh_;	///< count() の呼び出し時間
+		static uint8_t		shift_;	///< カウンターの分周（２のべき乗）
+		static uint16_t		start_[PROF_NUM];
+		static stat_t		stat_[PROF_NUM];
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	カウンターの登録
+			@param[in]	func	カウンターを読む関数
+			@param[in]	shift	カウンターの分周（２のべき乗）
+		 */
+		//-----------------------------------------------------------------//
+		static void install(count_func func, uint8_t shift)
+		{
+			count_ = func;
+			shift_ = shift;
+			uint16_t a = count_();
+			uint16_t b = count_();
+			ovh_ = b - a;
+			clear();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	カウンターを読む
+			@return カウント
+		 */
+		//-----------------------------------------------------------------//
+		static uint16_t count() { return count_ != nullptr ? count_() : 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	集計のクリア
+		 */
+		//-----------------------------------------------------------------//
+		static void clear()
+		{
+			for(uint8_t i = 0; i < PROF_NUM; ++i) {
+				auto& s = stat_[i];
+				s.min = 0;
+				s.max = 0;
+				s.sum = 0;
+				s.num = 0;
+				for(uint8_t j = 0; j < HIST_NUM; ++j) s.hist[j] = 0;
+				s.shift = 0;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	計測値の登録
+			@param[in]	id	ID
+			@param[in]	cnt	カウント
+			@param[in]	ovh	カウンターの呼び出し時間を引く場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		static void record(uint8_t id, uint16_t cnt, bool ovh = true)
+		{
+			if(id >= PROF_NUM) return;
+			if(ovh) cnt = cnt > ovh_ ? (cnt - ovh_) : 0;
+			add_(id, cnt, shift_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	割り込み遅延の登録（PROF_LATENCY で使う） @n
+					カウントは、割り込みを出したタイマーの単位で、 @n
+					サイクル・カウンターとは別に、ID 毎に単位を記録する。
+			@param[in]	id		ID
+			@param[in]	cnt		カウント
+			@param[in]	shift	カウントの単位（F_CLK / 2^shift）
+		 */
+		//-----------------------------------------------------------------//
+		static void latency(uint8_t id, uint16_t cnt, uint8_t shift)
+		{
+			if(id >= PROF_NUM) return;
+			add_(id, cnt, shift);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	区間の開始（割り込みの入口など）
+			@param[in]	id	ID
+		 */
+		//-----------------------------------------------------------------//
+		static void enter(uint8_t id)
+		{
+			if(id < PROF_NUM) start_[id] = count();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	区間の終了（割り込みの出口など）
+			@param[in]	id	ID
+		 */
+		//-----------------------------------------------------------------//
+		static void leave(uint8_t id)
+		{
+			if(id < PROF_NUM) record(id, count() - start_[id]);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	集計の出力（メインループから呼ぶ） @n
+					OUT は putch(char) を持つクラス（uart_io など） @n
+					形式：version, shift, 数, { id, shift, min, max, num, sum, hist[8] }..., @n
+					チェックサム（バイトの合計の２の補数）、値はリトル・エンディアン @n
+					割り込みの許可状態は、呼び出し前の状態に戻す。
+			@param[in]	out	出力先
+		 */
+		//-----------------------------------------------------------------//
+		template <class OUT>
+		static void dump(OUT& out)
+		{
+			uint8_t n = 0;
+			for(uint8_t i = 0; i < PROF_NUM; ++i) {
+				if(stat_[i].num != 0) ++n;
+			}
+			const char* h = "#PROF ";
+			while(*h != 0) out.putch(*h++);
+			uint8_t sum = 0;
+			put8_(out, sum, VERSION);
+			put8_(out, sum, shift_);
+			put8_(out, sum, n);
+			for(uint8_t i = 0; i < PROF_NUM; ++i) {
+				stat_t s;
+				// PSW.IE を保存して、コピーの間だけ割り込みを禁止する
+				uint8_t ie = device::rw8_t<0xFFFFA>::read() & 0x80;
+				asm volatile ("di");
+				s = stat_[i];
+				if(ie != 0) asm volatile ("ei");
+				if(s.num == 0) continue;
+				put8_(out, sum, i);
+				put8_(out, sum, s.shift);
+				put16_(out, sum, s.min);
+				put16_(out, sum, s.max);
+				put16_(out, sum, s.num);
+				put16_(out, sum, s.sum);
+				put16_(out, sum, s.sum >> 16);
+				for(uint8_t j = 0; j < HIST_NUM; ++j) put16_(out, sum, s.hist[j]);
+			}
+			put8_(out, sum, -sum);
+			out.putch('\n');
+		}
+
+	private:
+		static void add_(uint8_t id, uint16_t cnt, uint8_t shift)
+		{
+			auto& s = stat_[id];
+			s.shift = shift;
+			// 回数が一杯になったら、平均を保って半分にする
+			if(s.num == 0xffff) {
+				s.num >>= 1;
+				s.sum >>= 1;
+			}
+			if(s.num == 0 || cnt < s.min) s.min = cnt;
+			if(cnt > s.max) s.max = cnt;
+			s.sum += cnt;
+			++s.num;
+			uint8_t b = 0;
+			uint16_t t = cnt >> 2;
+			while(t != 0 && b < (HIST_NUM - 1)) {
+				t >>= 2;
+				++b;
+			}
+			if(s.hist[b] != 0xffff) ++s.hist[b];
+		}
+
+		template <class OUT>
+		static void put8_(OUT& out, uint8_t& sum, uint8_t v)
+		{
+			static const char* hex = "0123456789ABCDEF";
+			out.putch(hex[v >> 4]);
+			out.putch(hex[v & 15]);
+			sum += v;
+		}
+
+		template <class OUT>
+		static void put16_(OUT& out, uint8_t& sum, uint16_t v)
+		{
+			put8_(out, sum, v);
+			put8_(out, sum, v >> 8);
+		}
+	};
+
+	template <class _> typename profile_t<_>::count_func profile_t<_>::count_ = nullptr;
+	template <class _> uint16_t profile_t<_>::ovh_ = 0;
+	template <class _> uint8_t profile_t<_>::shift_ = 0;
+	template <class _> uint16_t profile_t<_>::start_[PROF_NUM];
+	template <class _> typename profile_t<_>::stat_t profile_t<_>::stat_[PROF_NUM];
+
+	typedef profile_t<void> profile;
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  スコープの計測（PROF_SCOPE で使う） @n
+				割り込みが入った場合、その時間も含まれる。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class prof_scope {
+		uint8_t		id_;
+		uint16_t	org_;
+
+	public:
+		prof_scope(uint8_t id) : id_(id), org_(profile::count()) { }
+
+		~prof_scope() { profile::record(id_, profile::count() - org_); }
+	};
+}
+
+namespace device {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  TAU サイクル・カウンター @n
+				※プリスケーラー（０～３：PRS0、４～７：PRS1）は、同じグループの @n
+				チャネルと共有するので、他で使っていないグループのチャネルを使う事。
+		@param[in]	TAU		タイマ・アレイ・ユニット・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class TAU>
+	struct tau_cycle {
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	カウンターを読む
+			@return カウント
+		 */
+		//-----------------------------------------------------------------//
+		static uint16_t count() { return 0xffff - TAU::TCR(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始（プロファイラーに登録する）
+			@param[in]	shift	分周（F_CLK / 2^shift）
+		 */
+		//-----------------------------------------------------------------//
+		static void start(uint8_t shift = 0)
+		{
+			intr::enable<TAU::get_peripheral()>(false);
+
+			manage::enable(TAU::get_peripheral());
+
+			uint8_t cks = 0;
+			if(TAU::get_chanel_no() < 4) {
+				TAU::TPS.PRS0 = shift;
+			} else {
+				TAU::TPS.PRS1 = shift;
+				cks = 2;
+			}
+			TAU::TMR = TAU::TMR.CKS.b(cks) | TAU::TMR.MD.b(0);
+			TAU::TDR = 0xffff;
+			TAU::TS = 1;
+
+			utils::profile::install(count, shift);
+		}
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	TAU チャネルのカウント・クロックの分周を取得 @n
+				CK00（PRS0）、CK01（PRS1）は F_CLK / 2^PRS、 @n
+				CK02（PRS2）は F_CLK / 2^(2 + 2 * PRS2)、 @n
+				CK03（PRS3）は F_CLK / 2^(8 + 2 * PRS3)
+		@param[in]	TAU		タイマ・アレイ・ユニット・クラス
+		@return 分周（F_CLK / 2^shift）
+	 */
+	//-----------------------------------------------------------------//
+	template <class TAU>
+	inline uint8_t tau_shift()
+	{
+		switch(TAU::TMR.CKS()) {
+		case 0:  return TAU::TPS.PRS0();
+		case 1:  return 2 + 2 * TAU::TPS.PRS2();
+		case 2:  return TAU::TPS.PRS1();
+		default: return 8 + 2 * TAU::TPS.PRS3();
+		}
+	}
+}
+
+/// スコープの計測（関数やブロックの先頭に置く）
+#define PROF_SCOPE(id) utils::prof_scope PROF_CAT_(prof_scope_, __LINE__)(id)
+/// 区間の開始（割り込みの入口）
+#define PROF_ENTER(id) utils::profile::enter(id)
+/// 区間の終了（割り込みの出口）
+#define PROF_LEAVE(id) utils::profile::leave(id)
+/// インターバル・タイマー割り込みの遅延（要求から入口まで、TAU のカウント・クロック単位）
+#define PROF_LATENCY(id, TAU) \
+	utils::profile::latency(id, static_cast<uint16_t>(TAU::TDR() - TAU::TCR()), \
+		device::tau_shift<TAU>())
+/// 集計の出力
+#define PROF_DUMP(out) utils::profile::dump(out)
+
+#define PROF_CAT_(a, b) PROF_CAT2_(a, b)
+#define PROF_CAT2_(a, b) a##b
+
+#else
+
+#define PROF_SCOPE(id)
+#define PROF_ENTER(id)
+#define PROF_LEAVE(id)
+#define PROF_LATENCY(id, TAU)
+#define PROF_DUMP(out)
+
+#endif
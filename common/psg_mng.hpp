@@ -37,7 +37,7 @@ namespace utils {
 			SQ50,	///< 矩形波 Duty50%
 			SQ75,	///< 矩形波 Duty75%
 			TRI,	///< 三角波
-			NOISE,	///< ノイズ（現在未サポート）
+			NOISE,	///< ノイズ（15ビット LFSR）
 		};
 
 
@@ -214,6 +214,7 @@ namespace utils {
 			ATTACK,		///< (2) 音のアタック, gain(0 ~ 255)
 			RELEASE,	///< (3) 音のリリース, release_frame(n), gain(0 ~ 255)
 			CHOUT,		///< (2) 文字出力, char（楽譜のデバッグ用に文字を出力）
+			NOISE,		///< (1) 波形 NOISE
 		};
 
 
@@ -267,9 +268,33 @@ namespace utils {
 			static_cast<uint16_t>((3520 * 65536.0 * 1.887748625) / SAMPLE),  ///< G#
 		};
 
+		// 高速レンダリング用波形テーブル（位相の上位５ビットで引く）
+		// 矩形波は ±1、三角波は ±7 の振幅で、エンベロープを掛けて使う。
+		static constexpr uint8_t	WAVE_BITS = 5;
+		static constexpr uint8_t	WAVE_SIZE = 1 << WAVE_BITS;
+		static constexpr int8_t wave_tbl_[4][WAVE_SIZE] = {
+			{  // SQ25
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1
+			},
+			{  // SQ50
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1
+			},
+			{  // SQ75
+				-1, -1, -1, -1, -1, -1, -1, -1,  1,  1,  1,  1,  1,  1,  1,  1,
+				 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1
+			},
+			{  // TRI
+				 0, -1, -2, -3, -4, -5, -6, -7, -7, -6, -5, -4, -3, -2, -1,  0,
+				 0,  1,  2,  3,  4,  5,  6,  7,  7,  6,  5,  4,  3,  2,  1,  0
+			},
+		};
+
 		static constexpr uint8_t	SUB_SCORE_NUM = 8;  // サブスコア最大数
 		static constexpr uint8_t	STACK_DEPTH = 4;  // 4 レベル
 		static constexpr uint16_t	ENV_CYCLE = SAMPLE / TICK;
+		static constexpr uint8_t	FAST_BLOCK = 64;  // render_fast の合計バッファ
 
 		struct share_t {
 			const SCORE*	sub_score_[SUB_SCORE_NUM];
@@ -286,7 +311,7 @@ namespace utils {
 		};
 
 		struct channel {
-			share_t&	share_;
+			share_t*	share_;
 			uint8_t		volume_;
 			uint8_t		fade_;
 			uint8_t		fade_spd_;
@@ -310,14 +335,15 @@ namespace utils {
 			stack_t		stack_[STACK_DEPTH];
 			uint8_t		stack_pos_;
 			uint16_t	total_count_;
-			channel(share_t& share) noexcept : share_(share), volume_(0), fade_(0), fade_spd_(0), fade_cnt_(0),
+			uint16_t	noise_;  // 15 ビット LFSR
+			channel() noexcept : share_(nullptr), volume_(0), fade_(0), fade_spd_(0), fade_cnt_(0),
 				wtype_(WTYPE::SQ50), acc_(0), spd_(0),
 				score_org_(nullptr), score_pos_(0),
 				tempo_(0), count_(0),
 				tr_(0), loop_org_(0), loop_cnt_(0),
 				env_(0), env_cycle_(0), attack_(0), rel_frame_(0), release_(0), rel_count_(0),
 				stack_{ }, stack_pos_(0),
-				total_count_(0)
+				total_count_(0), noise_(1)
 			{ }
 
 			void init() noexcept
@@ -335,9 +361,37 @@ namespace utils {
 				rel_frame_ = 6; // リリース TICK 標準
 			}
 
+			void step_noise_() noexcept
+			{
+				// ファミコンと同じ 15 ビット LFSR（タップ：bit0, bit1）
+				uint16_t fb = (noise_ ^ (noise_ >> 1)) & 1;
+				noise_ = (noise_ >> 1) | (fb << 14);
+			}
+
+			void step_env_() noexcept
+			{
+				if(rel_count_ > 0) {
+					rel_count_--;
+					// +エンベロープ
+					env_ += static_cast<uint16_t>((volume_ - env_) * attack_) >> 8;
+				} else {
+					// -エンベロープ
+					uint8_t n = static_cast<uint16_t>(env_ * release_) >> 8;
+					if(n > 0) env_ -= n;
+					else {
+						if(env_ > 0) --env_;
+					}
+				}
+			}
+
 			void update() noexcept
 			{
+				auto org = acc_;
 				acc_ += spd_;
+				// ノイズは、波形テーブル１周期に３２回 LFSR を進める
+				if(wtype_ == WTYPE::NOISE && ((org ^ acc_) & 0xf800) != 0) {
+					step_noise_();
+				}
 			}
 
 			int8_t get() noexcept
@@ -373,7 +427,8 @@ namespace utils {
 					}
 					break;
 				case WTYPE::NOISE:
-					w = 0;
+					if(noise_ & 1) on = true;
+					w = env_ - (env_ >> 3);
 					break;
 				}
 				if(!on) { w = -w; }
@@ -381,20 +436,59 @@ namespace utils {
 				++env_cycle_;
 				if(env_cycle_ >= ENV_CYCLE) {
 					env_cycle_ = 0;
-					if(rel_count_ > 0) {
-						rel_count_--;
-						// +エンベロープ
-						env_ += static_cast<uint16_t>((volume_ - env_) * attack_) >> 8;
+					step_env_();
+				}
+				return w;
+			}
+
+			// エンベロープが一定の区間毎に、振幅を掛けた波形テーブルを作り、 @n
+			// テーブルを引いて out に加算する（値は get() と同じ）。
+			void render(uint16_t count, int16_t* out) noexcept RAMTEXT_FUNC
+			{
+				if(spd_ == 0) return;
+
+				int8_t wt[WAVE_SIZE];
+				while(count > 0) {
+					uint16_t run = ENV_CYCLE - env_cycle_;
+					if(run > count) run = count;
+
+					if(wtype_ == WTYPE::NOISE) {
+						int8_t amp = env_ - (env_ >> 3);
+						wt[0] = -amp;
+						wt[1] =  amp;
+						for(uint16_t i = 0; i < run; ++i) {
+							auto org = acc_;
+							acc_ += spd_;
+							if(((org ^ acc_) & 0xf800) != 0) step_noise_();
+							out[i] += wt[noise_ & 1];
+						}
 					} else {
-						// -エンベロープ
-						uint8_t n = static_cast<uint16_t>(env_ * release_) >> 8;
-						if(n > 0) env_ -= n;
-						else {
-							if(env_ > 0) --env_;
+						const int8_t* src = wave_tbl_[static_cast<uint8_t>(wtype_)];
+						if(wtype_ == WTYPE::TRI) {
+							uint8_t e = env_ >> 3;
+							for(uint8_t i = 0; i < WAVE_SIZE; ++i) {
+								int8_t m = (src[i] < 0 ? -src[i] : src[i]) * e;
+								wt[i] = src[i] < 0 ? -m : m;
+							}
+						} else {
+							int8_t amp = env_ - (env_ >> 3);
+							for(uint8_t i = 0; i < WAVE_SIZE; ++i) {
+								wt[i] = src[i] < 0 ? -amp : amp;
+							}
 						}
+						for(uint16_t i = 0; i < run; ++i) {
+							acc_ += spd_;
+							out[i] += wt[acc_ >> (16 - WAVE_BITS)];
+						}
+					}
+					out += run;
+					count -= run;
+					env_cycle_ += run;
+					if(env_cycle_ >= ENV_CYCLE) {
+						env_cycle_ = 0;
+						step_env_();
 					}
 				}
-				return w;
 			}
 
 			void set_freq(uint16_t frq) noexcept { spd_ = (static_cast<uint32_t>(frq) << 16) / SAMPLE; }
@@ -415,7 +509,7 @@ namespace utils {
 					}
 				}
 
-				if(share_.pause_) return true;
+				if(share_->pause_) return true;
 
 				if(count_ >= tempo_) {
 					count_ -= tempo_;
@@ -512,7 +606,7 @@ namespace utils {
 							stack_[stack_pos_].org_ = score_org_;
 							stack_[stack_pos_].pos_ = score_pos_;
 							++stack_pos_;
-							score_org_ = share_.sub_score_[v.len - static_cast<uint8_t>(CTRL::CALL0)];
+							score_org_ = share_->sub_score_[v.len - static_cast<uint8_t>(CTRL::CALL0)];
 							score_pos_ = 0;
 						}
 						break;
@@ -541,6 +635,9 @@ namespace utils {
 						sci_putch(static_cast<char>(score_org_[score_pos_].len));
 						++score_pos_;
 						break;
+					case CTRL::NOISE:
+						wtype_ = WTYPE::NOISE;
+						break;
 					default:
 						break;
 					}
@@ -559,8 +656,12 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		psg_mng() noexcept :
 			share_(),
-			channel_{ share_, share_, share_ }
-		{ }
+			channel_{ }
+		{
+			for(uint16_t i = 0; i < CNUM; ++i) {
+				channel_[i].share_ = &share_;
+			}
+		}
 
 
 		//-----------------------------------------------------------------//
@@ -630,7 +731,7 @@ namespace utils {
 			@param[out]	out		波形出力
 		*/
 		//-----------------------------------------------------------------//
-		void render(uint16_t count, int8_t* out) noexcept
+		void render(uint16_t count, int8_t* out) noexcept RAMTEXT_FUNC
 		{
 			for(uint16_t i = 0; i < count; ++i) {
 				int16_t sum = 0;
@@ -649,6 +750,58 @@ namespace utils {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  高速レンダリング @n
+					チャネル毎にブロック単位で波形テーブルから合成する。 @n
+					正規化（アクティブなチャネル数＋１で割る）は、逆数の表を @n
+					掛けて右シフトするので、割り算を使わずに「render」と同じ @n
+					値（０方向への切り捨て）になる。
+			@param[in]	count	波形数
+			@param[out]	out		波形出力
+		*/
+		//-----------------------------------------------------------------//
+		void render_fast(uint16_t count, int8_t* out) noexcept
+		{
+			// ceil(65536 / n)、|合計| < 65536 / (n - 1) の範囲で割り算と一致する
+			static constexpr uint16_t recip[] = {
+				0, 0, 32768, 21846, 16384, 13108, 10923, 9363,
+				8192, 7282, 6554, 5958, 5462, 5042, 4682, 4370
+			};
+			static_assert(CNUM < (sizeof(recip) / sizeof(recip[0]) - 1), "CNUM too large for render_fast");
+
+			uint8_t n = 1;
+			for(uint8_t j = 0; j < CNUM; ++j) {
+				if(channel_[j].score_org_ != nullptr) ++n;
+			}
+			if(n == 1) {
+				for(uint16_t i = 0; i < count; ++i) out[i] = 0;
+				return;
+			}
+			uint16_t m = recip[n];
+
+			// スタックを抑える為、合計は FAST_BLOCK 毎に作る
+			int16_t sum[FAST_BLOCK];
+			while(count > 0) {
+				uint16_t run = count > FAST_BLOCK ? FAST_BLOCK : count;
+				for(uint16_t i = 0; i < run; ++i) sum[i] = 0;
+				for(uint8_t j = 0; j < CNUM; ++j) {
+					if(channel_[j].score_org_ != nullptr) {
+						channel_[j].render(run, sum);
+					}
+				}
+				for(uint16_t i = 0; i < run; ++i) {
+					int16_t v = sum[i];
+					uint16_t a = v < 0 ? -v : v;
+					int8_t d = (static_cast<uint32_t>(a) * m) >> 16;
+					out[i] = v < 0 ? -d : d;
+				}
+				out += run;
+				count -= run;
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief  スコアの設定
@@ -725,4 +878,7 @@ namespace utils {
 
 	template<uint16_t SAMPLE, uint16_t TICK, uint16_t CNUM>
 		constexpr uint16_t psg_mng<SAMPLE, TICK, CNUM>::key_tbl_[12];
+
+	template<uint16_t SAMPLE, uint16_t TICK, uint16_t CNUM>
+		constexpr int8_t psg_mng<SAMPLE, TICK, CNUM>::wave_tbl_[4][psg_mng<SAMPLE, TICK, CNUM>::WAVE_SIZE];
 }
\ No newline at end of file
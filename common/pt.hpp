@@ -0,0 +1,166 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	スタックレス・コルーチン（protothread） @n
+			switch 文で再開位置を保持する、Duff's device 方式のコルーチン。 @n
+			スタックを消費しないので、ペリフェラルの完了待ちの間に、 @n
+			他のコルーチンを進める事が出来る。 @n
+			※コルーチンの中で、ローカル変数は待ちを跨いで保持されない。 @n
+			※コルーチンの中で switch 文は使えない。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <utility>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コルーチンの状態
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	enum class pt_state : uint8_t {
+		WAITING,	///< 条件待ち
+		YIELDED,	///< 譲渡
+		EXITED,		///< 途中で終了（エラーなど）
+		ENDED,		///< 最後まで実行
+	};
+
+
+	//-----------------------------------------------------------------//
+	/*!
+		@brief	コルーチンが動作中か
+		@param[in]	st	コルーチンの戻り値
+		@return 動作中なら「true」
+	*/
+	//-----------------------------------------------------------------//
+	inline constexpr bool pt_alive(pt_state st)
+	{
+		return st == pt_state::WAITING || st == pt_state::YIELDED;
+	}
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  コルーチンの再開位置
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct pt {
+		uint16_t	lc_;
+
+		pt() : lc_(0) { }
+
+		void reset() { lc_ = 0; }
+
+		bool is_start() const { return lc_ == 0; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  端子レベル待ち
+		@param[in]	PORT	ポート・クラス
+		@param[in]	LEVEL	待つレベル
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class PORT, bool LEVEL>
+	struct pt_pin {
+		bool operator() () const { return PORT::P() == LEVEL; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  タイムアウト待ち @n
+				CNT は get_counter() を持つクラス（itimer など）
+		@param[in]	CNT	カウンター・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class CNT>
+	class pt_timeout {
+	public:
+		typedef decltype(std::declval<const CNT&>().get_counter()) value_type;
+
+	private:
+		const CNT&	cnt_;
+		value_type	org_;
+		value_type	len_;
+
+	public:
+		pt_timeout(const CNT& cnt) : cnt_(cnt), org_(0), len_(0) { }
+
+		void start(value_type len) {
+			org_ = cnt_.get_counter();
+			len_ = len;
+		}
+
+		bool operator() () const {
+			return static_cast<value_type>(cnt_.get_counter() - org_) >= len_;
+		}
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  イベント待ち @n
+				割り込み（DMA 転送完了など）で set() して、コルーチンで待つ。 @n
+				待ちが完了すると、フラグはクリアされる。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class pt_event {
+		volatile bool	flag_;
+
+	public:
+		pt_event() : flag_(false) { }
+
+		void set() { flag_ = true; }
+
+		void clear() { flag_ = false; }
+
+		bool operator() () {
+			if(!flag_) return false;
+			flag_ = false;
+			return true;
+		}
+	};
+}
+
+/// コルーチンの開始（関数の先頭に置く）
+#define PT_BEGIN(pt) \
+	{ char pt_yield_ __attribute__ ((unused)) = 1; switch((pt).lc_) { case 0:
+
+/// コルーチンの終了（関数の最後に置く）
+#define PT_END(pt) \
+	} (pt).lc_ = 0; return utils::pt_state::ENDED; }
+
+/// 条件が成立するまで待つ
+#define PT_WAIT_UNTIL(pt, cond) \
+	do { (pt).lc_ = __LINE__; case __LINE__: \
+		if(!(cond)) return utils::pt_state::WAITING; } while(0)
+
+/// 条件が成立している間待つ
+#define PT_WAIT_WHILE(pt, cond) PT_WAIT_UNTIL(pt, !(cond))
+
+/// 待ちオブジェクト（pt_pin、pt_timeout、pt_event など）を待つ
+#define PT_AWAIT(pt, obj) PT_WAIT_UNTIL(pt, (obj)())
+
+/// 一度だけ他のコルーチンに譲る
+#define PT_YIELD(pt) \
+	do { pt_yield_ = 0; (pt).lc_ = __LINE__; case __LINE__: \
+		if(pt_yield_ == 0) return utils::pt_state::YIELDED; } while(0)
+
+/// 子コルーチンを開始して、終了まで待つ
+#define PT_SPAWN(pt, child, thread) \
+	do { (child).reset(); PT_WAIT_WHILE(pt, utils::pt_alive(thread)); } while(0)
+
+/// コルーチンを途中で終了
+#define PT_EXIT(pt) \
+	do { (pt).lc_ = 0; return utils::pt_state::EXITED; } while(0)
+
+/// コルーチンを最初からやり直す
+#define PT_RESTART(pt) \
+	do { (pt).lc_ = 0; return utils::pt_state::WAITING; } while(0)
@@ -0,0 +1,130 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RAM、スタック使用量モニター @n
+			start.s は、起動時に RAM 全体を PAINT で塗りつぶしてから、.data、 @n
+			.bss を初期化するので、.bss の後ろから、スタックの底までは、 @n
+			PAINT のまま残る。スタックを使うと PAINT が消えるので、 @n
+			下から PAINT の残っている範囲を調べれば、スタックの最大使用量が分かる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include "common/format.hpp"
+
+extern "C" {
+	// リンカー・スクリプトのシンボル（アセンブラ名は、先頭に「_」が付く）
+	extern uint8_t _datastart[];
+	extern uint8_t _dataend[];
+	extern uint8_t _bssstart[];
+	extern uint8_t _bssend[];
+	extern uint8_t _stack[];
+}
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  RAM モニター・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class ram_monitor {
+
+		static uint16_t adr_(const volatile void* p) { return reinterpret_cast<uintptr_t>(p); }
+
+	public:
+		static constexpr uint16_t PAINT = 0xA55A;	///< start.s の塗りつぶしパターン
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	.data の大きさを取得
+			@return 大きさ
+		 */
+		//-----------------------------------------------------------------//
+		static uint16_t get_data_size() { return adr_(_dataend) - adr_(_datastart); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	.bss の大きさを取得
+			@return 大きさ
+		 */
+		//-----------------------------------------------------------------//
+		static uint16_t get_bss_size() { return adr_(_bssend) - adr_(_bssstart); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スタックに使える領域（.bss の後ろから、スタックの先頭まで）
+			@return 大きさ
+		 */
+		//-----------------------------------------------------------------//
+		static uint16_t get_stack_space() { return adr_(_stack) - adr_(_bssend); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	現在のスタックの使用量を取得
+			@return 使用量
+		 */
+		//-----------------------------------------------------------------//
+		static uint16_t get_stack_now()
+		{
+			volatile uint8_t tmp = 0;
+			return adr_(_stack) - adr_(&tmp);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スタックの最大使用量（ハイ・ウォーター・マーク）を取得 @n
+					malloc を使う場合、ヒープの終わり（sbrk(0)）を floor に渡す。
+			@param[in]	floor	検索の開始アドレス（nullptr なら .bss の後ろ）
+			@return 最大使用量
+		 */
+		//-----------------------------------------------------------------//
+		static uint16_t get_stack_peak(const void* floor = nullptr)
+		{
+			uint16_t org = (adr_(floor != nullptr ? floor : _bssend) + 1) & 0xfffe;
+			uint16_t end = adr_(_stack);
+			while(org < end && *reinterpret_cast<const volatile uint16_t*>(
+				static_cast<uintptr_t>(org)) == PAINT) {
+				org += 2;
+			}
+			return end - org;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スタックの残り（一度も使われていない領域）を取得
+			@param[in]	floor	検索の開始アドレス（nullptr なら .bss の後ろ）
+			@return 残り
+		 */
+		//-----------------------------------------------------------------//
+		static uint16_t get_stack_free(const void* floor = nullptr)
+		{
+			return get_stack_space() - get_stack_peak(floor);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	使用状況の表示（utils::format）
+			@param[in]	floor	検索の開始アドレス（nullptr なら .bss の後ろ）
+		 */
+		//-----------------------------------------------------------------//
+		static void list(const void* floor = nullptr)
+		{
+			format(".data:  %04X %5d\n") % adr_(_datastart) % get_data_size();
+			format(".bss:   %04X %5d\n") % adr_(_bssstart) % get_bss_size();
+			format("stack:  %04X %5d (now: %d, peak: %d, free: %d)\n")
+				% adr_(_bssend) % get_stack_space() % get_stack_now()
+				% get_stack_peak(floor) % get_stack_free(floor);
+		}
+	};
+}
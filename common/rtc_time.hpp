@@ -0,0 +1,213 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RTC 時間サービス @n
+			開始時に RTC を一度読み、以後は itimer の tick（又は、RTC の @n
+			１Hz 出力のエッジ）で time_t を進める。RTC との同期は一定周期で行う。 @n
+			時間の取得はメモリーの読み出しだけで、I2C の通信は発生しない。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include "common/time.h"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  RTC 時間サービス・テンプレートクラス @n
+				tick()、edge() は割り込みから、service() はメインループから呼ぶ。 @n
+				edge() が呼ばれている間は、秒の更新はエッジで行い、tick() は @n
+				エッジが途切れた場合の代わりとして働く。
+		@param[in]	RTC	RTC クラス（get_time(time_t&)、set_time(time_t) を持つ）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class RTC>
+	class rtc_time {
+
+		RTC&	rtc_;
+
+		volatile time_t		time_;
+		volatile uint16_t	tick_;
+		volatile uint8_t	seq_;	///< 秒の更新毎に進む
+		volatile bool		edge_;
+
+		// service() で読んだ RTC の時間（次の秒の更新で反映する）
+		volatile time_t		sync_time_;
+		volatile uint8_t	sync_seq_;
+		volatile bool		sync_ok_;
+
+		uint16_t	freq_;
+		uint16_t	resync_;
+		uint16_t	count_;
+		uint8_t		last_seq_;
+		bool		start_;
+
+		void advance_() {
+			if(sync_ok_) {
+				if(sync_seq_ == seq_) time_ = sync_time_;
+				sync_ok_ = false;
+			}
+			time_ = time_ + 1;
+			seq_ = seq_ + 1;
+		}
+
+		bool sync_() {
+			uint8_t seq = seq_;
+			time_t t;
+			if(!rtc_.get_time(t)) return false;
+			if(seq != seq_) return false;  // 読み出し中に秒が更新された
+			sync_time_ = t;
+			sync_seq_ = seq;
+			sync_ok_ = true;
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	rtc	RTC クラスを参照で渡す
+		 */
+		//-----------------------------------------------------------------//
+		rtc_time(RTC& rtc) : rtc_(rtc), time_(0), tick_(0), seq_(0), edge_(false),
+			sync_time_(0), sync_seq_(0), sync_ok_(false),
+			freq_(0), resync_(0), count_(0), last_seq_(0), start_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始（RTC を読んで、時間を初期化する）
+			@param[in]	freq	tick() を呼ぶ周波数 [Hz]
+			@param[in]	resync	RTC と同期する周期 [秒]（０なら同期しない）
+			@return RTC の読み出しに失敗したら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool start(uint16_t freq, uint16_t resync = 600) {
+			start_ = false;
+			freq_ = freq;
+			resync_ = resync;
+			count_ = 0;
+			time_t t;
+			if(!rtc_.get_time(t)) return false;
+			tick_ = 0;
+			edge_ = false;
+			sync_ok_ = false;
+			time_ = t;
+			last_seq_ = seq_;
+			start_ = true;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	tick（itimer の割り込みから呼ぶ）
+		 */
+		//-----------------------------------------------------------------//
+		void tick() {
+			if(!start_) return;
+			uint16_t n = tick_ + 1;
+			if(edge_) {
+				// エッジが 1.5 秒来なければ、tick で秒を進める
+				if(n >= (freq_ + (freq_ >> 1))) {
+					edge_ = false;
+					n -= freq_;
+					advance_();
+				}
+			} else if(n >= freq_) {
+				n = 0;
+				advance_();
+			}
+			tick_ = n;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１Hz エッジ（RTC の SQW/INT 端子の割り込みから呼ぶ） @n
+					DS3231 では、立ち下がりエッジで秒のレジスターが更新される。
+		 */
+		//-----------------------------------------------------------------//
+		void edge() {
+			if(!start_) return;
+			edge_ = true;
+			tick_ = 0;
+			advance_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（メインループから呼ぶ） @n
+					同期の周期になったら、秒の更新直後に RTC を読む。 @n
+					tick だけで動作している場合、秒の位相は合わないので、誤差は１秒以内
+		 */
+		//-----------------------------------------------------------------//
+		void service() {
+			if(!start_ || resync_ == 0) return;
+			uint8_t seq = seq_;
+			if(seq == last_seq_) return;
+			count_ += static_cast<uint8_t>(seq - last_seq_);
+			last_seq_ = seq;
+			if(count_ >= resync_) {
+				if(sync_()) count_ = 0;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	時間の取得（割り込みと競合しない）
+			@return 時間
+		 */
+		//-----------------------------------------------------------------//
+		time_t get() const {
+			time_t t;
+			uint8_t seq;
+			do {
+				seq = seq_;
+				t = time_;
+			} while(seq != seq_) ;
+			return t;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	時間の設定（RTC にも書き込む）
+			@param[in]	t	時間
+			@return RTC の書き込みに失敗したら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool set(time_t t) {
+			if(!rtc_.set_time(t)) return false;
+			start_ = false;
+			tick_ = 0;
+			sync_ok_ = false;
+			time_ = t;
+			start_ = freq_ != 0;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	RTC と同期を要求（次の service() で同期する）
+		 */
+		//-----------------------------------------------------------------//
+		void request_sync() { count_ = resync_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１Hz エッジで動作しているか
+			@return エッジで動作している場合「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_edge() const { return edge_; }
+	};
+}
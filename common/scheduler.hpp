@@ -0,0 +1,258 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	協調型タスク・スケジューラー @n
+			割り込みからイベントを投げ、メインループで優先順位の高い @n
+			イベントから１つずつ、最後まで実行する（run to completion）。 @n
+			イベントが無い場合は、HALT で割り込みを待つ。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  HALT による待機 @n
+				EI の次の命令までは割り込みが保留されるので、DI の状態で @n
+				イベントが無い事を確認してから「EI、HALT」とすれば、 @n
+				その間に投げられたイベントを取りこぼさない。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct halt_sys {
+		static void lock() { asm volatile ("di"); }
+		static void unlock() { asm volatile ("ei"); }
+		static void sleep() { asm volatile ("ei\n\thalt"); }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  スケジューラー・テンプレートクラス
+		@param[in]	EVTNUM	イベントの種類
+		@param[in]	PRI		優先順位の数（０が最も高い）
+		@param[in]	QSIZE	優先順位毎のキューの大きさ（２のべき乗、128 以下）
+		@param[in]	SYS		割り込み禁止と待機のクラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t EVTNUM = 16, uint8_t PRI = 2, uint8_t QSIZE = 16, class SYS = halt_sys>
+	class scheduler {
+	public:
+		typedef void (*task_func)(uint8_t param);
+
+	private:
+		static_assert(EVTNUM > 0 && PRI > 0, "EVTNUM, PRI must not be zero");
+		static_assert(QSIZE >= 2 && QSIZE <= 128 && (QSIZE & (QSIZE - 1)) == 0,
+			"QSIZE must be a power of 2");
+
+		struct queue_t {
+			volatile uint8_t	put;
+			volatile uint8_t	get;
+			uint8_t		evt[QSIZE];
+			uint8_t		param[QSIZE];
+		};
+
+		template <class TASK>
+		struct adapter_ {
+			static TASK task_;
+			static void call(uint8_t param) { task_(param); }
+		};
+
+		queue_t		que_[PRI];
+		task_func	task_[EVTNUM];
+		uint8_t		pri_[EVTNUM];
+
+		volatile uint8_t	lost_;
+
+		bool empty_() const
+		{
+			for(uint8_t i = 0; i < PRI; ++i) {
+				if(que_[i].get != que_[i].put) return false;
+			}
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		scheduler() : lost_(0)
+		{
+			for(uint8_t i = 0; i < PRI; ++i) {
+				que_[i].put = 0;
+				que_[i].get = 0;
+			}
+			for(uint8_t i = 0; i < EVTNUM; ++i) {
+				task_[i] = nullptr;
+				pri_[i] = PRI - 1;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タスクの登録
+			@param[in]	evt		イベント番号
+			@param[in]	task	タスク関数
+			@param[in]	pri		優先順位
+			@return イベント番号、優先順位が範囲外なら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool install(uint8_t evt, task_func task, uint8_t pri = 0)
+		{
+			if(evt >= EVTNUM || pri >= PRI) return false;
+			task_[evt] = task;
+			pri_[evt] = pri;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファンクタ・クラスをタスクとして登録 @n
+					TASK は「void operator() (uint8_t param)」を持つクラス
+			@param[in]	evt		イベント番号
+			@param[in]	pri		優先順位
+			@return イベント番号、優先順位が範囲外なら「false」
+		 */
+		//-----------------------------------------------------------------//
+		template <class TASK>
+		bool install(uint8_t evt, uint8_t pri = 0)
+		{
+			return install(evt, adapter_<TASK>::call, pri);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イベントを投げる（割り込みから呼ぶ）
+			@param[in]	evt		イベント番号
+			@param[in]	param	パラメーター
+			@return キューが一杯なら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool post(uint8_t evt, uint8_t param = 0)
+		{
+			if(evt >= EVTNUM) return false;
+			auto& q = que_[pri_[evt]];
+			uint8_t p = q.put;
+			uint8_t n = (p + 1) & (QSIZE - 1);
+			if(n == q.get) {
+				lost_ = lost_ + 1;
+				return false;
+			}
+			q.evt[p] = evt;
+			q.param[p] = param;
+			// イベントを書いてから put を進める（コンパイラーの並べ替えを禁止）
+			asm volatile ("" ::: "memory");
+			q.put = n;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イベントを投げる（メインループ、タスクから呼ぶ）
+			@param[in]	evt		イベント番号
+			@param[in]	param	パラメーター
+			@return キューが一杯なら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool post_main(uint8_t evt, uint8_t param = 0)
+		{
+			SYS::lock();
+			bool ret = post(evt, param);
+			SYS::unlock();
+			return ret;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	優先順位の高いイベントを１つ実行
+			@return 実行するイベントが無ければ「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool service()
+		{
+			for(uint8_t i = 0; i < PRI; ++i) {
+				auto& q = que_[i];
+				uint8_t g = q.get;
+				if(g != q.put) {
+					uint8_t evt = q.evt[g];
+					uint8_t param = q.param[g];
+					// 読み出してから get を進める（割り込みで上書きされない様に）
+					asm volatile ("" ::: "memory");
+					q.get = (g + 1) & (QSIZE - 1);
+					auto task = task_[evt];
+					if(task != nullptr) task(param);
+					return true;
+				}
+			}
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イベントが無ければ、割り込みまで待機
+		 */
+		//-----------------------------------------------------------------//
+		void idle()
+		{
+			SYS::lock();
+			if(empty_()) {
+				SYS::sleep();
+			} else {
+				SYS::unlock();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スケジューラーを実行（戻らない）
+		 */
+		//-----------------------------------------------------------------//
+		void run()
+		{
+			while(1) {
+				if(!service()) idle();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キューが一杯で捨てたイベントの数を取得
+			@return 捨てたイベントの数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t get_lost() const { return lost_; }
+	};
+
+	template <uint8_t EVTNUM, uint8_t PRI, uint8_t QSIZE, class SYS>
+	template <class TASK>
+		TASK scheduler<EVTNUM, PRI, QSIZE, SYS>::adapter_<TASK>::task_;
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  イベントを投げる割り込みタスク @n
+				itimer、adc_io、uart_io などの TASK に渡して使う。
+		@param[in]	SCHED	スケジューラーの型
+		@param[in]	sched	スケジューラーの実体
+		@param[in]	EVT		イベント番号
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class SCHED, SCHED& sched, uint8_t EVT>
+	struct post_task {
+		void operator() () { sched.post(EVT); }
+	};
+}
@@ -23,9 +23,10 @@ namespace utils {
 		@param[in]	SELECT	SD カード選択 I/O ポートクラス
 		@param[in]	POWER	SD カード電源 I/O ポートクラス
 		@param[in]	DETECT	SD カード検出 I/O ポートクラス
+		@param[in]	DIR_INDEX	ディレクトリー・インデックス数（0 で無効、１つで 4 バイト）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class CSI, class SELECT, class POWER, class DETECT>
+	template <class CSI, class SELECT, class POWER, class DETECT, uint8_t DIR_INDEX = 0>
 	class sdc_io {
 	public:
 		typedef CSI csi_type;
@@ -34,6 +35,30 @@ namespace utils {
 	private:
 		static const int path_buff_size_ = 256;
 
+		static const uint8_t dir_index_step_ = 8;	///< インデックスを置くエントリー間隔
+
+		// 読み出しオフセットの保存先（DIR_INDEX が 0 の場合は領域を持たない）
+		template <uint8_t N, typename _ = void>
+		struct dir_chk_t {
+			DWORD	chk_[N];
+			void set(uint8_t i, DWORD ofs) { chk_[i] = ofs; }
+			DWORD get(uint8_t i) const { return chk_[i]; }
+		};
+		template <typename _>
+		struct dir_chk_t<0, _> {
+			void set(uint8_t i, DWORD ofs) { }
+			DWORD get(uint8_t i) const { return 0; }
+		};
+
+		// ディレクトリー・インデックス（dir_index_step_ 毎の読み出しオフセット）
+		struct dir_index_t : public dir_chk_t<DIR_INDEX> {
+			uint32_t	hash_;
+			uint16_t	num_;
+			uint8_t		chk_num_;
+			bool		valid_;
+			dir_index_t() : hash_(0), num_(0), chk_num_(0), valid_(false) { }
+		};
+
 		CSI&	csi_;
 
 		fatfs::mmc_io<CSI, SELECT> mmc_;
@@ -47,6 +72,8 @@ namespace utils {
 
 		char	current_[path_buff_size_];
 
+		dir_index_t	dir_index_;
+
 		static void dir_list_func_(const char* name, const FILINFO* fi, bool dir, void* option) {
 			if(fi == nullptr) return;
 
@@ -121,6 +148,73 @@ namespace utils {
 			}
 		}
 
+		static uint32_t path_hash_(const char* path) {
+			uint32_t h = 2166136261;  // FNV-1a
+			char ch;
+			while((ch = *path++) != 0) {
+				h ^= static_cast<uint8_t>(ch);
+				h *= 16777619;
+			}
+			return h;
+		}
+
+		bool open_dir_(const char* root, DIR& dir, char* full)
+		{
+			create_full_path_(root, full);
+#if _USE_LFN != 0
+			str::utf8_to_sjis(full, full);
+#endif
+			auto st = f_opendir(&dir, full);
+			if(st != FR_OK) {
+				format("Can't open dir(%d): '%s'\n") % static_cast<uint32_t>(st) % full;
+				return false;
+			}
+			std::strcat(full, "/");
+			return true;
+		}
+
+		template <typename FUNC>
+		static void dir_func_(FUNC func, const FILINFO& fi, char* p, bool todir, void* option)
+		{
+#if _USE_LFN != 0
+			str::sjis_to_utf8(fi.fname, p);
+#else
+			std::strcpy(p, fi.fname);
+#endif
+			if(fi.fattrib & AM_DIR) {
+				if(todir) {
+					func(p, &fi, true, option);
+				}
+			} else {
+				func(p, &fi, false, option);
+			}
+		}
+
+		void build_index_(DIR& dir, uint32_t hash)
+		{
+			FILINFO fi;
+			uint16_t num = 0;
+			uint8_t step = 0;
+			dir_index_.chk_num_ = 0;
+			for(;;) {
+				if(step == 0 && dir_index_.chk_num_ < DIR_INDEX) {
+					dir_index_.set(dir_index_.chk_num_, f_telldir(&dir));
+					++dir_index_.chk_num_;
+				}
+				if(f_readdir(&dir, &fi) != FR_OK) {
+					format("Can't read dir\n");
+					break;
+				}
+				if(!fi.fname[0]) break;
+				++num;
+				++step;
+				if(step >= dir_index_step_) step = 0;
+			}
+			dir_index_.hash_ = hash;
+			dir_index_.num_ = num;
+			dir_index_.valid_ = true;
+		}
+
 	public:
 		typedef void (*dir_loop_func)(const char* name, const FILINFO* fi, bool dir, void* option);
 
@@ -188,10 +282,85 @@ namespace utils {
 			if(f_open(fp, full, mode) != FR_OK) {
 				return false;
 			}
+			// 書き込みでエントリーが増減する可能性があるので、インデックスを破棄
+			if(mode != FA_READ) {
+				dir_index_.valid_ = false;
+			}
 			return true;
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリー・インデックスを破棄する @n
+					FatFS の API で直接エントリーを増減した場合に呼ぶ。
+		 */
+		//-----------------------------------------------------------------//
+		void invalidate_dir_index() { dir_index_.valid_ = false; }
+
+#if _FS_READONLY == 0 && _FS_MINIMIZE == 0
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイル、ディレクトリーの削除
+			@param[in]	path	ファイル名
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool unlink(const char* path)
+		{
+			char full[path_buff_size_];
+			create_full_path_(path, full);
+#if _USE_LFN != 0
+			str::utf8_to_sjis(full, full);
+#endif
+			dir_index_.valid_ = false;
+			return f_unlink(full) == FR_OK;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイル、ディレクトリーの名前の変更
+			@param[in]	org_path	元のファイル名
+			@param[in]	new_path	新しいファイル名
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool rename(const char* org_path, const char* new_path)
+		{
+			char org[path_buff_size_];
+			char dst[path_buff_size_];
+			create_full_path_(org_path, org);
+			create_full_path_(new_path, dst);
+#if _USE_LFN != 0
+			str::utf8_to_sjis(org, org);
+			str::utf8_to_sjis(dst, dst);
+#endif
+			dir_index_.valid_ = false;
+			return f_rename(org, dst) == FR_OK;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリーの作成
+			@param[in]	path	ディレクトリー名
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool mkdir(const char* path)
+		{
+			char full[path_buff_size_];
+			create_full_path_(path, full);
+#if _USE_LFN != 0
+			str::utf8_to_sjis(full, full);
+#endif
+			dir_index_.valid_ = false;
+			return f_mkdir(full) == FR_OK;
+		}
+#endif
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	カレント・パスの移動
@@ -246,16 +415,8 @@ namespace utils {
 
 			if(!mount_) return 0;
 
-			create_full_path_(root, full);
-#if _USE_LFN != 0
-			str::utf8_to_sjis(full, full);
-#endif
 			uint16_t num = 0;
-			auto st = f_opendir(&dir, full);
-			if(st != FR_OK) {
-				format("Can't open dir(%d): '%s'\n") % static_cast<uint32_t>(st) % full;
-			} else {
-				std::strcat(full, "/");
+			if(open_dir_(root, dir, full)) {
 				char* p = &full[std::strlen(full)];
 				for(;;) {
 					// Read a directory item
@@ -265,18 +426,7 @@ namespace utils {
 					}
 					if(!fi.fname[0]) break;
 					if(func != nullptr) {
-#if _USE_LFN != 0
-						str::sjis_to_utf8(fi.fname, p);
-#else
-						std::strcpy(p, fi.fname);
-#endif
-						if(fi.fattrib & AM_DIR) {
-							if(todir) {
-								func(p, &fi, true, option);
-							}
-						} else {
-							func(p, &fi, false, option);
-						}
+						dir_func_(func, fi, p, todir, option);
 					}
 					++num;
 				}
@@ -286,6 +436,99 @@ namespace utils {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリー・インデックスを作成して、エントリー数を返す @n
+					インデックスは、ディレクトリー毎に一度だけ作成され、 @n
+					マウント状態の変化、ファイルの書き込み、削除、名前の変更、 @n
+					ディレクトリーの作成で破棄される。
+			@param[in]	root	ルート・パス
+			@return エントリー数（ディレクトリーを含む）
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t dir_index(const char* root)
+		{
+			char full[path_buff_size_];
+			DIR dir;
+
+			if(!mount_) return 0;
+
+			if(!open_dir_(root, dir, full)) return 0;
+			auto h = path_hash_(full);
+			if(!dir_index_.valid_ || dir_index_.hash_ != h) {
+				build_index_(dir, h);
+			}
+			f_closedir(&dir);
+			return dir_index_.num_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ディレクトリーの一部（ページ）でタスクを実行する @n
+					インデックスから開始位置の近くに移動するので、 @n
+					ディレクトリーの大きさに依存せず、表示範囲だけを読む。 @n
+					DIR_INDEX が 0 の場合は、先頭から読み飛ばす。
+			@param[in]	root	ルート・パス
+			@param[in]	start	開始エントリー番号
+			@param[in]	num		エントリー数
+			@param[in]	func	実行関数
+			@param[in]	todir  「true」の場合、ディレクトリーも関数を呼ぶ
+			@param[in]	option	オプション・ポインター
+			@return 読み出したエントリー数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t dir_page(const char* root, uint16_t start, uint16_t num, dir_loop_func func,
+			bool todir = false, void* option = nullptr)
+		{
+			char full[path_buff_size_];
+			DIR dir;
+			FILINFO fi;
+
+			if(!mount_) return 0;
+
+			if(!open_dir_(root, dir, full)) return 0;
+			auto h = path_hash_(full);
+			if(!dir_index_.valid_ || dir_index_.hash_ != h) {
+				build_index_(dir, h);
+			}
+
+			uint16_t n = 0;
+			if(start >= dir_index_.num_) {
+				f_closedir(&dir);
+				return n;
+			}
+			// インデックスが無い場合は、先頭から読み飛ばす
+			uint16_t idx = 0;
+			if(dir_index_.chk_num_ > 0) {
+				uint16_t k = start / dir_index_step_;
+				if(k >= dir_index_.chk_num_) k = dir_index_.chk_num_ - 1;
+				if(f_seekdir(&dir, dir_index_.get(k)) != FR_OK) {
+					f_closedir(&dir);
+					return n;
+				}
+				idx = k * dir_index_step_;
+			}
+			char* p = &full[std::strlen(full)];
+			while(idx < (start + num)) {
+				if(f_readdir(&dir, &fi) != FR_OK) {
+					format("Can't read dir\n");
+					break;
+				}
+				if(!fi.fname[0]) break;
+				if(idx >= start) {
+					if(func != nullptr) {
+						dir_func_(func, fi, p, todir, option);
+					}
+					++n;
+				}
+				++idx;
+			}
+			f_closedir(&dir);
+			return n;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	SD カードのディレクトリから、ファイル名の取得
@@ -367,6 +610,7 @@ namespace utils {
 				POWER::P = 1;
 				SELECT::P = 0;
 				mount_ = false;
+				dir_index_.valid_ = false;
 //				format("Card unditect\n");
 			}
 			if(select_wait_ >= 10) cd_ = true;
@@ -386,6 +630,7 @@ namespace utils {
 						current_[0] = 0;
 						mount_ = true;
 					}
+					dir_index_.valid_ = false;
 				}
 			}
 			return mount_;
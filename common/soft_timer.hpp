@@ -0,0 +1,307 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ソフトウェア・タイマー（階層タイマー・ホイール） @n
+			３段（各３２スロット）のホイールで、登録、取り消しは O(1)、 @n
+			tick 毎の処理は、スロット１つ分だけで済む。 @n
+			割り込みでは tick 数を数えるだけで、ホイールの更新と、 @n
+			コールバックは、メインループの service() で行う。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  ソフトウェア・タイマー・テンプレートクラス @n
+				tick() は itimer、tau_io の割り込みタスクから、service() は @n
+				メインループから呼ぶ。@n
+				tickless で使う場合（INTERVAL_TIMER_sample 参照）： @n
+				・割り込みでは、その周期分の tick 数を tick(n) で渡す @n
+				  （itimer なら tick(itimer::get_scale())） @n
+				・割り込みの直後、service() の後に get_idle() で次の期限までの @n
+				  tick 数を求め、周期を変更する（itimer なら set_scale()） @n
+				・周期を伸ばしている間に start() した短い期限は、次の割り込みまで @n
+				  遅れる
+		@param[in]	NUM	タイマーの最大数（２５４以下）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t NUM>
+	class soft_timer {
+	public:
+		typedef void (*task_func)(void* option);
+
+		static constexpr uint8_t  NONE = 0xff;		///< 無効なハンドル
+		static constexpr uint16_t DELAY_MAX = 0x7fff;	///< 最大の遅延 [tick]
+
+	private:
+		static_assert(NUM > 0 && NUM < 0xff, "NUM out of range");
+
+		static constexpr uint8_t BITS = 5;
+		static constexpr uint8_t SIZE = 1 << BITS;
+		static constexpr uint8_t MASK = SIZE - 1;
+
+		static constexpr uint8_t SLOT_IDLE = 0xfe;	///< 停止中
+		static constexpr uint8_t SLOT_FREE = 0xff;	///< 未使用
+
+		struct timer_t {
+			task_func	func;
+			void*		option;
+			uint16_t	expire;
+			uint16_t	period;
+			uint8_t		next;
+			uint8_t		prev;
+			uint8_t		slot;
+		};
+
+		timer_t		timer_[NUM];
+		uint8_t		head_[SIZE * 3];
+		uint32_t	map_[3];	///< スロットの使用状況
+
+		volatile uint16_t	tick_;	///< 割り込みで進める
+		uint16_t	last_;		///< ホイールに反映した tick
+		uint16_t	now_;		///< ホイールの時間
+		uint8_t		free_;
+
+		static uint32_t bit_(uint8_t pos) { return static_cast<uint32_t>(1) << pos; }
+
+		void link_(uint8_t h, uint8_t slot)
+		{
+			auto& t = timer_[h];
+			t.slot = slot;
+			t.prev = NONE;
+			t.next = head_[slot];
+			if(t.next != NONE) timer_[t.next].prev = h;
+			head_[slot] = h;
+			map_[slot >> BITS] |= bit_(slot & MASK);
+		}
+
+		void unlink_(uint8_t h)
+		{
+			auto& t = timer_[h];
+			if(t.prev != NONE) timer_[t.prev].next = t.next;
+			else head_[t.slot] = t.next;
+			if(t.next != NONE) timer_[t.next].prev = t.prev;
+			if(head_[t.slot] == NONE) map_[t.slot >> BITS] &= ~bit_(t.slot & MASK);
+			t.slot = SLOT_IDLE;
+		}
+
+		// 期限までの距離で段を選ぶ
+		void insert_(uint8_t h)
+		{
+			uint16_t exp = timer_[h].expire;
+			uint16_t d = exp - now_;
+			uint8_t slot;
+			if(d < SIZE) {
+				slot = exp & MASK;
+			} else if(d < (SIZE << BITS)) {
+				slot = SIZE + ((exp >> BITS) & MASK);
+			} else {
+				slot = SIZE * 2 + ((exp >> (BITS * 2)) & MASK);
+			}
+			link_(h, slot);
+		}
+
+		void cascade_(uint8_t slot)
+		{
+			while(head_[slot] != NONE) {
+				uint8_t h = head_[slot];
+				unlink_(h);
+				insert_(h);
+			}
+		}
+
+		void process_()
+		{
+			if((now_ & MASK) == 0) {
+				if(((now_ >> BITS) & MASK) == 0) {
+					cascade_(SIZE * 2 + ((now_ >> (BITS * 2)) & MASK));
+				}
+				cascade_(SIZE + ((now_ >> BITS) & MASK));
+			}
+			uint8_t slot = now_ & MASK;
+			while(head_[slot] != NONE) {
+				uint8_t h = head_[slot];
+				unlink_(h);
+				auto& t = timer_[h];
+				// 周期タイマーは、コールバックの前に再登録（コールバックで停止できる）
+				if(t.period != 0) {
+					t.expire += t.period;
+					insert_(h);
+				}
+				t.func(t.option);
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		soft_timer() : tick_(0), last_(0), now_(0), free_(0)
+		{
+			for(uint8_t i = 0; i < NUM; ++i) {
+				timer_[i].slot = SLOT_FREE;
+				timer_[i].next = (i + 1) < NUM ? (i + 1) : NONE;
+			}
+			for(uint8_t i = 0; i < (SIZE * 3); ++i) head_[i] = NONE;
+			map_[0] = map_[1] = map_[2] = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	tick（割り込みから呼ぶ）
+			@param[in]	n	進める tick 数
+		 */
+		//-----------------------------------------------------------------//
+		void tick(uint16_t n = 1) { tick_ = tick_ + n; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイマーの追加（停止状態で確保する）
+			@param[in]	func	コールバック関数
+			@param[in]	option	コールバックに渡すポインター
+			@return ハンドル（空きが無い場合「NONE」）
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t add(task_func func, void* option = nullptr)
+		{
+			if(free_ == NONE || func == nullptr) return NONE;
+			uint8_t h = free_;
+			auto& t = timer_[h];
+			free_ = t.next;
+			t.func = func;
+			t.option = option;
+			t.period = 0;
+			t.slot = SLOT_IDLE;
+			return h;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイマーの削除
+			@param[in]	h	ハンドル
+		 */
+		//-----------------------------------------------------------------//
+		void remove(uint8_t h)
+		{
+			if(h >= NUM || timer_[h].slot == SLOT_FREE) return;
+			stop(h);
+			timer_[h].slot = SLOT_FREE;
+			timer_[h].next = free_;
+			free_ = h;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイマーの開始（動作中なら、再設定する）
+			@param[in]	h		ハンドル
+			@param[in]	delay	最初の期限までの tick 数（１～DELAY_MAX）
+			@param[in]	period	周期 [tick]（０ならワンショット）
+			@return ハンドルが無効なら「false」
+		 */
+		//-----------------------------------------------------------------//
+		bool start(uint8_t h, uint16_t delay, uint16_t period = 0)
+		{
+			if(h >= NUM || timer_[h].slot == SLOT_FREE) return false;
+			stop(h);
+			// ホイールに未反映の tick を含めて、期限を決める
+			uint16_t d = static_cast<uint16_t>(tick_ - last_) + delay;
+			if(d == 0) d = 1;
+			else if(d > DELAY_MAX) d = DELAY_MAX;
+			if(period > DELAY_MAX) period = DELAY_MAX;
+			auto& t = timer_[h];
+			t.expire = now_ + d;
+			t.period = period;
+			insert_(h);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイマーの停止
+			@param[in]	h	ハンドル
+		 */
+		//-----------------------------------------------------------------//
+		void stop(uint8_t h)
+		{
+			if(h >= NUM || timer_[h].slot >= SLOT_IDLE) return;
+			unlink_(h);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイマーが動作中か
+			@param[in]	h	ハンドル
+			@return 動作中なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_active(uint8_t h) const { return h < NUM && timer_[h].slot < SLOT_IDLE; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	次の期限までの tick 数を取得（tickless 用） @n
+					上位段の繰り下げ（３２ tick 毎）も期限として扱う。
+			@param[in]	limit	上限の tick 数
+			@return tick 数（１～limit）
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_idle(uint16_t limit) const
+		{
+			uint16_t d = limit;
+			uint8_t pos = (now_ + 1) & MASK;
+			uint32_t m = map_[0];
+			if(m != 0) {
+				m = (m >> pos) | (pos != 0 ? (m << (SIZE - pos)) : 0);
+				uint16_t n = __builtin_ctzl(m) + 1;
+				if(n < d) d = n;
+			}
+			if((map_[1] | map_[2]) != 0) {
+				uint16_t n = SIZE - (now_ & MASK);
+				if(n < d) d = n;
+			}
+			return d != 0 ? d : 1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（メインループから呼ぶ） @n
+					期限の無い区間は、まとめて進める。
+		 */
+		//-----------------------------------------------------------------//
+		void service()
+		{
+			uint16_t n = tick_ - last_;
+			while(n != 0) {
+				uint16_t step = get_idle(n);
+				n -= step;
+				last_ += step;
+				now_ += step;
+				process_();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ホイールの時間を取得
+			@return 時間 [tick]
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t get_time() const { return now_; }
+	};
+}
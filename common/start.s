@@ -20,11 +20,12 @@ _start:
 
 	mov		es, #0
 
-;; clear all RAM
+;; paint all RAM (stack high-water mark, see common/ram_monitor.hpp)
+;; .data and .bss are initialized below, the rest keeps the pattern.
 	sel		rb0		; bank 0
 	movw	hl, #__datastart
 LC0:
-	movw	ax, #0
+	movw	ax, #0xA55A
 	movw	[hl], ax
 	incw	hl
 	incw	hl
@@ -54,6 +55,29 @@ L15:
 L28:
 	sel		rb0		; bank 0
 
+;; block move to .ramtext (code executed from RAM)
+
+	movw	hl, #__ramtextstart
+	movw	de, #__romramtextstart
+	sel		rb1		; bank 1
+	movw	ax, #__ramtextcopysize
+	shrw	ax,1
+L30:
+	cmpw	ax, #0
+	bz		$L32
+	decw	ax
+	sel		rb0		; bank 0
+	movw	ax, es:[de]
+	movw	[hl], ax
+	incw	de
+	incw	de
+	incw	hl
+	incw	hl
+	sel		rb1
+	br		$L30
+L32:
+	sel		rb0		; bank 0
+
 
 
 ;; block fill to .bss
@@ -0,0 +1,141 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RL78/(G13/L1C) グループ TAU フリーラン・タイム・ベース @n
+			TAU の１チャネルを、TDR = 0xFFFF のインターバル・モードで回し、 @n
+			カウンター（TCR）と、一周の回数から、３２ビットの tick を作る。 @n
+			tick は 1～2MHz で、start() で time_base に登録する。 @n
+			※プリスケーラー（０～３：PRS0、４～７：PRS1）は、同じユニットの @n
+			他のチャネルと共有するので、同じ分周を使うか、別のグループを使う事。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "common/renesas.hpp"
+#include "common/time_base.hpp"
+
+/// F_CLK は分周の計算で必要、設定が無いとエラーにします。
+#ifndef F_CLK
+#  error "tau_clock.hpp requires F_CLK to be defined"
+#endif
+
+namespace device {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  TAU フリーラン・タイム・ベース・クラス・テンプレート @n
+				割り込みを使う場合、task() を TAU の割り込みベクターに登録する。 @n
+				ポーリングの場合、半周（最短 16mS）以内に、一度は now() を呼ぶ事。
+		@param[in]	TAU		タイマ・アレイ・ユニット・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class TAU>
+	class tau_clock {
+
+		static constexpr uint8_t get_prs_()
+		{
+			uint8_t n = 0;
+			while((F_CLK >> n) >= 2000000 && n < 15) ++n;
+			return n;
+		}
+
+		static volatile uint16_t	high_;
+		static uint8_t	level_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	tick の周波数を取得
+			@return 周波数 [Hz]
+		 */
+		//-----------------------------------------------------------------//
+		static constexpr uint32_t get_freq() { return F_CLK >> get_prs_(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	割り込みタスク（一周毎）
+		 */
+		//-----------------------------------------------------------------//
+		static void task() __attribute__ ((section (".lowtext")))
+		{
+			high_ = high_ + 1;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開始
+			@param[in]	level	割り込みレベル（１～２）、０の場合はポーリング
+		 */
+		//-----------------------------------------------------------------//
+		static void start(uint8_t level)
+		{
+			level_ = level;
+
+			intr::enable<TAU::get_peripheral()>(false);
+
+			manage::enable(TAU::get_peripheral());
+
+			uint8_t cks = 0;
+			if(TAU::get_chanel_no() < 4) {
+				TAU::TPS.PRS0 = get_prs_();
+			} else {
+				TAU::TPS.PRS1 = get_prs_();
+				cks = 2;
+			}
+
+			// インターバル・モード、開始時の割り込み無し
+			TAU::TMR = TAU::TMR.CKS.b(cks) | TAU::TMR.MD.b(0);
+			TAU::TDR = 0xffff;
+
+			high_ = 0;
+			TAU::TS = 1;
+			intr::set_request<TAU::get_peripheral()>(0);
+
+			if(level > 0) {
+				--level;
+				level ^= 0x03;
+				intr::set_level<TAU::get_peripheral()>(level);
+				intr::enable<TAU::get_peripheral()>();
+			}
+
+			utils::time_base::install(now, get_freq());
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	現在の tick を取得 @n
+					一周の要求フラグが保留中で、カウンターが一周した後の値なら、 @n
+					一周分を足す（割り込み禁止中、割り込み内からも呼べる）。
+			@return tick
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t now()
+		{
+			uint16_t h;
+			uint16_t t;
+			bool ovf;
+			do {
+				h = high_;
+				t = 0xffff - TAU::TCR();
+				ovf = intr::get_request<TAU::get_peripheral()>();
+			} while(h != high_) ;
+
+			if(ovf && t < 0x8000) {
+				if(level_ == 0) {  // ポーリングでは、ここで一周を数える
+					intr::set_request<TAU::get_peripheral()>(0);
+					high_ = h + 1;
+				}
+				++h;
+			}
+			return (static_cast<uint32_t>(h) << 16) | t;
+		}
+	};
+
+	template <class TAU> volatile uint16_t tau_clock<TAU>::high_ = 0;
+	template <class TAU> uint8_t tau_clock<TAU>::level_ = 0;
+}
@@ -81,15 +81,15 @@ namespace device {
 		void set_interrupt_() {
 
 			if(intr_level_ == 0) {
-				intr::enable(TAU::get_peripheral(), false);
+				intr::enable<TAU::get_peripheral()>(false);
 				return;
 			}
 
 			auto level = intr_level_;
 			--level;
 			level ^= 0x03;
-			intr::set_level(TAU::get_peripheral(), level);
-			intr::enable(TAU::get_peripheral());
+			intr::set_level<TAU::get_peripheral()>(level);
+			intr::enable<TAU::get_peripheral()>();
 		}
 
 	public:
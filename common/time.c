@@ -16,6 +16,17 @@ static const char mday_tbl_[] = {
 	31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
 };
 
+// １月１日から数えた、各月の開始日（通常年）
+static const short jan_day_[] = {
+	0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+// ３月１日から数えた、各月（３月～翌２月）の開始日 @n
+// うるう日が年の最後になるので、うるう年でも同じテーブルが使える
+static const short mar_day_[] = {
+	0, 31, 61, 92, 122, 153, 184, 214, 245, 275, 306, 337
+};
+
 /// 大阪、札幌、東京のタイムゾーン +9 hour
 static char timezone_offset_ = 9;
 static struct tm time_st_;
@@ -42,6 +53,33 @@ char check_leap_year(short year)
 }
 
 
+// 西暦、月、日から、1970 年１月１日からの通算日（ループ無し）
+static long days_from_civil_(short year, char mon, char day)
+{
+	if(mon < 2) --year;  // ３月始まりの年
+	long era = year / 400;
+	short yoe = year - (short)(era * 400);  // [0, 399]
+	short doy = mar_day_[(mon + 10) % 12] + day - 1;
+	return era * 146097L + (long)yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468L;
+}
+
+
+// 1970 年１月１日からの通算日から、西暦、月、日（ループ無し）
+static void civil_from_days_(long days, short* year, char* mon, char* day)
+{
+	long z = days + 719468L;  // 0000 年３月１日からの通算日
+	long era = z / 146097L;
+	long doe = z - era * 146097L;  // [0, 146096]
+	short yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  // [0, 399]
+	short doy = doe - ((long)yoe * 365 + yoe / 4 - yoe / 100);  // [0, 365]
+	// ３月始まりの月は、153 日が５ヶ月の周期（16 ビットの int で収まる）
+	char mp = (5 * doy + 2) / 153;  // [0, 11]
+	*day = doy - mar_day_[(int)mp] + 1;
+	*mon = mp < 10 ? mp + 2 : mp - 10;
+	*year = yoe + (short)(era * 400) + (*mon < 2 ? 1 : 0);
+}
+
+
 //-----------------------------------------------------------------//
 /*!
 	@brief	西暦と、月から、その月の最大日数を得る。
@@ -89,22 +127,7 @@ long get_total_day(short year, char mon, char day)
 {
 	if(year < 1970) return -1L;
 
-	long d = 0;
-	short i = 1970;
-	while(i < year) {
-		d += (long)get_yday(i);
-		i++;
-	}
-
-	i = 0;
-	while(i < mon) {
-		d += get_mday(year, i);
-		i++;
-	}
-
-	d += day - 1;
-
-	return d;
+	return days_from_civil_(year, mon, day);
 }
 
 
@@ -130,7 +153,8 @@ time_t get_timezone_offset(void)
 struct tm *gmtime(const time_t *tp)
 {
 	time_t	t;
-	short	i, j, k;
+	short	year;
+	char	mon, day;
 
 	t = *tp;
 
@@ -145,22 +169,12 @@ struct tm *gmtime(const time_t *tp)
 
 	time_st_.tm_wday = (t + 4) % 7;
 
-	j = 1970;
-	while(t >= (i = get_yday(j))) {
-		t -= (time_t)i;
-		j++;
-	}
-	time_st_.tm_year = j - 1900;
-
-	time_st_.tm_yday = t;
-
-	k = 0;
-	while(t >= (i = get_mday(j, k))) {
-		t -= (time_t)i;
-		k++;
-	}
-	time_st_.tm_mon = k;
-	time_st_.tm_mday = t + 1;
+	civil_from_days_(t, &year, &mon, &day);
+	time_st_.tm_year = year - 1900;
+	time_st_.tm_mon = mon;
+	time_st_.tm_mday = day;
+	time_st_.tm_yday = jan_day_[(int)mon] + day - 1;
+	if(mon >= 2 && check_leap_year(year)) ++time_st_.tm_yday;
 
 	return &time_st_;
 }
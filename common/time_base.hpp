@@ -0,0 +1,116 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ハードウェア・タイム・ベース（窓口） @n
+			フリーランのタイマー（tau_clock など）を登録すると、delay、 @n
+			deadline などは、NOP ループの代わりに、タイマーの値で時間を測る。 @n
+			登録しない場合、従来の NOP ループで動作する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  タイム・ベース・クラス @n
+				時間の単位は、登録したタイマーの tick（１～２ＭＨｚ程度）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class _>
+	struct time_base_t {
+
+		typedef uint32_t (*now_func)();
+
+		static now_func	now_;
+		static uint16_t	freq_k_;	///< tick の周波数 [KHz]
+		static uint16_t	tick_us_;	///< 1uS の tick 数（小数部８ビット、切り上げ）
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイマーの登録
+			@param[in]	now		現在の tick を返す関数（nullptr で解除）
+			@param[in]	freq	tick の周波数 [Hz]（1KHz の倍数）
+		 */
+		//-----------------------------------------------------------------//
+		static void install(now_func now, uint32_t freq)
+		{
+			freq_k_ = freq / 1000;
+			// 短い待ちで割り算をしない様に、変換の倍率をここで求める
+			tick_us_ = (static_cast<uint32_t>(freq_k_) * 256 + 999) / 1000;
+			now_ = now;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイマーが登録されているか
+			@return 登録されていれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		static bool is_start() { return now_ != nullptr; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	現在の tick を取得（３２ビットで一周する）
+			@return tick（登録されていない場合「０」）
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t now() { return now_ != nullptr ? now_() : 0; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	マイクロ秒を tick に変換
+			@param[in]	us	時間 [uS]
+			@return tick
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t from_us(uint32_t us)
+		{
+			// 1mS 未満は割り算をしない（倍率の切り上げで、長くなるのは数 tick 以内）
+			if(us < 1000) {
+				return (us * tick_us_ + 255) >> 8;
+			}
+			return (us / 1000) * freq_k_ + ((us % 1000) * freq_k_) / 1000;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ミリ秒を tick に変換
+			@param[in]	ms	時間 [mS]
+			@return tick
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t from_ms(uint16_t ms)
+		{
+			return static_cast<uint32_t>(ms) * freq_k_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	tick をマイクロ秒に変換
+			@param[in]	t	tick
+			@return 時間 [uS]
+		 */
+		//-----------------------------------------------------------------//
+		static uint32_t to_us(uint32_t t)
+		{
+			if(freq_k_ == 0) return 0;
+			return (t / freq_k_) * 1000 + ((t % freq_k_) * 1000) / freq_k_;
+		}
+	};
+
+	template <class _> typename time_base_t<_>::now_func time_base_t<_>::now_ = nullptr;
+	template <class _> uint16_t time_base_t<_>::freq_k_ = 0;
+	template <class _> uint16_t time_base_t<_>::tick_us_ = 0;
+
+	typedef time_base_t<void> time_base;
+}
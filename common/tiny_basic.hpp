@@ -0,0 +1,1098 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	タイニー BASIC インタープリター @n
+			行を入力した時点で中間コード（トークン）に変換して保存し、 @n
+			実行時は、ソース・テキストでは無く、中間コードを評価する。 @n
+			・数値は int32_t、変数は A～Z、配列は @(n) の一つ @n
+			・行番号の索引（昇順）を持ち、GOTO、GOSUB は二分探索 @n
+			  （定数の行番号は、分岐先を覚えて、二度目からは探さない） @n
+			・変数は、トークン化の時にスロット番号に変換済み @n
+			・命令：PRINT(?), LET, IF/THEN, GOTO, GOSUB, RETURN, @n
+			  FOR/TO/STEP, NEXT, REM, END, STOP @n
+			・コマンド：RUN, LIST [開始[,終了]], NEW @n
+			・関数：ABS(n), RND(n) @n
+			・演算子：+ - * / % = <> < <= > >= AND OR @n
+			・速度：basic_bench（BM1～BM7 の合計）で、テキストのまま実行する @n
+			  インタープリターの約 5 倍（ホストの時間、命令数では約 4 倍）で、 @n
+			  目標の 10 倍には届かない。トークン化で省けるのは、字句解析と @n
+			  行の探索だけで、残りは、トークン毎の振り分け（文、演算子）。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include "common/format.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  ブレーク検出無し（ホスト、ベンチマーク用）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct tiny_basic_null_break {
+		bool operator() () { return false; }
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  タイニー BASIC クラス @n
+				プログラムの１行は、[行番号(2)][長さ(1)][トークン...][EOL]
+		@param[in]	PSIZE	プログラム領域のバイト数
+		@param[in]	LNUM	最大行数
+		@param[in]	ASIZE	配列 @() の大きさ
+		@param[in]	BRK		ブレーク検出ファンクタ（「true」で実行を止める）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint16_t PSIZE = 2048, uint8_t LNUM = 128, uint8_t ASIZE = 32,
+		class BRK = tiny_basic_null_break>
+	class tiny_basic {
+	public:
+
+		//=================================================================//
+		/*!
+			@brief	エラー型
+		*/
+		//=================================================================//
+		enum class error : uint8_t {
+			none,		///< エラー無し
+			syntax,		///< 文法
+			line,		///< 行番号が無い
+			div0,		///< ０割り
+			range,		///< 配列の範囲外
+			nest,		///< GOSUB、FOR のネストが深すぎる
+			return_,	///< GOSUB の無い RETURN
+			next,		///< FOR の無い NEXT
+			memory,		///< プログラム領域が一杯
+			break_,		///< ブレーク
+		};
+
+	private:
+		static constexpr uint8_t NEST = 8;			///< GOSUB、FOR の深さ
+		static constexpr uint8_t TOKEN_MAX = 128;	///< １行のトークンの最大
+		static constexpr uint8_t JUMP_CACHE = 8;	///< 分岐先キャッシュの数（2 のべき乗）
+
+		enum token : uint8_t {
+			T_EOL	= 0x00,
+			T_NUM16	= 0x01,	///< 数値（１６ビット）
+			T_NUM32	= 0x02,	///< 数値（３２ビット）
+			T_VAR	= 0x03,	///< 変数（スロット番号）
+			T_STR	= 0x04,	///< 文字列（長さ、文字...）
+			T_LE	= 0x05,	///< <=
+			T_GE	= 0x06,	///< >=
+			T_NE	= 0x07,	///< <>
+
+			T_PRINT	= 0x80,
+			T_LET,
+			T_IF,
+			T_THEN,
+			T_GOTO,
+			T_GOSUB,
+			T_RETURN,
+			T_FOR,
+			T_TO,
+			T_STEP,
+			T_NEXT,
+			T_REM,
+			T_END,
+			T_STOP,
+			T_AND,
+			T_OR,
+			T_ABS,
+			T_RND,
+			T_RUN,
+			T_LIST,
+			T_NEW,
+			T_LAST_
+		};
+
+		struct gosub_t {
+			const uint8_t*	pc;
+			const uint8_t*	line;
+		};
+
+		struct for_t {
+			const uint8_t*	pc;
+			const uint8_t*	line;
+			int32_t			limit;
+			int32_t			step;
+			uint8_t			slot;
+		};
+
+		struct jump_t {
+			uint16_t	at;		///< 行番号（定数）の位置 + 1（「０」は空き）
+			uint16_t	pos;	///< 分岐先の行の位置
+		};
+
+		uint8_t		prog_[PSIZE];
+		uint16_t	used_;
+		uint16_t	idx_[LNUM];		///< 各行の先頭（行番号の昇順）
+		uint8_t		lnum_;
+		jump_t		jcache_[JUMP_CACHE];	///< 定数の行番号への分岐先
+
+		uint8_t		imm_[3 + TOKEN_MAX];	///< 直接実行の行（行番号０）
+
+		int32_t		var_[26];
+		int32_t		arr_[ASIZE];
+
+		gosub_t		gosub_[NEST];
+		uint8_t		gosub_pos_;
+		for_t		for_[NEST];
+		uint8_t		for_pos_;
+
+		const uint8_t*	pc_;
+		const uint8_t*	line_;
+		bool		stop_;
+		error		error_;
+		uint16_t	error_line_;
+
+		uint16_t	rnd_;
+
+		BRK			brk_;
+		uint8_t		brk_count_;
+
+		static const char* keyword_(uint8_t t)
+		{
+			static const char* tbl[] = {
+				"PRINT", "LET", "IF", "THEN", "GOTO", "GOSUB", "RETURN",
+				"FOR", "TO", "STEP", "NEXT", "REM", "END", "STOP",
+				"AND", "OR", "ABS", "RND", "RUN", "LIST", "NEW"
+			};
+			return tbl[t - T_PRINT];
+		}
+
+		static char toupper_(char ch)
+		{
+			if(ch >= 'a' && ch <= 'z') ch -= 'a' - 'A';
+			return ch;
+		}
+
+		static uint16_t get_num_(const uint8_t* line)
+		{
+			return static_cast<uint16_t>(line[0]) | (static_cast<uint16_t>(line[1]) << 8);
+		}
+
+		static void putch_(char ch) { format::chaout()(ch); }
+
+		static void puts_(const char* s) { while(*s != 0) putch_(*s++); }
+
+		// キーワードの照合（一致したら s を進める）
+		static uint8_t match_keyword_(const char*& s)
+		{
+			for(uint8_t t = T_PRINT; t < T_LAST_; ++t) {
+				const char* k = keyword_(t);
+				const char* p = s;
+				while(*k != 0 && toupper_(*p) == *k) {
+					++p;
+					++k;
+				}
+				if(*k == 0) {
+					s = p;
+					return t;
+				}
+			}
+			return 0;
+		}
+
+
+		// テキストをトークンに変換、戻り値は EOL を含むバイト数（エラーは「０」）
+		uint8_t tokenize_(const char* s, uint8_t* dst)
+		{
+			uint16_t n = 0;
+			auto put = [&](uint8_t v) {
+				if(n < TOKEN_MAX) dst[n] = v;
+				++n;
+			};
+			while(*s != 0) {
+				char ch = *s;
+				if(ch == ' ') {
+					++s;
+					continue;
+				}
+				uint8_t t = match_keyword_(s);
+				if(t != 0) {
+					put(t);
+					if(t == T_REM) {  // 行の残りは、そのまま
+						while(*s == ' ') ++s;
+						uint8_t l = strlen(s);
+						put(T_STR);
+						put(l);
+						while(*s != 0) put(*s++);
+					}
+					continue;
+				}
+				ch = toupper_(ch);
+				if(ch >= 'A' && ch <= 'Z') {
+					put(T_VAR);
+					put(ch - 'A');
+					++s;
+				} else if(ch >= '0' && ch <= '9') {
+					uint32_t v = 0;
+					while(*s >= '0' && *s <= '9') {
+						v = v * 10 + (*s - '0');
+						++s;
+					}
+					if(v <= 0x7fff) {
+						put(T_NUM16);
+						put(v);
+						put(v >> 8);
+					} else {
+						put(T_NUM32);
+						put(v);
+						put(v >> 8);
+						put(v >> 16);
+						put(v >> 24);
+					}
+				} else if(ch == '"') {
+					++s;
+					const char* org = s;
+					while(*s != 0 && *s != '"') ++s;
+					if(*s == 0) {
+						error_ = error::syntax;
+						return 0;
+					}
+					put(T_STR);
+					put(s - org);
+					while(org < s) put(*org++);
+					++s;
+				} else if(ch == '<' && s[1] == '=') {
+					put(T_LE);
+					s += 2;
+				} else if(ch == '>' && s[1] == '=') {
+					put(T_GE);
+					s += 2;
+				} else if(ch == '<' && s[1] == '>') {
+					put(T_NE);
+					s += 2;
+				} else if(ch == '?') {
+					put(T_PRINT);
+					++s;
+				} else if(strchr("+-*/%()=<>,;:@", ch) != nullptr) {
+					put(ch);
+					++s;
+				} else {
+					error_ = error::syntax;
+					return 0;
+				}
+			}
+			put(T_EOL);
+			if(n > TOKEN_MAX) {
+				error_ = error::memory;
+				return 0;
+			}
+			return n;
+		}
+
+
+		// 行番号 num 以上の最初の行（索引の位置）
+		uint8_t lower_(uint16_t num) const
+		{
+			uint16_t lo = 0;
+			uint16_t hi = lnum_;
+			while(lo < hi) {
+				uint16_t mid = (lo + hi) >> 1;
+				if(get_num_(&prog_[idx_[mid]]) < num) lo = mid + 1;
+				else hi = mid;
+			}
+			return lo;
+		}
+
+
+		void build_index_()
+		{
+			for(uint8_t i = 0; i < JUMP_CACHE; ++i) jcache_[i].at = 0;
+			lnum_ = 0;
+			uint16_t pos = 0;
+			while(pos < used_ && lnum_ < LNUM) {
+				idx_[lnum_] = pos;
+				++lnum_;
+				pos += prog_[pos + 2];
+			}
+		}
+
+
+		bool store_(uint16_t num, const uint8_t* tok, uint8_t len)
+		{
+			uint8_t i = lower_(num);
+			uint16_t pos = i < lnum_ ? idx_[i] : used_;
+			// 同じ番号の行は消す
+			if(i < lnum_ && get_num_(&prog_[pos]) == num) {
+				uint8_t l = prog_[pos + 2];
+				memmove(&prog_[pos], &prog_[pos + l], used_ - pos - l);
+				used_ -= l;
+				--lnum_;
+			}
+			if(len > 1) {  // EOL だけなら削除のみ
+				uint16_t l = 3 + len;
+				if((used_ + l) > PSIZE || lnum_ >= LNUM) {
+					build_index_();
+					error_ = error::memory;
+					return false;
+				}
+				memmove(&prog_[pos + l], &prog_[pos], used_ - pos);
+				prog_[pos + 0] = num;
+				prog_[pos + 1] = num >> 8;
+				prog_[pos + 2] = l;
+				memcpy(&prog_[pos + 3], tok, len);
+				used_ += l;
+			}
+			build_index_();
+			return true;
+		}
+
+
+		void clear_var_()
+		{
+			for(uint8_t i = 0; i < 26; ++i) var_[i] = 0;
+			for(uint8_t i = 0; i < ASIZE; ++i) arr_[i] = 0;
+		}
+
+
+		void set_error_(error err)
+		{
+			if(error_ == error::none) error_ = err;
+		}
+
+
+		bool skip_(uint8_t t)
+		{
+			if(*pc_ != t) {
+				set_error_(error::syntax);
+				return false;
+			}
+			++pc_;
+			return true;
+		}
+
+
+		bool is_end_() const { return *pc_ == T_EOL || *pc_ == ':'; }
+
+
+		//-----------------------------------------------------------------//
+		// 式の評価（整数のみ、エラーの場合は「０」を返して EOL で止まる）
+		//-----------------------------------------------------------------//
+		int32_t* array_()
+		{
+			if(!skip_('(')) return nullptr;
+			int32_t i = expr_();
+			if(!skip_(')')) return nullptr;
+			if(i < 0 || i >= ASIZE) {
+				set_error_(error::range);
+				return nullptr;
+			}
+			return &arr_[i];
+		}
+
+
+		int32_t paren_()
+		{
+			if(!skip_('(')) return 0;
+			int32_t v = expr_();
+			if(!skip_(')')) return 0;
+			return v;
+		}
+
+
+		int32_t primary_()
+		{
+			switch(*pc_) {
+			case T_NUM16:
+				pc_ += 3;
+				return static_cast<int16_t>(get_num_(pc_ - 2));
+			case T_NUM32:
+				pc_ += 5;
+				return static_cast<int32_t>(static_cast<uint32_t>(get_num_(pc_ - 4))
+					| (static_cast<uint32_t>(get_num_(pc_ - 2)) << 16));
+			case T_VAR:
+				pc_ += 2;
+				return var_[pc_[-1]];
+			case '@':
+				{
+					++pc_;
+					int32_t* p = array_();
+					return p != nullptr ? *p : 0;
+				}
+			case '(':
+				return paren_();
+			case T_ABS:
+				{
+					++pc_;
+					int32_t v = paren_();
+					return v < 0 ? -v : v;
+				}
+			case T_RND:
+				{
+					++pc_;
+					int32_t v = paren_();
+					rnd_ ^= rnd_ << 7;
+					rnd_ ^= rnd_ >> 9;
+					rnd_ ^= rnd_ << 8;
+					return v > 0 ? (rnd_ % v) : 0;
+				}
+			default:
+				set_error_(error::syntax);
+				return 0;
+			}
+		}
+
+
+		// 二項演算子の優先順位（「０」なら、演算子では無い）
+		static uint8_t prec_(uint8_t op)
+		{
+			switch(op) {
+			case T_AND:
+			case T_OR:
+				return 1;
+			case '=':
+			case '<':
+			case '>':
+			case T_LE:
+			case T_GE:
+			case T_NE:
+				return 2;
+			case '+':
+			case '-':
+				return 3;
+			case '*':
+			case '/':
+			case '%':
+				return 4;
+			default:
+				return 0;
+			}
+		}
+
+
+		int32_t unary_()
+		{
+			uint8_t t = *pc_;
+			if(t == T_VAR) {
+				pc_ += 2;
+				return var_[pc_[-1]];
+			} else if(t == T_NUM16) {
+				pc_ += 3;
+				return static_cast<int16_t>(get_num_(pc_ - 2));
+			} else if(t == '-') {
+				++pc_;
+				return -unary_();
+			} else if(t == '+') {
+				++pc_;
+			}
+			return primary_();
+		}
+
+
+		// 左辺 v に、優先順位 min 以上の演算子を適用する（比較は連ねない） @n
+		// 右辺の後に、より強い演算子がある時だけ再帰する
+		int32_t binary_(int32_t v, uint8_t min)
+		{
+			uint8_t last = 0;
+			while(1) {
+				uint8_t op = *pc_;
+				uint8_t p = prec_(op);
+				if(p < min || p == 0 || (p == 2 && last == 2)) break;
+				++pc_;
+				int32_t b = unary_();
+				if(prec_(*pc_) > p) b = binary_(b, p + 1);
+				last = p;
+				switch(op) {
+				case T_OR:  v = (v != 0 || b != 0); break;
+				case T_AND: v = (v != 0 && b != 0); break;
+				case '=':   v = v == b; break;
+				case '<':   v = v < b; break;
+				case '>':   v = v > b; break;
+				case T_LE:  v = v <= b; break;
+				case T_GE:  v = v >= b; break;
+				case T_NE:  v = v != b; break;
+				case '+':   v += b; break;
+				case '-':   v -= b; break;
+				case '*':   v *= b; break;
+				default:
+					if(b == 0) {
+						set_error_(error::div0);
+						return 0;
+					}
+					if(op == '/') v /= b;
+					else v %= b;
+					break;
+				}
+			}
+			return v;
+		}
+
+
+		int32_t expr_() { return binary_(unary_(), 1); }
+
+
+		//-----------------------------------------------------------------//
+		// 実行
+		//-----------------------------------------------------------------//
+		// ブレークの検出（行の移動 32 回に１回）
+		bool break_()
+		{
+			++brk_count_;
+			if((brk_count_ & 31) != 0 || !brk_()) return false;
+			set_error_(error::break_);
+			return true;
+		}
+
+
+		// 分岐先の行（行番号の式を評価する） @n
+		// 行番号が定数だけなら、分岐先を覚えて、次からは二分探索を省く
+		const uint8_t* target_()
+		{
+			const uint8_t* at = pc_;
+			uint16_t key = 0;
+			if(line_ != imm_ && *at == T_NUM16) {
+				key = at - prog_ + 1;
+				const jump_t& c = jcache_[key & (JUMP_CACHE - 1)];
+				if(c.at == key) {
+					pc_ += 3;
+					return &prog_[c.pos];
+				}
+			}
+			int32_t num = expr_();
+			if(error_ != error::none) return nullptr;
+			uint8_t i = lnum_;
+			if(num >= 1 && num <= 0xffff) i = lower_(num);
+			if(i >= lnum_ || get_num_(&prog_[idx_[i]]) != num) {
+				set_error_(error::line);
+				return nullptr;
+			}
+			if(key != 0 && pc_ == (at + 3)) {
+				jump_t& c = jcache_[key & (JUMP_CACHE - 1)];
+				c.at = key;
+				c.pos = idx_[i];
+			}
+			return &prog_[idx_[i]];
+		}
+
+
+		void jump_(const uint8_t* line)
+		{
+			if(line == nullptr || break_()) return;
+			line_ = line;
+			pc_ = line + 3;
+		}
+
+
+		bool next_line_()
+		{
+			if(line_ == imm_) return false;
+			const uint8_t* p = line_ + line_[2];
+			if(p >= &prog_[used_]) return false;
+			if(break_()) return false;
+			line_ = p;
+			pc_ = p + 3;
+			return true;
+		}
+
+
+		void skip_line_() { pc_ = line_ + line_[2] - 1; }
+
+
+		void let_()
+		{
+			int32_t* p = nullptr;
+			if(*pc_ == T_VAR) {
+				p = &var_[pc_[1]];
+				pc_ += 2;
+			} else if(*pc_ == '@') {
+				++pc_;
+				p = array_();
+			} else {
+				set_error_(error::syntax);
+			}
+			if(p == nullptr || !skip_('=')) return;
+			int32_t v = expr_();
+			if(error_ == error::none) *p = v;
+		}
+
+
+		void print_()
+		{
+			bool nl = true;
+			while(!is_end_()) {
+				nl = true;
+				if(*pc_ == T_STR) {
+					uint8_t l = pc_[1];
+					pc_ += 2;
+					while(l > 0) {
+						putch_(*pc_++);
+						--l;
+					}
+				} else {
+					int32_t v = expr_();
+					if(error_ != error::none) return;
+					format("%d") % v;
+				}
+				if(*pc_ == ';') {
+					++pc_;
+					nl = false;
+				} else if(*pc_ == ',') {
+					++pc_;
+					putch_(' ');
+					nl = false;
+				} else if(!is_end_()) {
+					set_error_(error::syntax);
+					return;
+				}
+			}
+			if(nl) putch_('\n');
+		}
+
+
+		void for_statement_()
+		{
+			if(*pc_ != T_VAR) {
+				set_error_(error::syntax);
+				return;
+			}
+			uint8_t slot = pc_[1];
+			pc_ += 2;
+			if(!skip_('=')) return;
+			int32_t v = expr_();
+			if(!skip_(T_TO)) return;
+			int32_t limit = expr_();
+			int32_t step = 1;
+			if(*pc_ == T_STEP) {
+				++pc_;
+				step = expr_();
+			}
+			if(error_ != error::none) return;
+
+			var_[slot] = v;
+			// 同じ変数のループは、それより内側と共に捨てる
+			for(uint8_t i = for_pos_; i > 0; --i) {
+				if(for_[i - 1].slot == slot) {
+					for_pos_ = i - 1;
+					break;
+				}
+			}
+			if(for_pos_ >= NEST) {
+				set_error_(error::nest);
+				return;
+			}
+			auto& f = for_[for_pos_];
+			++for_pos_;
+			f.pc = pc_;
+			f.line = line_;
+			// FOR が行の最後なら、NEXT は次の行の先頭に戻る
+			if(*pc_ == T_EOL && line_ != imm_) {
+				const uint8_t* p = line_ + line_[2];
+				if(p < &prog_[used_]) {
+					f.pc = p + 3;
+					f.line = p;
+				}
+			}
+			f.limit = limit;
+			f.step = step;
+			f.slot = slot;
+		}
+
+
+		void next_statement_()
+		{
+			uint8_t pos = for_pos_;
+			if(*pc_ == T_VAR) {
+				uint8_t slot = pc_[1];
+				pc_ += 2;
+				while(pos > 0 && for_[pos - 1].slot != slot) --pos;
+			}
+			if(pos == 0) {
+				set_error_(error::next);
+				return;
+			}
+			const auto& f = for_[pos - 1];
+			int32_t v = var_[f.slot] + f.step;
+			var_[f.slot] = v;
+			if(f.step >= 0 ? v <= f.limit : v >= f.limit) {
+				if(break_()) return;
+				for_pos_ = pos;
+				pc_ = f.pc;
+				line_ = f.line;
+			} else {
+				for_pos_ = pos - 1;
+			}
+		}
+
+
+		void list_line_(const uint8_t* line)
+		{
+			format("%d ") % get_num_(line);
+			const uint8_t* p = line + 3;
+			bool key = false;
+			while(*p != T_EOL) {
+				uint8_t t = *p++;
+				bool k = key;
+				key = false;
+				if(t == T_NUM16) {
+					format("%d") % static_cast<int16_t>(get_num_(p));
+					p += 2;
+				} else if(t == T_NUM32) {
+					format("%d") % static_cast<int32_t>(static_cast<uint32_t>(get_num_(p))
+						| (static_cast<uint32_t>(get_num_(p + 2)) << 16));
+					p += 4;
+				} else if(t == T_VAR) {
+					putch_('A' + *p++);
+				} else if(t == T_STR) {
+					bool rem = p[-2] == T_REM;
+					uint8_t l = *p++;
+					if(!rem) putch_('"');
+					while(l > 0) {
+						putch_(*p++);
+						--l;
+					}
+					if(!rem) putch_('"');
+				} else if(t == T_LE) {
+					puts_("<=");
+				} else if(t == T_GE) {
+					puts_(">=");
+				} else if(t == T_NE) {
+					puts_("<>");
+				} else if(t == T_ABS || t == T_RND) {
+					puts_(keyword_(t));
+				} else if(t >= T_PRINT && t < T_LAST_) {
+					if(p > (line + 4) && !k) putch_(' ');
+					puts_(keyword_(t));
+					if(*p != T_EOL) putch_(' ');
+					key = true;
+				} else {
+					putch_(t);
+				}
+			}
+			putch_('\n');
+		}
+
+
+		void list_()
+		{
+			int32_t org = 0;
+			int32_t end = 0xffff;
+			if(!is_end_()) {
+				org = end = expr_();
+				if(*pc_ == ',') {
+					++pc_;
+					end = expr_();
+				}
+			}
+			if(error_ != error::none) return;
+			if(org < 0) org = 0;
+			for(uint8_t i = org > 0xffff ? lnum_ : lower_(org); i < lnum_; ++i) {
+				const uint8_t* line = &prog_[idx_[i]];
+				if(get_num_(line) > end) break;
+				list_line_(line);
+			}
+		}
+
+
+		void statement_()
+		{
+			uint8_t t = *pc_;
+			if(t == T_VAR || t == '@') {
+				let_();
+				return;
+			}
+			++pc_;
+			switch(t) {
+			case T_PRINT:
+				print_();
+				break;
+			case T_LET:
+				let_();
+				break;
+			case T_IF:
+				{
+					int32_t v = expr_();
+					if(error_ != error::none) break;
+					if(*pc_ == T_THEN) ++pc_;
+					// 行番号は 65535 までなので、32767 を超える行は T_NUM32
+					if(v == 0) skip_line_();
+					else if(*pc_ == T_NUM16 || *pc_ == T_NUM32) jump_(target_());
+				}
+				break;
+			case T_GOTO:
+				jump_(target_());
+				break;
+			case T_GOSUB:
+				{
+					const uint8_t* line = target_();
+					if(line == nullptr) break;
+					if(gosub_pos_ >= NEST) {
+						set_error_(error::nest);
+						break;
+					}
+					gosub_[gosub_pos_].pc = pc_;
+					gosub_[gosub_pos_].line = line_;
+					++gosub_pos_;
+					jump_(line);
+				}
+				break;
+			case T_RETURN:
+				if(gosub_pos_ == 0) {
+					set_error_(error::return_);
+					break;
+				}
+				--gosub_pos_;
+				pc_ = gosub_[gosub_pos_].pc;
+				line_ = gosub_[gosub_pos_].line;
+				break;
+			case T_FOR:
+				for_statement_();
+				break;
+			case T_NEXT:
+				next_statement_();
+				break;
+			case T_REM:
+				skip_line_();
+				break;
+			case T_END:
+			case T_STOP:
+				stop_ = true;
+				break;
+			case T_RUN:
+				clear_var_();
+				gosub_pos_ = 0;
+				for_pos_ = 0;
+				if(lnum_ == 0) {
+					stop_ = true;
+				} else {
+					line_ = &prog_[idx_[0]];
+					pc_ = line_ + 3;
+				}
+				break;
+			case T_LIST:
+				list_();
+				break;
+			case T_NEW:
+				clear();
+				stop_ = true;
+				break;
+			default:
+				--pc_;
+				set_error_(error::syntax);
+				break;
+			}
+		}
+
+
+		void exec_()
+		{
+			gosub_pos_ = 0;
+			for_pos_ = 0;
+			stop_ = false;
+			while(!stop_ && error_ == error::none) {
+				uint8_t t = *pc_;
+				if(t == T_EOL) {
+					if(!next_line_()) break;
+				} else if(t == ':') {
+					++pc_;
+				} else {
+					statement_();
+				}
+			}
+			if(error_ != error::none) {
+				error_line_ = get_num_(line_);
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		tiny_basic() : used_(0), lnum_(0), jcache_(), gosub_pos_(0), for_pos_(0),
+			pc_(imm_), line_(imm_), stop_(false), error_(error::none), error_line_(0),
+			rnd_(0x1234), brk_(), brk_count_(0) {
+			imm_[0] = 0;
+			imm_[1] = 0;
+			imm_[2] = 4;
+			imm_[3] = T_EOL;
+			clear_var_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ブレーク検出ファンクタの参照
+			@return ブレーク検出ファンクタ
+		 */
+		//-----------------------------------------------------------------//
+		BRK& at_break() { return brk_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	プログラムの消去（NEW）
+		 */
+		//-----------------------------------------------------------------//
+		void clear()
+		{
+			used_ = 0;
+			lnum_ = 0;
+			clear_var_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１行の入力 @n
+					行番号で始まる場合は、プログラムに格納（行番号だけなら削除）、 @n
+					それ以外は、直ちに実行する。
+			@param[in]	text	入力行
+			@return エラーが無ければ「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool service(const char* text)
+		{
+			error_ = error::none;
+			error_line_ = 0;
+			while(*text == ' ') ++text;
+			if(*text >= '0' && *text <= '9') {
+				uint32_t num = 0;
+				while(*text >= '0' && *text <= '9') {
+					num = num * 10 + (*text - '0');
+					++text;
+				}
+				if(num < 1 || num > 0xffff) {
+					error_ = error::line;
+				} else {
+					uint8_t tok[TOKEN_MAX];
+					uint8_t len = tokenize_(text, tok);
+					if(len > 0) store_(num, tok, len);
+				}
+			} else {
+				uint8_t len = tokenize_(text, &imm_[3]);
+				if(len > 0) {
+					imm_[2] = 3 + len;
+					line_ = imm_;
+					pc_ = &imm_[3];
+					exec_();
+				}
+			}
+			if(error_ != error::none) {
+				static const char* msg[] = {
+					"", "SYNTAX", "UNDEFINED LINE", "DIVISION BY ZERO", "OUT OF RANGE",
+					"NESTING TOO DEEP", "RETURN WITHOUT GOSUB", "NEXT WITHOUT FOR",
+					"OUT OF MEMORY", "BREAK"
+				};
+				format("?%s ERROR") % msg[static_cast<uint8_t>(error_)];
+				if(error_line_ != 0) format(" IN %d") % error_line_;
+				putch_('\n');
+				return false;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	最後のエラーを取得
+			@return エラー
+		 */
+		//-----------------------------------------------------------------//
+		error get_error() const { return error_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	変数の取得
+			@param[in]	ch	変数名（'A'～'Z'）
+			@return 値
+		 */
+		//-----------------------------------------------------------------//
+		int32_t get_var(char ch) const
+		{
+			ch = toupper_(ch);
+			return (ch >= 'A' && ch <= 'Z') ? var_[ch - 'A'] : 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	プログラムの大きさ
+			@return バイト数
+		 */
+		//-----------------------------------------------------------------//
+		uint16_t size() const { return used_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	行数
+			@return 行数
+		 */
+		//-----------------------------------------------------------------//
+		uint8_t lines() const { return lnum_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	プログラムをデータ・フラッシュに保存 @n
+					[ 'T', 'B', 大きさ(2) ][ プログラム... ]
+			@param[in]	flash	flash_io クラス
+			@param[in]	org		保存先（ブロックの先頭）
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		template <class FLASH>
+		bool save(FLASH& flash, uint16_t org)
+		{
+			uint16_t len = 4 + used_;
+			if((static_cast<uint32_t>(org) + len) > flash.size()) return false;
+			for(uint16_t a = 0; a < len; a += FLASH::data_flash_block) {
+				if(!flash.erase(org + a)) return false;
+			}
+			uint8_t head[4] = { 'T', 'B', static_cast<uint8_t>(used_),
+				static_cast<uint8_t>(used_ >> 8) };
+			if(!flash.write(org, head, 4)) return false;
+			if(used_ == 0) return true;
+			return flash.write(org + 4, prog_, used_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	プログラムをデータ・フラッシュから読み込む
+			@param[in]	flash	flash_io クラス
+			@param[in]	org		保存先（ブロックの先頭）
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		template <class FLASH>
+		bool load(FLASH& flash, uint16_t org)
+		{
+			uint8_t head[4];
+			if(!flash.read(org, head, 4)) return false;
+			if(head[0] != 'T' || head[1] != 'B') return false;
+			uint16_t len = static_cast<uint16_t>(head[2]) | (static_cast<uint16_t>(head[3]) << 8);
+			if(len > PSIZE) return false;
+			clear();
+			if(len > 0 && !flash.read(org + 4, prog_, len)) return false;
+			// 行の並びを検査
+			uint16_t pos = 0;
+			uint16_t num = 0;
+			uint16_t lines = 0;
+			while(pos < len) {
+				uint16_t n = get_num_(&prog_[pos]);
+				uint8_t l = prog_[pos + 2];
+				if(n <= num || l < 4 || (pos + l) > len || prog_[pos + l - 1] != T_EOL) {
+					return false;
+				}
+				num = n;
+				pos += l;
+				++lines;
+			}
+			if(lines > LNUM) return false;
+			used_ = len;
+			build_index_();
+			return true;
+		}
+	};
+}
@@ -9,6 +9,7 @@
 */
 //=========================================================================//
 #include "common/renesas.hpp"
+#include "common/task.hpp"
 
 /// F_CLK はボーレートパラメーター計算で必要、設定が無いとエラーにします。
 #ifndef F_CLK
@@ -24,9 +25,10 @@ namespace device {
 		@param[in]	SAUrx	シリアル・アレイ・ユニット受信・クラス（奇数チャネル）
 		@param[in]	BUFtx	送信バッファサイズ（８バイト以上のサイズである事）
 		@param[in]	BUFrx	受信バッファサイズ（８バイト以上のサイズである事）
+		@param[in]	RTASK	受信割り込みタスク（１文字受信する毎に呼ぶ）
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
-	template <class SAUtx, class SAUrx, class BUFtx, class BUFrx>
+	template <class SAUtx, class SAUrx, class BUFtx, class BUFrx, class RTASK = utils::null_task>
 	class uart_io {
 	public:
 		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
@@ -55,6 +57,7 @@ namespace device {
 	private:
 		static BUFtx send_;
 		static BUFrx recv_;
+		static RTASK rtask_;
 
 		static volatile bool	send_stall_;
 
@@ -73,7 +76,7 @@ namespace device {
 				char ch = send_.get();
 				send_stall_ = false;
 				SAUtx::SDR_L = ch;
-				intr::enable(SAUtx::get_peripheral());
+				intr::enable<SAUtx::get_peripheral()>();
 			}
 		}
 
@@ -106,7 +109,7 @@ namespace device {
 			if(send_.length()) {
 				SAUtx::SDR_L = send_.get();
 			} else {
-				intr::enable(SAUtx::get_peripheral(), false);
+				intr::enable<SAUtx::get_peripheral()>(false);
 				send_stall_ = true;
 			}
 		}
@@ -117,9 +120,10 @@ namespace device {
 			@brief  受信割り込み
 		*/
 		//-----------------------------------------------------------------//
-		static void recv_task() noexcept __attribute__ ((section (".lowtext")))
+		static void recv_task() noexcept RAMTEXT_FUNC
 		{
 			recv_.put(SAUrx::SDR_L());
+			rtask_();
 		}
 
 
@@ -229,9 +233,9 @@ namespace device {
 				--level;
 				level ^= 0x03;
 				// 送信側優先順位
-				intr::set_level(SAUtx::get_peripheral(), level);
-				intr::set_level(SAUrx::get_peripheral(), level);
-				intr::enable(SAUrx::get_peripheral());
+				intr::set_level<SAUtx::get_peripheral()>(level);
+				intr::set_level<SAUrx::get_peripheral()>(level);
+				intr::enable<SAUrx::get_peripheral()>();
 			}
 
 			return true;
@@ -339,13 +343,16 @@ namespace device {
 		}
 	};
 
-	// send_、recv_, send_stall_ の実体を定義
-	template<class SAUtx, class SAUrx, class BUFtx, class BUFrx>
-		BUFtx uart_io<SAUtx, SAUrx, BUFtx, BUFrx>::send_;
+	// send_、recv_, rtask_, send_stall_ の実体を定義
+	template<class SAUtx, class SAUrx, class BUFtx, class BUFrx, class RTASK>
+		BUFtx uart_io<SAUtx, SAUrx, BUFtx, BUFrx, RTASK>::send_;
 
-	template<class SAUtx, class SAUrx, class BUFtx, class BUFrx>
-		BUFrx uart_io<SAUtx, SAUrx, BUFtx, BUFrx>::recv_;
+	template<class SAUtx, class SAUrx, class BUFtx, class BUFrx, class RTASK>
+		BUFrx uart_io<SAUtx, SAUrx, BUFtx, BUFrx, RTASK>::recv_;
 
-	template<class SAUtx, class SAUrx, class BUFtx, class BUFrx>
-		volatile bool uart_io<SAUtx, SAUrx, BUFtx, BUFrx>::send_stall_ = true; 
+	template<class SAUtx, class SAUrx, class BUFtx, class BUFrx, class RTASK>
+		RTASK uart_io<SAUtx, SAUrx, BUFtx, BUFrx, RTASK>::rtask_;
+
+	template<class SAUtx, class SAUrx, class BUFtx, class BUFrx, class RTASK>
+		volatile bool uart_io<SAUtx, SAUrx, BUFtx, BUFrx, RTASK>::send_stall_ = true; 
 }
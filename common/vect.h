@@ -10,7 +10,23 @@
 //=====================================================================//
 #include <stdint.h>
 
-#define INTERRUPT_FUNC __attribute__ ((interrupt))
+/// ホスト（テスト、ベンチマーク）でコンパイルする場合、割り込み属性は付けない。
+#ifdef __RL78__
+#  define INTERRUPT_FUNC __attribute__ ((interrupt))
+#else
+#  define INTERRUPT_FUNC
+#endif
+
+/// RAM で実行する関数（.ramtext、start.s で RAM にコピーする） @n
+/// 関数ポインターは１６ビットなので、アドレスを取る関数（割り込みベクターに @n
+/// 置く関数など）には使えない、直接呼ぶ関数だけに使う。 @n
+/// RAM の少ないデバイス（R5F100LC、LE）では、ROM（.lowtext）に置かれる。 @n
+/// NO_RAMTEXT を定義すると、通常の関数になる（比較用）。
+#if defined(NO_RAMTEXT) || !defined(__RL78__)
+#  define RAMTEXT_FUNC
+#else
+#  define RAMTEXT_FUNC __attribute__ ((section (".ramtext"), noinline))
+#endif
 
 #ifdef __cplusplus
 extern "C" {
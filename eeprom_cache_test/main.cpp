@@ -0,0 +1,370 @@
+//=====================================================================//
+/*!	@file
+	@brief	EEPROM_cache のテスト（ホスト用） @n
+			24FC1025（128K バイト、A2 端子がバンク・セレクト、２バイト・ @n
+			アドレス）の I2C モデルで、書き込みサイクル中は ACK を返さず、 @n
+			ページ書き込みは、ページ内で折り返す。 @n
+			・ページを跨ぐライン（デバイスのページより大きいライン） @n
+			・ACK ポーリングのタイムアウトと、その後の再書き込み @n
+			・書き込みサイクル中の、同じバイトへの書き換え @n
+			・データの NACK（書き込み失敗）と、その後の再書き込み @n
+			・ランダムな読み書きと service() を、参照メモリーと比較 @n
+			eeprom_cache_test [回数]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include "chip/EEPROM.hpp"
+
+namespace {
+
+	static constexpr uint32_t SIZE = 128 * 1024;
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	24FC1025 の I2C モデル
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct i2c_sim {
+		uint8_t		mem_[SIZE];
+		uint16_t	page_;		///< ページ・サイズ
+		uint32_t	ptr_;		///< 読み出しアドレス
+		uint16_t	busy_;		///< 書き込みサイクルの残り（NACK の回数）
+		uint16_t	cycle_;		///< 書き込みサイクルの長さ
+		bool		hold_;		///< 書き込みサイクルを終わらせない
+		bool		fail_;		///< 次の書き込みのデータに NACK を返す
+		uint32_t	write_;		///< ページ書き込みの回数
+		uint32_t	wrap_;		///< ページ内で折り返した書き込みの回数
+		uint32_t	nack_;
+
+		i2c_sim() : page_(128), ptr_(0), busy_(0), cycle_(5), hold_(false), fail_(false),
+			write_(0), wrap_(0), nack_(0) {
+			memset(mem_, 0xff, SIZE);
+		}
+
+		// デバイス・アドレス（ID0）と、書き込みサイクル中の NACK
+		bool select_(uint8_t adr, uint32_t& bank) {
+			if((adr & ~4) != 0x50) return false;
+			bank = (adr & 4) != 0 ? 0x10000 : 0;
+			if(busy_ > 0) {
+				if(!hold_) --busy_;
+				++nack_;
+				return false;
+			}
+			return true;
+		}
+
+		// ACK ポーリング、読み出しアドレスの設定
+		bool send(uint8_t adr, const void* src, uint8_t len) {
+			uint32_t bank;
+			if(!select_(adr, bank)) return false;
+			if(len == 0) return true;
+			if(len != 2) return false;
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			ptr_ = bank | (static_cast<uint32_t>(p[0]) << 8) | p[1];
+			return true;
+		}
+
+		// １バイト・アドレスのデバイスでは無い
+		bool send(uint8_t adr, uint8_t first, const void* src, uint8_t len) {
+			return false;
+		}
+
+		// ページ書き込み（ページ内で折り返す）
+		bool send(uint8_t adr, uint8_t first, uint8_t second, const void* src, uint8_t len) {
+			uint32_t bank;
+			if(!select_(adr, bank)) return false;
+			if(fail_) {
+				fail_ = false;
+				return false;
+			}
+			uint32_t a = bank | (static_cast<uint32_t>(first) << 8) | second;
+			uint32_t top = a & ~static_cast<uint32_t>(page_ - 1);
+			if(((a & (page_ - 1)) + len) > page_) ++wrap_;
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			for(uint8_t i = 0; i < len; ++i) {
+				mem_[top | ((a + i) & (page_ - 1))] = p[i];
+			}
+			++write_;
+			busy_ = cycle_;
+			return true;
+		}
+
+		// 順次読み出し（バンク内で折り返す）
+		bool recv(uint8_t adr, void* dst, uint8_t len) {
+			uint32_t bank;
+			if(!select_(adr, bank)) return false;
+			uint8_t* p = static_cast<uint8_t*>(dst);
+			for(uint8_t i = 0; i < len; ++i) {
+				p[i] = mem_[ptr_];
+				ptr_ = (ptr_ & 0x10000) | ((ptr_ + 1) & 0xffff);
+			}
+			return true;
+		}
+	};
+
+	typedef chip::EEPROM<i2c_sim> EEP;
+
+#define CHECK(cond, msg) if(!(cond)) { printf("NG: %s (line %d)\n", msg, __LINE__); return false; }
+
+	i2c_sim		i2c_;
+	EEP			eep_(i2c_);
+	uint8_t		ref_[SIZE];
+
+	void reset_(uint16_t page)
+	{
+		i2c_ = i2c_sim();
+		i2c_.page_ = page;
+		eep_.start(EEP::M128KB::ID0, page);
+		memset(ref_, 0xff, SIZE);
+	}
+
+	template <class CACHE>
+	bool write_(CACHE& cache, uint32_t adr, uint16_t len, bool retry = false)
+	{
+		uint8_t tmp[256];
+		for(uint16_t i = 0; i < len; ++i) tmp[i] = rand();
+		if(!cache.write(adr, tmp, len)) {
+			// 追い出しの失敗（途中のラインまでは書かれている）、同じ書き込みをやり直す
+			if(!retry) return false;
+			i2c_.hold_ = false;
+			i2c_.fail_ = false;
+			if(!cache.write(adr, tmp, len)) return false;
+		}
+		memcpy(&ref_[adr], tmp, len);
+		return true;
+	}
+
+	template <class CACHE>
+	void idle_(CACHE& cache, uint16_t n = 1000)
+	{
+		for(uint16_t i = 0; i < n && cache.is_busy(); ++i) {
+			cache.service();
+		}
+	}
+
+	bool device_(uint32_t org, uint32_t len)
+	{
+		for(uint32_t i = org; i < (org + len); ++i) {
+			if(i2c_.mem_[i] != ref_[i]) {
+				printf("device 0x%05X: %02X, expect %02X\n", i, i2c_.mem_[i], ref_[i]);
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// デバイスのページ（16 バイト）より大きいライン、ラインを跨ぐ書き込み
+	bool test_page_()
+	{
+		reset_(16);
+		chip::EEPROM_cache<EEP, 64, 8> cache(eep_);
+		CHECK(write_(cache, 0x1000, 64), "write");
+		CHECK(write_(cache, 0x1070, 0x20), "write across lines");
+		CHECK(write_(cache, 0xfff8, 16), "write across banks");
+		// service() は、書き込みサイクルを待たない（１回に１ページ）
+		for(uint16_t i = 0; i < 1000 && cache.is_busy(); ++i) {
+			uint32_t w = i2c_.write_;
+			cache.service();
+			CHECK(i2c_.write_ <= (w + 1), "service blocked");
+		}
+		CHECK(!cache.is_busy() && !cache.get_error(), "service");
+		CHECK(i2c_.wrap_ == 0, "page wrap");
+		CHECK(i2c_.write_ == (4 + 2 + 2), "page writes");
+		CHECK(device_(0xff00, 0x300) && device_(0x1000, 0x100), "data");
+
+		// 値が変わらないバイトは書かない
+		uint32_t w = i2c_.write_;
+		uint8_t tmp[64];
+		memcpy(tmp, &ref_[0x1000], 64);
+		CHECK(cache.write(0x1000, tmp, 64), "same value");
+		idle_(cache);
+		CHECK(i2c_.write_ == w, "same value written");
+
+		// 24FC1025 のページ（128 バイト）と同じライン
+		reset_(128);
+		chip::EEPROM_cache<EEP, 128, 2> big(eep_);
+		CHECK(write_(big, 0x1ff80, 128), "write 128");
+		idle_(big);
+		CHECK(i2c_.wrap_ == 0 && i2c_.write_ == 1 && device_(0x1ff00, 0x100), "line 128");
+		printf("page: OK\n");
+		return true;
+	}
+
+
+	// ACK ポーリングのタイムアウト、その後の再書き込み
+	bool test_timeout_()
+	{
+		reset_(128);
+		chip::EEPROM_cache<EEP, 32, 4> cache(eep_);
+		cache.set_timeout(20);
+		CHECK(write_(cache, 0x200, 32), "write");
+		i2c_.hold_ = true;
+		cache.service();
+		CHECK(i2c_.write_ == 1, "send");
+		for(uint8_t i = 0; i < 30; ++i) cache.service();
+		CHECK(cache.get_error(), "no timeout");
+		CHECK(cache.get_pending() == 1, "dirty lost on timeout");
+
+		// 書き込みサイクル中は、書き込みに失敗しても、データは残る
+		for(uint8_t i = 0; i < 30; ++i) cache.service();
+		CHECK(cache.get_pending() == 1, "dirty lost on busy device");
+
+		i2c_.hold_ = false;
+		idle_(cache);
+		CHECK(!cache.is_busy(), "retry");
+		CHECK(device_(0x200, 32), "data after retry");
+		CHECK(cache.flush() && !cache.get_error(), "flush clears error");
+
+		// flush() の中のタイムアウト（sync_write）
+		CHECK(write_(cache, 0x300, 8), "write");
+		cache.service();
+		i2c_.hold_ = true;
+		CHECK(!cache.flush(), "flush timeout");
+		CHECK(cache.get_pending() == 1, "dirty lost in flush");
+		i2c_.hold_ = false;
+		CHECK(cache.flush(), "flush");
+		CHECK(device_(0x200, 0x200), "data after flush");
+		printf("timeout: OK\n");
+		return true;
+	}
+
+
+	// 書き込みサイクル中の書き換えは、もう一度書く
+	bool test_inflight_()
+	{
+		reset_(128);
+		chip::EEPROM_cache<EEP, 32, 4> cache(eep_);
+		CHECK(write_(cache, 0x400, 32), "write");
+		cache.service();
+		CHECK(i2c_.busy_ > 0, "not in flight");
+		// 書き込み中のバイトと、書き込み中では無いバイト
+		CHECK(write_(cache, 0x408, 4), "rewrite");
+		CHECK(write_(cache, 0x41f, 1), "rewrite");
+		idle_(cache);
+		CHECK(!cache.is_busy() && !cache.get_error(), "service");
+		CHECK(i2c_.write_ == 2, "rewrite count");
+		CHECK(device_(0x400, 32), "rewrite lost");
+
+		// 読み出しは、書き込み待ちのデータを返す
+		CHECK(write_(cache, 0x410, 4), "write");
+		cache.service();
+		CHECK(write_(cache, 0x411, 2), "rewrite");
+		uint8_t tmp[32];
+		CHECK(cache.read(0x400, tmp, 32), "read");
+		CHECK(memcmp(tmp, &ref_[0x400], 32) == 0, "read pending");
+		CHECK(cache.flush(), "flush");
+		CHECK(device_(0x400, 32), "data");
+		printf("in flight: OK\n");
+		return true;
+	}
+
+
+	// データの NACK
+	bool test_fail_()
+	{
+		reset_(128);
+		chip::EEPROM_cache<EEP, 32, 4> cache(eep_);
+		CHECK(write_(cache, 0x800, 20), "write");
+		i2c_.fail_ = true;
+		cache.service();
+		CHECK(cache.get_error() && cache.get_pending() == 1, "write fail");
+		idle_(cache);
+		CHECK(!cache.is_busy() && device_(0x800, 32), "retry");
+		printf("write fail: OK\n");
+		return true;
+	}
+
+
+	// ランダムな読み書き、ライン数より多い領域（追い出しを含む）
+	bool test_random_(uint32_t loop)
+	{
+		reset_(128);
+		chip::EEPROM_cache<EEP, 32, 4> cache(eep_);
+		cache.set_timeout(8);
+		static const uint32_t area[] = { 0x0000, 0x0f80, 0xff00, 0x1ff00 };
+		uint32_t rd = 0;
+		for(uint32_t n = 0; n < loop; ++n) {
+			uint32_t adr = area[rand() % 4] + (rand() % 0x180);
+			if(adr >= SIZE) adr = SIZE - 1;
+			uint16_t len = 1 + (rand() % 80);
+			if((adr + len) > SIZE) len = SIZE - adr;
+			switch(rand() % 8) {
+			case 0:
+			case 1:
+			case 2:
+				if(!write_(cache, adr, len, true)) {
+					printf("write #%u: NG\n", n);
+					return false;
+				}
+				break;
+			case 3:
+			case 4:
+				{
+					uint8_t tmp[80];
+					if(!cache.read(adr, tmp, len)) {
+						// デバイスが書き込みサイクルを終えない間の読み出しは失敗する
+						if(!i2c_.hold_) {
+							printf("read #%u: NG\n", n);
+							return false;
+						}
+						break;
+					}
+					if(memcmp(tmp, &ref_[adr], len) != 0) {
+						printf("read #%u at 0x%05X: NG\n", n, adr);
+						return false;
+					}
+					++rd;
+				}
+				break;
+			case 5:
+				if((rand() % 16) == 0) i2c_.hold_ = !i2c_.hold_;
+				if((rand() % 32) == 0) i2c_.fail_ = true;
+				break;
+			default:
+				for(uint8_t i = rand() % 8; i > 0; --i) cache.service();
+				break;
+			}
+			// 書き込みサイクルが終わらない間は、ラインの追い出しが失敗する
+			if(i2c_.hold_ && (rand() % 4) == 0) i2c_.hold_ = false;
+		}
+		i2c_.hold_ = false;
+		i2c_.fail_ = false;
+		CHECK(cache.flush(), "flush");
+		CHECK(i2c_.wrap_ == 0, "page wrap");
+		for(uint32_t a : area) {
+			CHECK(device_(a, 0x180 + 80 < SIZE - a ? 0x180 + 80 : SIZE - a), "data");
+		}
+		printf("random: %u ops, %u reads, %u page writes, %u NACK OK\n",
+			loop, rd, i2c_.write_, i2c_.nack_);
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t loop = 200000;
+	if(argc >= 2) loop = strtoul(argv[1], nullptr, 10);
+
+	srand(1);
+	bool ok = true;
+	ok = test_page_() && ok;
+	ok = test_timeout_() && ok;
+	ok = test_inflight_() && ok;
+	ok = test_fail_() && ok;
+	ok = test_random_(loop) && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK\n");
+	return 0;
+}
@@ -12,6 +12,7 @@
 #include "G13/port.hpp"
 #include "common/csi_io.hpp"
 #include "common/delay.hpp"
+#include "common/pt.hpp"
 #include "ff12a/src/diskio.h"
 #include "ff12a/src/ff.h"
 #include "common/format.hpp"
@@ -33,6 +34,11 @@ namespace fatfs {
 		DSTATUS Stat_ = STA_NOINIT;	// Disk status
 		BYTE CardType_ = 0;			// b0:MMC, b1:SDv1, b2:SDv2, b3:Block addressing
 
+		// コルーチン用
+		utils::pt	sub_;
+		utils::deadline	dl_;
+		bool		ready_ = false;
+
 		// MMC/SD command (SPI mode)
 		enum class command : uint8_t {
 			CMD0 = 0,			/* GO_IDLE_STATE */
@@ -58,16 +64,38 @@ namespace fatfs {
 			CMD58 = 58,			/* READ_OCR */
 		};
 
-		/* 1:OK, 0:Timeout */
-		int wait_ready_() {
+		// 準備完了を１バイト読んで確認（完了、タイムアウトなら「true」）
+		bool poll_ready_() {
 			BYTE d;
-			UINT tmr;
-			for (tmr = 5000; tmr; tmr--) {	/* Wait for ready in timeout of 500ms */
-				csi_.recv(&d, 1);
-				if (d == 0xFF) break;
-				utils::delay::micro_second(100);
+			csi_.recv(&d, 1);
+			if (d == 0xFF) {
+				ready_ = true;
+				return true;
 			}
-			return tmr ? 1 : 0;
+			if (dl_.expired(100)) {
+				ready_ = false;
+				return true;
+			}
+			return false;
+		}
+
+
+		// 準備完了待ち（コルーチン、呼ばれる度に１バイト読む）
+		utils::pt_state wait_ready_pt_(utils::pt& pt) {
+			PT_BEGIN(pt);
+			dl_.start(500000);	/* Wait for ready in timeout of 500ms */
+			PT_WAIT_UNTIL(pt, poll_ready_());
+			if (!ready_) PT_EXIT(pt);
+			PT_END(pt);
+		}
+
+
+		/* 1:OK, 0:Timeout */
+		int wait_ready_() {
+			utils::pt pt;
+			utils::pt_state st;
+			while (utils::pt_alive(st = wait_ready_pt_(pt))) ;
+			return st == utils::pt_state::ENDED;
 		}
 
 
@@ -95,12 +123,11 @@ namespace fatfs {
 		int rcvr_datablock_ (BYTE *buff, UINT btr)
 		{
 			BYTE d[2];
-			UINT tmr;
-			for (tmr = 1000; tmr; tmr--) {	/* Wait for data packet in timeout of 100ms */
+			utils::deadline dl(100000);	/* Wait for data packet in timeout of 100ms */
+			do {
 				csi_.recv(d, 1);
 				if (d[0] != 0xFF) break;
-				utils::delay::micro_second(100);
-			}
+			} while (!dl.expired(100)) ;
 			if (d[0] != 0xFE) return 0;		/* If not valid data token, return with error */
 
 			csi_.recv(buff, btr);			/* Receive the data block into buffer */
@@ -356,6 +383,33 @@ namespace fatfs {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み完了待ち（コルーチン） @n
+					disk_write() の後、カードは内部で書き込み中（最大 500ms）で、 @n
+					次のコマンドの前に待つ。この待ちをメインループで進め、 @n
+					終わってから FatFs を呼べば、その待ちでブロックしない。 @n
+					待ちの間は、FatFs（このドライバー）を呼ばない事。
+			@param[in]	pt	コルーチンの状態
+			@return 待ち中なら WAITING、準備完了で ENDED、タイムアウトなら EXITED
+		 */
+		//-----------------------------------------------------------------//
+		utils::pt_state sync_pt(utils::pt& pt)
+		{
+			PT_BEGIN(pt);
+			if (Stat_ & STA_NOINIT) PT_EXIT(pt);
+			PORT::P = 0;
+			{
+				BYTE d;
+				csi_.recv(&d, 1);	/* Dummy clock (force DO enabled) */
+			}
+			PT_SPAWN(pt, sub_, wait_ready_pt_(sub_));
+			deselect_();
+			if (!ready_) PT_EXIT(pt);
+			PT_END(pt);
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	I/O コントロール
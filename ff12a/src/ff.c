@@ -4223,6 +4223,28 @@ FRESULT f_readdir (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Set Read Offset of the Directory (RL78 extension)                     */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_seekdir (
+	DIR* dp,			/* Pointer to the open directory object */
+	DWORD ofs			/* Offset of the directory table (value of f_telldir) */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+
+
+	res = validate(dp, &fs);	/* Check validity of the object */
+	if (res == FR_OK) {
+		res = dir_sdi(dp, ofs);		/* Goto the entry */
+	}
+	LEAVE_FF(fs, res);
+}
+
+
+
 #if _USE_FIND
 /*-----------------------------------------------------------------------*/
 /* Find Next File                                                        */
@@ -43,8 +43,11 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
+#ifndef _USE_FASTSEEK
 #define	_USE_FASTSEEK	0
-/* This option switches fast seek function. (0:Disable or 1:Enable) */
+#endif
+/* This option switches fast seek function. (0:Disable or 1:Enable)
+/  The project can enable it with USER_DEFS (_USE_FASTSEEK=1). */
 
 
 #define	_USE_EXPAND		0
@@ -0,0 +1,368 @@
+//=====================================================================//
+/*!	@file
+	@brief	flash_kvs の電源断テスト（ホスト用） @n
+			データ・フラッシュのモデル（書き込みはバイト単位で 1 -> 0 のみ、 @n
+			消去はブロック単位）で、指定した操作数の後に電源を切る。 @n
+			電源断した書き込みは、その途中のバイトが中途半端な値になり、 @n
+			消去は、ブロック内のバイトが、ばらばらに消去された状態になる。 @n
+			再起動（start）後に、全てのキーが、最後に書いた値か、書き込み中 @n
+			だった値である事、消去回数が実際の消去回数より小さくならない事、 @n
+			消去されていないバイトに書き込まない事を検査する。 @n
+			・ローテーションを含む書き込みの、全ての操作位置で電源断 @n
+			  （さらに、修復中にも電源断） @n
+			・ランダムな位置での電源断を繰り返す、長時間の書き込み @n
+			flash_kvs_test [電源断の回数]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include "common/flash_kvs.hpp"
+
+namespace {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	電源断を入れられるデータ・フラッシュのモデル
+		@param[in]	BLOCKS	ブロック数
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t BLOCKS>
+	struct flash_sim {
+		static const uint16_t data_flash_block = 1024;
+		static const uint16_t SIZE = BLOCKS * data_flash_block;
+
+		uint8_t		mem_[SIZE];
+		uint32_t	erase_[BLOCKS];	///< 消去を始めた回数
+		int32_t		budget_;		///< 電源断までの操作数（負なら電源断しない）
+		bool		down_;
+		uint32_t	over_;			///< 消去されていないバイトへの書き込み数
+
+		flash_sim() : erase_(), budget_(-1), down_(false), over_(0) {
+			memset(mem_, 0xff, SIZE);
+		}
+
+		void power_on(int32_t budget) {
+			budget_ = budget;
+			down_ = false;
+		}
+
+		// 操作を一つ進める、電源断なら「false」
+		bool step_() {
+			if(budget_ < 0) return true;
+			if(budget_ == 0) {
+				down_ = true;
+				return false;
+			}
+			--budget_;
+			return true;
+		}
+
+		uint16_t size() const { return SIZE; }
+
+		bool erase(uint16_t org) {
+			if(down_ || org >= SIZE) return false;
+			uint16_t top = org & ~(data_flash_block - 1);
+			++erase_[top / data_flash_block];
+			if(!step_()) {
+				for(uint16_t i = 0; i < data_flash_block; ++i) {
+					switch(rand() & 3) {
+					case 0:
+					case 1:
+						mem_[top + i] = 0xff;
+						break;
+					case 2:
+						mem_[top + i] |= rand();
+						break;
+					default:
+						break;
+					}
+				}
+				return false;
+			}
+			memset(&mem_[top], 0xff, data_flash_block);
+			return true;
+		}
+
+		bool erase_check(uint16_t org, uint16_t len) {
+			if(down_ || (org + len) > SIZE) return false;
+			for(uint16_t i = 0; i < len; ++i) {
+				if(mem_[org + i] != 0xff) return false;
+			}
+			return true;
+		}
+
+		bool write(uint16_t org, const void* src, uint16_t len) {
+			if(down_ || (org + len) > SIZE) return false;
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			for(uint16_t i = 0; i < len; ++i) {
+				if(!step_()) {
+					mem_[org + i] &= p[i] | rand();
+					return false;
+				}
+				if(mem_[org + i] != 0xff) ++over_;
+				mem_[org + i] &= p[i];
+			}
+			return true;
+		}
+
+		bool read(uint16_t org, void* dst, uint16_t len) {
+			if(down_ || (org + len) > SIZE) return false;
+			memcpy(dst, &mem_[org], len);
+			return true;
+		}
+	};
+
+	static constexpr uint8_t KEYS = 8;
+	static constexpr uint8_t VMAX = 28;
+
+	struct value_t {
+		uint8_t	len;	///< 「0」は、無し
+		uint8_t	val[VMAX];
+
+		bool operator == (const value_t& t) const {
+			return len == t.len && memcmp(val, t.val, len) == 0;
+		}
+	};
+
+	void make_value_(value_t& v)
+	{
+		v.len = (rand() % 8) == 0 ? 0 : 1 + (rand() % VMAX);
+		for(uint8_t i = 0; i < v.len; ++i) v.val[i] = rand();
+	}
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	テスト・ベンチ（フラッシュと、キー毎の期待値）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <uint8_t BLOCKS>
+	struct bench {
+		typedef flash_sim<BLOCKS> SIM;
+		typedef utils::flash_kvs<KEYS, VMAX, SIM> KVS;
+
+		SIM			sim_;
+		value_t		ref_[KEYS];
+		bool		pend_;		///< 電源断した書き込みが有る
+		uint8_t		pend_key_;
+		value_t		pend_val_;
+		uint16_t	wear_[BLOCKS];
+		uint32_t	cuts_;
+
+		bench() : ref_(), pend_(false), pend_key_(0), pend_val_(), wear_(), cuts_(0) { }
+
+		// 起動して検査、電源断で止まったら「false」（err に NG を返す）
+		bool boot_(KVS& kvs, bool& err)
+		{
+			err = false;
+			if(!kvs.start()) {
+				if(sim_.down_) return false;
+				printf("start: NG\n");
+				err = true;
+				return false;
+			}
+
+			for(uint8_t k = 0; k < KEYS; ++k) {
+				value_t v;
+				v.len = kvs.read(k, v.val, VMAX);
+				if(v.len != 0 && !kvs.exist(k)) v.len = 0;
+				if(v == ref_[k]) continue;
+				if(pend_ && k == pend_key_ && v == pend_val_) {
+					ref_[k] = v;
+					continue;
+				}
+				printf("key %u: NG (len %u, expect %u)\n", k, v.len, ref_[k].len);
+				err = true;
+				return false;
+			}
+			pend_ = false;
+
+			for(uint8_t b = 0; b < BLOCKS; ++b) {
+				uint16_t w = kvs.get_wear(b);
+				// 消去回数は 0xffff で止まる
+				uint32_t e = sim_.erase_[b] < 0xffff ? sim_.erase_[b] : 0xffff;
+				if(w < e || w > (e + cuts_) || w < wear_[b]) {
+					printf("block %u: wear NG (%u, erase %u, last %u)\n", b, w,
+						sim_.erase_[b], wear_[b]);
+					err = true;
+					return false;
+				}
+				wear_[b] = w;
+			}
+			if(sim_.over_ != 0) {
+				printf("write to not erased byte: NG (%u)\n", sim_.over_);
+				err = true;
+				return false;
+			}
+			return true;
+		}
+
+		// 電源断まで（又は num 回）書き込む
+		bool run_(KVS& kvs, uint32_t num)
+		{
+			for(uint32_t i = 0; i < num; ++i) {
+				uint8_t k = rand() % KEYS;
+				value_t v;
+				make_value_(v);
+				if(kvs.write(k, v.val, v.len)) {
+					ref_[k] = v;
+					continue;
+				}
+				if(!sim_.down_) {
+					printf("write: NG\n");
+					return false;
+				}
+				pend_ = true;
+				pend_key_ = k;
+				pend_val_ = v;
+				return true;
+			}
+			return true;
+		}
+
+		// 電源断しなくなるまで、起動を繰り返す
+		bool recover_(int32_t budget)
+		{
+			bool err;
+			for(;;) {
+				KVS kvs(sim_);
+				sim_.power_on(budget);
+				if(boot_(kvs, err)) return true;
+				if(err) return false;
+				++cuts_;
+				budget = -1;
+			}
+		}
+
+		bool cycle_(int32_t budget, uint32_t num, int32_t budget2)
+		{
+			KVS kvs(sim_);
+			sim_.power_on(-1);
+			bool err;
+			if(!boot_(kvs, err)) return false;
+			sim_.power_on(budget);
+			if(!run_(kvs, num)) return false;
+			if(sim_.down_) ++cuts_;
+			return recover_(budget2);
+		}
+
+		// 実際の消去回数の差
+		uint32_t spread() const
+		{
+			uint32_t mi = sim_.erase_[0];
+			uint32_t ma = sim_.erase_[0];
+			for(uint8_t b = 1; b < BLOCKS; ++b) {
+				if(sim_.erase_[b] < mi) mi = sim_.erase_[b];
+				if(sim_.erase_[b] > ma) ma = sim_.erase_[b];
+			}
+			return ma - mi;
+		}
+	};
+
+
+	// ローテーションする書き込みの、全ての操作位置で電源断
+	template <uint8_t BLOCKS>
+	bool sweep_()
+	{
+		typedef bench<BLOCKS> BENCH;
+		static BENCH base;
+		srand(BLOCKS);
+		// 数回ローテーションして、アクティブ・ブロックを一杯近くにする
+		typename BENCH::KVS kvs(base.sim_);
+		if(!kvs.start()) return false;
+		uint16_t rot = 0;
+		while(rot < (BLOCKS + 1) || kvs.get_free() > 64) {
+			uint16_t f = kvs.get_free();
+			if(!base.run_(kvs, 1)) return false;
+			if(kvs.get_free() > f) ++rot;
+		}
+		for(uint8_t b = 0; b < BLOCKS; ++b) base.wear_[b] = kvs.get_wear(b);
+
+		static const int32_t second[] = { -1, 0, 1, 2, 3, 5, 9, 17, 33, 65 };
+		uint32_t cases = 0;
+		for(int32_t budget = 0; ; ++budget) {
+			static BENCH t;
+			t = base;
+			srand(budget);
+			t.cycle_(budget, 8, -1);
+			if(t.cuts_ == 0) break;  // 電源断せずに終わった
+
+			for(int32_t b2 : second) {
+				t = base;
+				srand(budget);
+				if(!t.cycle_(budget, 8, b2)) {
+					printf("%u blocks: NG at cut %d, %d\n", BLOCKS, budget, b2);
+					return false;
+				}
+				++cases;
+			}
+		}
+		printf("%u blocks: sweep OK (%u cases)\n", BLOCKS, cases);
+		return true;
+	}
+
+
+	// ランダムな位置での電源断を繰り返す
+	template <uint8_t BLOCKS>
+	bool random_(uint32_t loop)
+	{
+		typedef bench<BLOCKS> BENCH;
+		static BENCH t;
+		srand(100 + BLOCKS);
+		for(uint32_t i = 0; i < loop; ++i) {
+			int32_t budget = rand() % 4000;
+			int32_t b2 = (rand() & 3) == 0 ? rand() % 200 : -1;
+			if(!t.cycle_(budget, 1000, b2)) {
+				printf("%u blocks: NG at loop %u\n", BLOCKS, i);
+				return false;
+			}
+		}
+		// format の後は、全てのキーが無い
+		{
+			typename BENCH::KVS kvs(t.sim_);
+			t.sim_.power_on(-1);
+			bool err;
+			if(!t.boot_(kvs, err) || !kvs.format()) {
+				printf("%u blocks: format NG\n", BLOCKS);
+				return false;
+			}
+			for(uint8_t k = 0; k < KEYS; ++k) t.ref_[k].len = 0;
+			if(!t.recover_(-1)) return false;
+		}
+
+		uint32_t mi = t.sim_.erase_[0];
+		for(uint8_t b = 1; b < BLOCKS; ++b) {
+			if(t.sim_.erase_[b] < mi) mi = t.sim_.erase_[b];
+		}
+		printf("%u blocks: random OK (%u power cuts, erase %u - %u)\n",
+			BLOCKS, t.cuts_, mi, mi + t.spread());
+		// ブロックは順番に使われるので、消去回数は揃う（電源断で消去し直した分は、ずれる）
+		return t.spread() <= (2 + mi / 50);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t loop = 2000;
+	if(argc >= 2) loop = strtoul(argv[1], nullptr, 10);
+
+	bool ok = true;
+	ok = sweep_<2>() && ok;
+	ok = sweep_<4>() && ok;
+	ok = random_<2>(loop) && ok;
+	ok = random_<4>(loop) && ok;
+	ok = random_<8>(loop) && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK\n");
+	return 0;
+}
@@ -0,0 +1,285 @@
+//=====================================================================//
+/*!	@file
+	@brief	MPU6050 の FIFO 読み出しと、imu_filter のテスト（ホスト用） @n
+			既知の姿勢の動き（ロール、ピッチ）から、加速度、ジャイロの @n
+			サンプル列（ノイズ、ジャイロのオフセットを含む）を作り、 @n
+			MPU6050 のレジスタ・モデルの FIFO に積む。 @n
+			ドライバーの read_fifo で読み出したサンプルで imu_filter を更新し、 @n
+			同じ式の浮動小数点版（double）と、真の姿勢との差を検査する。 @n
+			imu_test
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <random>
+#include "chip/MPU6050.hpp"
+#include "common/imu_filter.hpp"
+
+namespace {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	MPU6050 レジスタ・モデル（FIFO を含む）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct i2c_model {
+		uint8_t		reg_[128];
+		uint8_t		ptr_;
+		uint8_t		fifo_[2048];
+		uint16_t	get_;
+		uint16_t	put_;
+		uint32_t	trans_;
+		uint32_t	reset_;
+
+		i2c_model() : reg_{ 0 }, ptr_(0), get_(0), put_(0), trans_(0), reset_(0) {
+			reg_[0x75] = 0x68;  // WHO_AM_I
+		}
+
+		uint16_t count() const { return (put_ - get_) & (sizeof(fifo_) - 1); }
+
+		void push(const int16_t* v, uint8_t n) {
+			for(uint8_t i = 0; i < n; ++i) {
+				fifo_[put_] = v[i] >> 8;
+				put_ = (put_ + 1) & (sizeof(fifo_) - 1);
+				fifo_[put_] = v[i];
+				put_ = (put_ + 1) & (sizeof(fifo_) - 1);
+			}
+		}
+
+		bool send(uint8_t adr, const uint8_t* src, uint8_t len) {
+			++trans_;
+			ptr_ = src[0];
+			for(uint8_t i = 1; i < len; ++i) {
+				reg_[ptr_] = src[i];
+				if(ptr_ == 0x6A && (src[i] & 0x04)) {  // USER_CTRL: FIFO_RESET
+					get_ = put_;
+					++reset_;
+				}
+				++ptr_;
+			}
+			return true;
+		}
+
+		bool recv(uint8_t adr, uint8_t* dst, uint8_t len) {
+			++trans_;
+			for(uint8_t i = 0; i < len; ++i) {
+				if(ptr_ == 0x74) {  // FIFO_R_W（アドレスは進まない）
+					dst[i] = fifo_[get_];
+					get_ = (get_ + 1) & (sizeof(fifo_) - 1);
+					continue;
+				}
+				uint16_t cnt = count();
+				if(ptr_ == 0x72) dst[i] = cnt >> 8;
+				else if(ptr_ == 0x73) dst[i] = cnt;
+				else dst[i] = reg_[ptr_];
+				++ptr_;
+			}
+			return true;
+		}
+	};
+
+	typedef chip::MPU6050<i2c_model> MPU;
+
+	static constexpr uint16_t RATE = 100;		///< サンプリング周波数 [Hz]
+	static constexpr double G_LSB = 16384.0;	///< 加速度 ±2g
+	static constexpr double GYRO_LSB = 131.0;	///< ジャイロ ±250 deg/s
+	static constexpr double PI = 3.14159265358979323846;
+
+	// 真の姿勢 [度]（ゆっくりした傾きと、速い揺れ）
+	void attitude_(double t, double& roll, double& pitch, double& droll, double& dpitch)
+	{
+		roll  = 40.0 * std::sin(2.0 * PI * 0.2 * t) + 5.0 * std::sin(2.0 * PI * 3.0 * t);
+		droll = 40.0 * 2.0 * PI * 0.2 * std::cos(2.0 * PI * 0.2 * t)
+			+ 5.0 * 2.0 * PI * 3.0 * std::cos(2.0 * PI * 3.0 * t);
+		pitch  = 25.0 * std::sin(2.0 * PI * 0.13 * t + 1.0);
+		dpitch = 25.0 * 2.0 * PI * 0.13 * std::cos(2.0 * PI * 0.13 * t + 1.0);
+	}
+
+	int16_t sat_(double v)
+	{
+		v = std::floor(v + 0.5);
+		if(v > 32767.0) return 32767;
+		if(v < -32768.0) return -32768;
+		return static_cast<int16_t>(v);
+	}
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	相補フィルター（double、imu_filter と同じ式）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct ref_filter {
+		double	roll;
+		double	pitch;
+		bool	init;
+
+		ref_filter() : roll(0.0), pitch(0.0), init(false) { }
+
+		void update(const MPU::frame_t& f, int16_t bx, int16_t by) {
+			double ar = std::atan2(f.accel.y, f.accel.z) * 180.0 / PI;
+			double ap = std::atan2(-f.accel.x, std::sqrt(static_cast<double>(f.accel.y) * f.accel.y
+				+ static_cast<double>(f.accel.z) * f.accel.z)) * 180.0 / PI;
+			if(!init) {
+				roll = ar;
+				pitch = ap;
+				init = true;
+				return;
+			}
+			roll  += (f.gyro.x - bx) / GYRO_LSB / RATE;
+			pitch += (f.gyro.y - by) / GYRO_LSB / RATE;
+			roll  += (ar - roll) / 32.0;
+			pitch += (ap - pitch) / 32.0;
+		}
+	};
+
+
+	bool test_atan2_()
+	{
+		double err = 0.0;
+		for(int32_t i = 0; i < 200000; ++i) {
+			int32_t y = (rand() % 262143) - 131071;
+			int32_t x = (rand() % 262143) - 131071;
+			double ref = std::atan2(y, x) * 18000.0 / PI;
+			double d = std::fabs(utils::imu_filter<>::atan2(y, x) - ref);
+			if(d > 18000.0) d = 36000.0 - d;
+			if(d > err) err = d;
+		}
+		for(uint32_t n = 0; n < 1000000; n += 7) {
+			uint32_t r = utils::imu_filter<>::isqrt(n);
+			if(r * r > n || (r + 1) * (r + 1) <= n) {
+				printf("isqrt NG: %u -> %u\n", n, r);
+				return false;
+			}
+		}
+		printf("atan2: max %.1f (0.01 deg), isqrt: OK\n", err);
+		return err <= 2.0;
+	}
+
+
+	bool test_filter_(uint16_t sec)
+	{
+		i2c_model m;
+		MPU mpu(m);
+		if(!mpu.start()) {
+			printf("MPU6050: start NG\n");
+			return false;
+		}
+		mpu.start_fifo(RATE);
+
+		utils::imu_filter<> imu;
+		imu.start(RATE, mpu.get_gyro_sens10());
+		static constexpr int16_t BIAS_X = -37;
+		static constexpr int16_t BIAS_Y = 22;
+		imu.set_gyro_bias(BIAS_X, BIAS_Y);
+		ref_filter ref;
+
+		std::mt19937 gen(1);
+		std::normal_distribution<double> acc_noise(0.0, 40.0);	// 約 2.4 mg
+		std::normal_distribution<double> gyro_noise(0.0, 6.0);	// 約 0.05 deg/s
+
+		double e_ref = 0.0;
+		double e_true = 0.0;
+		double e2_true = 0.0;
+		uint32_t num = 0;
+		uint32_t frames = 0;
+		uint32_t burst = 0;
+		uint32_t n = static_cast<uint32_t>(sec) * RATE;
+		for(uint32_t i = 0; i < n; ++i) {
+			double t = static_cast<double>(i) / RATE;
+			double r, p, dr, dp;
+			attitude_(t, r, p, dr, dp);
+			double rr = r * PI / 180.0;
+			double pr = p * PI / 180.0;
+			int16_t v[6];
+			v[0] = sat_(-std::sin(pr) * G_LSB + acc_noise(gen));
+			v[1] = sat_(std::sin(rr) * std::cos(pr) * G_LSB + acc_noise(gen));
+			v[2] = sat_(std::cos(rr) * std::cos(pr) * G_LSB + acc_noise(gen));
+			v[3] = sat_(dr * GYRO_LSB + BIAS_X + gyro_noise(gen));
+			v[4] = sat_(dp * GYRO_LSB + BIAS_Y + gyro_noise(gen));
+			v[5] = sat_(gyro_noise(gen));
+			m.push(v, 6);
+
+			// メイン・ループが 1/3 の頻度で、まとめて読む
+			if((i % 3) != 2) continue;
+
+			MPU::frame_t fr[8];
+			uint8_t fn = mpu.read_fifo(fr, 8);
+			++burst;
+			for(uint8_t j = 0; j < fn; ++j) {
+				const auto& f = fr[j];
+				imu.update(f.accel.x, f.accel.y, f.accel.z, f.gyro.x, f.gyro.y);
+				ref.update(f, BIAS_X, BIAS_Y);
+				++frames;
+				// 収束するまで（2 秒）は除く
+				if(frames < (2 * RATE)) continue;
+				double tt = static_cast<double>(frames - 1) / RATE;
+				double r0, p0, d0, d1;
+				attitude_(tt, r0, p0, d0, d1);
+				double er = std::fabs(imu.get_roll() / 100.0 - ref.roll);
+				double ep = std::fabs(imu.get_pitch() / 100.0 - ref.pitch);
+				if(er > e_ref) e_ref = er;
+				if(ep > e_ref) e_ref = ep;
+				double tr = std::fabs(imu.get_roll() / 100.0 - r0);
+				double tp = std::fabs(imu.get_pitch() / 100.0 - p0);
+				if(tr > e_true) e_true = tr;
+				if(tp > e_true) e_true = tp;
+				e2_true += tr * tr + tp * tp;
+				num += 2;
+			}
+		}
+		if(frames != n - (n % 3)) {
+			printf("MPU6050: frames lost: %u / %u\n", frames, n);
+			return false;
+		}
+		double rms = std::sqrt(e2_true / num);
+		printf("imu_filter: %u frames in %u bursts (%.1f transfers/frame)\n", frames, burst,
+			static_cast<double>(m.trans_) / frames);
+		printf("imu_filter: fixed vs double: max %.2f deg, fixed vs true: max %.2f deg, rms %.2f deg\n",
+			e_ref, e_true, rms);
+		return e_ref <= 0.1 && e_true <= 1.0 && rms <= 0.4;
+	}
+
+
+	// FIFO が溢れたら、リセットして「0」を返す
+	bool test_overflow_()
+	{
+		i2c_model m;
+		MPU mpu(m);
+		mpu.start();
+		mpu.start_fifo(RATE);
+		int16_t v[6] = { 0 };
+		for(uint16_t i = 0; i < (MPU::FIFO_SIZE / MPU::FRAME_SIZE + 1); ++i) m.push(v, 6);
+		uint32_t reset = m.reset_;
+		MPU::frame_t fr[8];
+		if(mpu.read_fifo(fr, 8) != 0 || m.reset_ != (reset + 1) || m.count() != 0) {
+			printf("MPU6050: overflow NG\n");
+			return false;
+		}
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint16_t sec = 120;
+	if(argc >= 2) sec = strtoul(argv[1], nullptr, 10);
+
+	srand(1);
+	bool ok = true;
+	ok = test_atan2_() && ok;
+	ok = test_overflow_() && ok;
+	ok = test_filter_(sec) && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK\n");
+	return 0;
+}
@@ -0,0 +1,355 @@
+//=====================================================================//
+/*!	@file
+	@brief	kfont12 のキャッシュ・テスト（ホスト用） @n
+			FatFS の f_open、f_lseek、f_read、f_close をメモリー上の @n
+			kfont12.bin で置き換え、monograph の draw_text で描画した結果を、 @n
+			ファイルから直接描画した物と比較する。 @n
+			また、ファイラーのスクロールを模した描画で、キャッシュのヒット率、 @n
+			ファイルのオープン、リード回数と、draw_text の時間を表示する。 @n
+			kfont_test [kfont12.bin]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include "common/font6x12.hpp"
+#include "common/kfont12.hpp"
+#include "common/monograph.hpp"
+
+// Unicode -> ShiftJIS の変換（ff_convert）
+#include "ff12a/src/option/cc932.c"
+
+namespace {
+
+	static constexpr uint8_t FONT_SIZE = 18;
+
+	uint8_t*	font_;
+	uint32_t	font_len_;
+
+	uint32_t	open_count_;
+	uint32_t	read_count_;
+
+	uint16_t sjis_to_liner_(uint16_t sjis)
+	{
+		uint16_t code;
+		uint8_t up = sjis >> 8;
+		uint8_t lo = sjis & 0xff;
+		if(0x81 <= up && up <= 0x9f) {
+			code = up - 0x81;
+		} else if(0xe0 <= up && up <= 0xef) {
+			code = (0x9f + 1 - 0x81) + up - 0xe0;
+		} else {
+			return 0xffff;
+		}
+		uint16_t loa = (0x7e + 1 - 0x40) + (0xfc + 1 - 0x80);
+		if(0x40 <= lo && lo <= 0x7e) {
+			code *= loa;
+			code += lo - 0x40;
+		} else if(0x80 <= lo && lo <= 0xfc) {
+			code *= loa;
+			code += 0x7e + 1 - 0x40;
+			code += lo - 0x80;
+		} else {
+			return 0xffff;
+		}
+		return code;
+	}
+}
+
+extern "C" {
+
+	FRESULT f_open(FIL* fp, const TCHAR* path, BYTE mode)
+	{
+		if(strcmp(path, "/kfont12.bin") != 0) return FR_NO_FILE;
+		++open_count_;
+		fp->fptr = 0;
+		fp->obj.objsize = font_len_;
+		fp->cltbl = nullptr;
+		return FR_OK;
+	}
+
+	FRESULT f_close(FIL* fp)
+	{
+		return FR_OK;
+	}
+
+	FRESULT f_lseek(FIL* fp, FSIZE_t ofs)
+	{
+		if(ofs == CREATE_LINKMAP) {
+			if(fp->cltbl == nullptr) return FR_INVALID_PARAMETER;
+			fp->cltbl[1] = 1;  // 断片化無し
+			return FR_OK;
+		}
+		if(ofs > fp->obj.objsize) ofs = fp->obj.objsize;
+		fp->fptr = ofs;
+		return FR_OK;
+	}
+
+	FRESULT f_read(FIL* fp, void* buff, UINT btr, UINT* br)
+	{
+		++read_count_;
+		uint32_t n = fp->obj.objsize - fp->fptr;
+		if(n > btr) n = btr;
+		memcpy(buff, &font_[fp->fptr], n);
+		fp->fptr += n;
+		*br = n;
+		return FR_OK;
+	}
+
+}
+
+namespace {
+
+	static constexpr uint16_t WIDTH = 128;
+	static constexpr uint16_t HEIGHT = 64;
+
+	typedef graphics::font6x12 AFONT;
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	参照用の漢字フォント（ファイルのイメージを直接返す）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct kfont_ref {
+		static const int8_t width = 12;
+		static const int8_t height = 12;
+		const uint8_t* get(uint16_t code) {
+			uint16_t lin = sjis_to_liner_(ff_convert(code, 0));
+			if(lin == 0xffff) return nullptr;
+			return &font_[static_cast<uint32_t>(lin) * FONT_SIZE];
+		}
+		void prefetch(const char* text) { }
+	};
+
+	// 先読み無し（描画時の get() だけで読む）
+	template <uint8_t CASH_SIZE>
+	struct kfont_nopf : public graphics::kfont12<CASH_SIZE> {
+		void prefetch(const char* text) { }
+	};
+
+	uint16_t	pool_[512];
+	uint16_t	pool_num_;
+
+	// ファイルに有る漢字を集める
+	void make_pool_()
+	{
+		pool_num_ = 0;
+		for(uint16_t code = 0x4e00; code < 0x9fa0; ++code) {
+			uint16_t lin = sjis_to_liner_(ff_convert(code, 0));
+			if(lin == 0xffff) continue;
+			if((static_cast<uint32_t>(lin) + 1) * FONT_SIZE > font_len_) continue;
+			if((rand() % 8) != 0) continue;
+			pool_[pool_num_] = code;
+			++pool_num_;
+			if(pool_num_ >= (sizeof(pool_) / sizeof(pool_[0]))) break;
+		}
+	}
+
+	char* put_utf8_(char* p, uint16_t code)
+	{
+		if(code < 0x80) {
+			*p++ = code;
+		} else if(code < 0x800) {
+			*p++ = 0xc0 | (code >> 6);
+			*p++ = 0x80 | (code & 0x3f);
+		} else {
+			*p++ = 0xe0 | (code >> 12);
+			*p++ = 0x80 | ((code >> 6) & 0x3f);
+			*p++ = 0x80 | (code & 0x3f);
+		}
+		return p;
+	}
+
+	// 漢字の出現頻度に偏りを付ける（先頭程良く使う）
+	uint16_t pick_(uint16_t n)
+	{
+		uint16_t a = rand() % n;
+		uint16_t b = rand() % n;
+		return pool_[a < b ? a : b];
+	}
+
+	void make_text_(char* text, uint16_t n, uint8_t len)
+	{
+		char* p = text;
+		for(uint8_t i = 0; i < len; ++i) {
+			if((rand() % 4) == 0) p = put_utf8_(p, 'A' + (rand() % 26));
+			else p = put_utf8_(p, pick_(n));
+		}
+		*p = 0;
+	}
+
+
+	template <uint8_t CASH_SIZE>
+	bool test_(uint32_t loop)
+	{
+		typedef graphics::kfont12<CASH_SIZE> KFONT;
+		static KFONT kfont;
+		static kfont_ref kref;
+		static graphics::monograph<WIDTH, HEIGHT, AFONT, KFONT> mono(kfont);
+		static graphics::monograph<WIDTH, HEIGHT, AFONT, kfont_ref> ref(kref);
+		kfont.set_mount(true);
+
+		char text[64];
+		for(uint32_t n = 0; n < loop; ++n) {
+			make_text_(text, pool_num_, 1 + (rand() % 12));
+			int16_t x = (rand() % 40) - 20;
+			int16_t y = (rand() % (HEIGHT + 20)) - 16;
+			mono.clear(0);
+			ref.clear(0);
+			mono.draw_text(x, y, text);
+			ref.draw_text(x, y, text);
+			if(memcmp(mono.fb(), ref.fb(), WIDTH * HEIGHT / 8) != 0) {
+				printf("cache %u: NG at #%u '%s'\n", CASH_SIZE, n, text);
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// ２ウェイ（１セット）で、age が一周しても LRU の順番が保たれるか
+	bool test_lru_()
+	{
+		graphics::kfont12<2> kfont;
+		kfont.set_mount(true);
+		uint16_t a = pool_[0];
+		uint16_t b = pool_[1];
+		uint16_t c = pool_[2];
+		for(uint16_t i = 0; i < 1000; ++i) {
+			kfont.get(a);
+			kfont.get(b);
+		}
+		kfont.get(a);
+		kfont.get(c);  // b を追い出す
+		kfont.reset_stat();
+		kfont.get(a);
+		kfont.get(c);
+		if(kfont.get_hit() != 2) {
+			printf("LRU: NG (hit %u)\n", kfont.get_hit());
+			return false;
+		}
+		return true;
+	}
+
+
+	// 先読みが、同じ文字列で使う文字を追い出さないか
+	bool test_prefetch_()
+	{
+		graphics::kfont12<2> kfont;
+		kfont.set_mount(true);
+		char text[16];
+		char* p = text;
+		p = put_utf8_(p, pool_[0]);
+		p = put_utf8_(p, pool_[1]);
+		p = put_utf8_(p, pool_[2]);
+		*p = 0;
+		read_count_ = 0;
+		kfont.prefetch(text);
+		kfont.get(pool_[0]);
+		kfont.get(pool_[1]);
+		kfont.get(pool_[2]);
+		if(read_count_ != 3 || kfont.get_hit() != 2) {
+			printf("prefetch: NG (read %u, hit %u)\n", read_count_, kfont.get_hit());
+			return false;
+		}
+		return true;
+	}
+
+
+	template <class KFONT>
+	void bench_(const char* name, uint16_t n)
+	{
+		static KFONT kfont;
+		static graphics::monograph<WIDTH, HEIGHT, AFONT, KFONT> mono(kfont);
+		kfont.set_mount(true);
+
+		// ファイラーのリスト（５行表示で、１行ずつスクロール）
+		static constexpr uint16_t LINES = 40;
+		static constexpr uint16_t DISP = 5;
+		static char list[LINES][64];
+		srand(2);
+		for(uint16_t i = 0; i < LINES; ++i) {
+			make_text_(list[i], n, 4 + (rand() % 6));
+		}
+
+		kfont.reset_stat();
+		open_count_ = 0;
+		read_count_ = 0;
+		uint32_t draw = 0;
+		auto st = std::chrono::steady_clock::now();
+		for(uint16_t loop = 0; loop < 20; ++loop) {
+			for(uint16_t top = 0; top < (LINES - DISP); ++top) {
+				mono.clear(0);
+				for(uint16_t i = 0; i < DISP; ++i) {
+					mono.draw_text(0, i * 12, list[top + i]);
+					++draw;
+				}
+			}
+		}
+		auto ed = std::chrono::steady_clock::now();
+		double us = std::chrono::duration<double, std::micro>(ed - st).count() / draw;
+		uint32_t all = kfont.get_hit() + kfont.get_miss();
+		printf("%-16s hit %5.1f %%, open %5.2f, read %5.2f /draw_text, %6.2f us/draw_text\n",
+			name, 100.0 * kfont.get_hit() / all,
+			static_cast<double>(open_count_) / draw,
+			static_cast<double>(read_count_) / draw, us);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	const char* path = "../common/kfont12.bin";
+	if(argc >= 2) path = argv[1];
+
+	FILE* fp = fopen(path, "rb");
+	if(fp == nullptr) {
+		printf("Can't open: '%s'\n", path);
+		return 1;
+	}
+	fseek(fp, 0, SEEK_END);
+	font_len_ = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	font_ = static_cast<uint8_t*>(malloc(font_len_));
+	if(fread(font_, 1, font_len_, fp) != font_len_) {
+		printf("Read error: '%s'\n", path);
+		fclose(fp);
+		return 1;
+	}
+	fclose(fp);
+
+	srand(1);
+	make_pool_();
+
+	bool ok = true;
+	ok = test_lru_() && ok;
+	ok = test_prefetch_() && ok;
+	ok = test_<2>(20000) && ok;
+	ok = test_<16>(20000) && ok;
+	ok = test_<32>(20000) && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK (%u kanji)\n", pool_num_);
+
+	// 使う漢字の種類（少ない、多い）
+	static const uint16_t kinds[] = { 40, 160 };
+	for(uint16_t n : kinds) {
+		printf("%u kanji:\n", n);
+		bench_<graphics::kfont12<16> >("cache 16", n);
+		bench_<kfont_nopf<16> >("cache 16 (no pf)", n);
+		bench_<graphics::kfont12<32> >("cache 32", n);
+		bench_<kfont_nopf<32> >("cache 32 (no pf)", n);
+	}
+
+	free(font_);
+
+	return 0;
+}
@@ -0,0 +1,541 @@
+//=====================================================================//
+/*!	@file
+	@brief	MCP2515 ドライバーのテスト（ホスト用） @n
+			SPI のレジスタ・モデル（命令、モード切り替え、受信フィルター、 @n
+			ロールオーバー、送信優先度、ループバック）に対して、 @n
+			ビット・タイミング、フィルター、受信リング、割り込みの保留、 @n
+			送信の優先順位を検査し、受信１フレームの SPI バイト数を表示する。 @n
+			mcp2515_test [フレーム数]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include "chip/MCP2515.hpp"
+
+namespace {
+
+	struct frame {
+		uint32_t	id;
+		bool		ext;
+		bool		rtr;
+		uint8_t		dlc;
+		uint8_t		data[8];
+	};
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	MCP2515 レジスタ・モデル @n
+				CS の立ち下がりから、最初のバイトを命令として解釈する。 @n
+				コンフィグレーション・モード以外での CNF、フィルター、 @n
+				マスクへの書き込み、CS が下がったままの選択は、bad_ に数える。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct mcp_model {
+		uint8_t		reg_[128];
+		bool		low_;		///< CS が「L」
+		uint8_t		cmd_;
+		uint8_t		adr_;
+		uint8_t		mask_;
+		uint8_t		pos_;		///< 命令からのバイト数
+		uint8_t		lag_;		///< モードが切り替わるまでの CANSTAT 読み出し回数
+		uint8_t		mode_;		///< 切り替え先のモード
+		uint32_t	bytes_;
+		uint32_t	bad_;
+		frame		sent_[16];
+		uint8_t		sent_num_;
+		uint32_t	hook_at_;	///< bytes_ がこの値になったら hook_ を呼ぶ
+		void		(*hook_)();
+
+		mcp_model() : reg_(), low_(false), cmd_(0), adr_(0), mask_(0), pos_(0),
+			lag_(0), mode_(0x80), bytes_(0), bad_(0), sent_(), sent_num_(0),
+			hook_at_(0), hook_(nullptr) {
+			reset_();
+		}
+
+		void reset_() {
+			memset(reg_, 0, sizeof(reg_));
+			reg_[0x0E] = 0x80;	// CANSTAT: コンフィグレーション
+			reg_[0x0F] = 0x87;	// CANCTRL
+			mode_ = 0x80;
+			lag_ = 0;
+		}
+
+		uint8_t mode() const { return reg_[0x0E] & 0xE0; }
+
+		bool protect_(uint8_t a) const {
+			if(a <= 0x0B || (a >= 0x10 && a <= 0x1B)) return true;  // RXF0 ～ RXF5
+			if(a >= 0x20 && a <= 0x2A) return true;  // RXM0、RXM1、CNF3 ～ CNF1
+			return false;
+		}
+
+		void write_(uint8_t a, uint8_t v) {
+			a &= 0x7F;
+			if(protect_(a) && mode() != 0x80) ++bad_;
+			if(a == 0x0E) return;  // CANSTAT は、読み出し専用
+			if(a == 0x0F) {
+				mode_ = v & 0xE0;
+				lag_ = 1;
+			}
+			uint8_t txb = a >> 4;
+			if((a & 0x0F) != 0 && txb >= 3 && txb <= 5 && (reg_[txb << 4] & 0x08) != 0) {
+				++bad_;  // 送信待ちの TX バッファへの書き込み
+			}
+			reg_[a] = v;
+		}
+
+		void cs(uint8_t v) {
+			if(v == 0) {
+				if(low_) ++bad_;
+				low_ = true;
+				pos_ = 0;
+				return;
+			}
+			if(!low_) return;
+			low_ = false;
+			// READ RX BUFFER は、CS の解除で RXnIF をクリアする
+			if(pos_ > 0 && (cmd_ & 0xF9) == 0x90) {
+				reg_[0x2C] &= ~(1 << ((cmd_ >> 2) & 1));
+			}
+		}
+
+		uint8_t status_() const {
+			uint8_t f = reg_[0x2C];
+			uint8_t s = f & 0x03;
+			if(reg_[0x30] & 0x08) s |= 0x04;
+			if(f & 0x04) s |= 0x08;
+			if(reg_[0x40] & 0x08) s |= 0x10;
+			if(f & 0x08) s |= 0x20;
+			if(reg_[0x50] & 0x08) s |= 0x40;
+			if(f & 0x10) s |= 0x80;
+			return s;
+		}
+
+		uint8_t xchg(uint8_t d = 0xff) {
+			++bytes_;
+			if(hook_ != nullptr && bytes_ == hook_at_) hook_();
+			if(!low_) {
+				++bad_;
+				return 0xff;
+			}
+			uint8_t p = pos_++;
+			if(p == 0) {
+				cmd_ = d;
+				if(d == 0xC0) {
+					reset_();
+				} else if((d & 0xF0) == 0x80) {  // RTS
+					for(uint8_t n = 0; n < 3; ++n) {
+						if(d & (1 << n)) reg_[0x30 + (n << 4)] |= 0x08;
+					}
+				} else if((d & 0xF9) == 0x90) {  // READ RX BUFFER
+					adr_ = (d & 0x04 ? 0x71 : 0x61) + (d & 0x02 ? 5 : 0);
+				} else if((d & 0xF8) == 0x40) {  // LOAD TX BUFFER
+					adr_ = 0x31 + ((d >> 1) & 3) * 0x10 + (d & 1 ? 5 : 0);
+				}
+				return 0xff;
+			}
+			switch(cmd_) {
+			case 0x03:  // READ
+				if(p == 1) {
+					adr_ = d;
+					return 0xff;
+				}
+				if((adr_ & 0x7F) == 0x0E && lag_ > 0) {
+					if(--lag_ == 0) reg_[0x0E] = (reg_[0x0E] & 0x1F) | mode_;
+				}
+				return reg_[adr_++ & 0x7F];
+			case 0x02:  // WRITE
+				if(p == 1) adr_ = d;
+				else write_(adr_++, d);
+				return 0xff;
+			case 0x05:  // BIT MODIFY
+				if(p == 1) adr_ = d;
+				else if(p == 2) mask_ = d;
+				else if(p == 3) write_(adr_, (reg_[adr_ & 0x7F] & ~mask_) | (d & mask_));
+				return 0xff;
+			case 0xA0:  // READ STATUS
+				return status_();
+			default:
+				if((cmd_ & 0xF9) == 0x90) return reg_[adr_++ & 0x7F];
+				if((cmd_ & 0xF8) == 0x40) {
+					write_(adr_++, d);
+					return 0xff;
+				}
+				return 0xff;
+			}
+		}
+
+		void send(const uint8_t* src, uint16_t len) {
+			for(uint16_t i = 0; i < len; ++i) xchg(src[i]);
+		}
+
+		void recv(uint8_t* dst, uint16_t len) {
+			for(uint16_t i = 0; i < len; ++i) dst[i] = xchg();
+		}
+
+		bool irq() const { return (reg_[0x2C] & reg_[0x2B]) != 0; }
+
+		// フィルター n（マスク m）に一致するか
+		bool match_(const frame& f, uint8_t n, uint8_t m) const {
+			const uint8_t* fr = &reg_[n < 3 ? n * 4 : 0x10 + (n - 3) * 4];
+			const uint8_t* mr = &reg_[0x20 + m * 4];
+			if(((fr[1] & 0x08) != 0) != f.ext) return false;
+			uint16_t sid = f.ext ? (f.id >> 18) : f.id;
+			uint16_t fsid = (fr[0] << 3) | (fr[1] >> 5);
+			uint16_t msid = (mr[0] << 3) | (mr[1] >> 5);
+			if(((sid ^ fsid) & msid) != 0) return false;
+			if(f.ext) {
+				uint32_t eid = f.id & 0x3FFFF;
+				uint32_t feid = (static_cast<uint32_t>(fr[1] & 3) << 16) | (fr[2] << 8) | fr[3];
+				uint32_t meid = (static_cast<uint32_t>(mr[1] & 3) << 16) | (mr[2] << 8) | mr[3];
+				return ((eid ^ feid) & meid) == 0;
+			}
+			// 標準フレームでは、EID8、EID0 を、データの先頭２バイトと比べる
+			uint8_t d0 = f.dlc > 0 && !f.rtr ? f.data[0] : 0;
+			uint8_t d1 = f.dlc > 1 && !f.rtr ? f.data[1] : 0;
+			return ((d0 ^ fr[2]) & mr[2]) == 0 && ((d1 ^ fr[3]) & mr[3]) == 0;
+		}
+
+		void load_(uint8_t base, const frame& f) {
+			uint8_t* r = &reg_[base];
+			if(f.ext) {
+				uint16_t sid = f.id >> 18;
+				r[0] = sid >> 3;
+				r[1] = ((sid & 7) << 5) | 0x08 | ((f.id >> 16) & 3);
+				r[2] = f.id >> 8;
+				r[3] = f.id;
+				r[4] = (f.rtr ? 0x40 : 0) | f.dlc;
+			} else {
+				r[0] = f.id >> 3;
+				r[1] = ((f.id & 7) << 5) | (f.rtr ? 0x10 : 0);
+				r[2] = 0;
+				r[3] = 0;
+				r[4] = f.dlc;
+			}
+			memcpy(&r[5], f.data, 8);
+		}
+
+		// バスからフレームを受ける（受け付けたら「true」）
+		bool rx(const frame& f) {
+			uint8_t md = mode();
+			if(md != 0x00 && md != 0x40 && md != 0x60) return false;
+			bool any0 = (reg_[0x60] & 0x60) == 0x60;
+			bool any1 = (reg_[0x70] & 0x60) == 0x60;
+			bool b0 = any0 || match_(f, 0, 0) || match_(f, 1, 0);
+			bool b1 = any1 || match_(f, 2, 1) || match_(f, 3, 1) || match_(f, 4, 1) || match_(f, 5, 1);
+			if(b0) {
+				if((reg_[0x2C] & 0x01) == 0) {
+					load_(0x61, f);
+					reg_[0x2C] |= 0x01;
+					return true;
+				}
+				if((reg_[0x60] & 0x04) == 0) {  // BUKT 無し
+					reg_[0x2D] |= 0x40;  // RX0OVR
+					return false;
+				}
+				b1 = true;
+			}
+			if(!b1) return false;
+			if((reg_[0x2C] & 0x02) != 0) {
+				reg_[0x2D] |= 0x80;  // RX1OVR
+				return false;
+			}
+			load_(0x71, f);
+			reg_[0x2C] |= 0x02;
+			return true;
+		}
+
+		// 送信待ちのバッファを一つ送信（優先度が同じなら、番号の大きいバッファ）
+		bool tx() {
+			uint8_t md = mode();
+			if(md != 0x00 && md != 0x40) return false;
+			int8_t n = -1;
+			for(int8_t i = 2; i >= 0; --i) {
+				uint8_t c = reg_[0x30 + (i << 4)];
+				if((c & 0x08) == 0) continue;
+				if(n < 0 || (c & 3) > (reg_[0x30 + (n << 4)] & 3)) n = i;
+			}
+			if(n < 0) return false;
+			const uint8_t* r = &reg_[0x31 + (n << 4)];
+			frame f;
+			f.ext = (r[1] & 0x08) != 0;
+			if(f.ext) {
+				f.id = (static_cast<uint32_t>((r[0] << 3) | (r[1] >> 5)) << 18)
+					| (static_cast<uint32_t>(r[1] & 3) << 16) | (r[2] << 8) | r[3];
+				f.rtr = (r[4] & 0x40) != 0;
+			} else {
+				f.id = (r[0] << 3) | (r[1] >> 5);
+				f.rtr = (r[4] & 0x40) != 0;
+			}
+			f.dlc = r[4] & 0x0F;
+			memcpy(f.data, &r[5], 8);
+			reg_[0x30 + (n << 4)] &= ~0x08;
+			reg_[0x2C] |= 0x04 << n;
+			if(sent_num_ < 16) sent_[sent_num_++] = f;
+			if(md == 0x40) rx(f);
+			return true;
+		}
+	};
+
+	mcp_model	model_;
+
+	struct cs_port {
+		cs_port& operator = (uint8_t v) {
+			model_.cs(v);
+			return *this;
+		}
+	};
+
+	struct sel_t {
+		static cs_port	P;
+		static uint8_t	DIR;
+	};
+	cs_port	sel_t::P;
+	uint8_t	sel_t::DIR;
+
+	typedef chip::MCP2515<mcp_model, sel_t, 8> CAN;
+	CAN		can_(model_);
+
+#define CHECK(cond, msg) \
+	if(!(cond)) { printf("NG: %s (line %d)\n", msg, __LINE__); return false; }
+
+
+	// 受信フィルター：標準 0x12x、0x34x（RXB0）、拡張 0x18DA00xx、0x18DB33xx（RXB1）
+	constexpr CAN::filter_t filter_ = {
+		{ CAN::id_reg(0x7F0), CAN::id_reg(0x1FFFFF00, true) },
+		{ CAN::id_reg(0x120), CAN::id_reg(0x340),
+		  CAN::id_reg(0x18DA0000, true), CAN::id_reg(0x18DB3300, true),
+		  CAN::id_reg(0x18DA0000, true), CAN::id_reg(0x18DB3300, true) }
+	};
+
+	bool accept_(const frame& f)
+	{
+		if(f.ext) {
+			uint32_t m = f.id & 0x1FFFFF00;
+			return m == 0x18DA0000 || m == 0x18DB3300;
+		}
+		uint32_t m = f.id & 0x7F0;
+		return m == 0x120 || m == 0x340;
+	}
+
+	bool same_(const frame& a, const CAN::frame_t& b)
+	{
+		if(a.id != b.id || a.ext != b.ext || a.rtr != b.rtr || a.dlc != b.dlc) return false;
+		return a.rtr || memcmp(a.data, b.data, a.dlc) == 0;
+	}
+
+	void make_(frame& f)
+	{
+		f.ext = rand() & 1;
+		if(f.ext) {
+			static const uint32_t base[] = { 0x18DA0000, 0x18DB3300, 0x18DC0000, 0x0 };
+			f.id = (base[rand() & 3] | (rand() & 0xFF)) ^ ((rand() % 8) == 0 ? (1 << (rand() % 29)) : 0);
+		} else {
+			static const uint16_t base[] = { 0x120, 0x340, 0x560, 0x000 };
+			f.id = (base[rand() & 3] | (rand() & 0x0F)) ^ ((rand() % 8) == 0 ? (1 << (rand() % 11)) : 0);
+		}
+		f.rtr = (rand() % 8) == 0;
+		f.dlc = rand() % 9;
+		for(uint8_t i = 0; i < 8; ++i) f.data[i] = f.rtr ? 0 : rand();
+	}
+
+
+	bool test_timing_()
+	{
+		static const uint32_t oscs[] = { 8000000, 16000000, 20000000 };
+		static const uint32_t bpss[] = { 1000000, 500000, 250000, 125000, 100000, 50000, 20000, 10000 };
+		uint16_t num = 0;
+		for(uint32_t osc : oscs) {
+			for(uint32_t bps : bpss) {
+				model_.bad_ = 0;
+				if(!can_.start(osc, bps)) continue;
+				CHECK(model_.mode() == 0x00, "normal mode");
+				CHECK(model_.bad_ == 0, "register access");
+				uint8_t cnf1 = model_.reg_[0x2A];
+				uint8_t cnf2 = model_.reg_[0x29];
+				uint8_t cnf3 = model_.reg_[0x28];
+				uint32_t brp = (cnf1 & 0x3F) + 1;
+				uint8_t prop = (cnf2 & 7) + 1;
+				uint8_t ps1 = ((cnf2 >> 3) & 7) + 1;
+				uint8_t ps2 = (cnf3 & 7) + 1;
+				uint8_t tq = 1 + prop + ps1 + ps2;
+				CHECK((cnf2 & 0x80) != 0, "BTLMODE");
+				CHECK(osc == 2 * brp * tq * bps, "bit rate");
+				CHECK(ps2 >= 2 && ps2 <= (prop + ps1), "phase segment 2");
+				uint16_t sp = 100 * (1 + prop + ps1) / tq;
+				CHECK(sp >= 60 && sp <= 85, "sample point");
+				++num;
+			}
+		}
+		CHECK(num >= 20, "bit rates");
+		CHECK(!can_.start(16000000, 333333), "bad bit rate");
+		printf("bit timing: %u bit rates OK\n", num);
+		return true;
+	}
+
+
+	bool test_filter_(uint32_t loop)
+	{
+		CHECK(can_.start(16000000, 500000, filter_), "start");
+		CHECK(model_.bad_ == 0, "register access");
+		CHECK(model_.reg_[0x60] == 0x04, "rollover");
+		CHECK(model_.reg_[0x2B] == 0x03, "rx interrupt");
+
+		uint32_t acc = 0;
+		uint32_t bytes = 0;
+		uint32_t data = 0;
+		for(uint32_t n = 0; n < loop; ++n) {
+			frame f;
+			make_(f);
+			bool ok = model_.rx(f);
+			CHECK(ok == accept_(f), "hardware filter");
+			if(!ok) continue;
+			++acc;
+			CHECK(model_.irq(), "INT");
+			uint32_t b = model_.bytes_;
+			can_.recv_task();
+			bytes += model_.bytes_ - b;
+			data += f.rtr ? 0 : f.dlc;
+			CHECK(!model_.irq(), "INT cleared");
+			CAN::frame_t r;
+			CHECK(can_.recv(r), "recv");
+			CHECK(same_(f, r), "frame");
+			CHECK(!can_.recv(r), "one frame");
+		}
+		CHECK(model_.bad_ == 0, "spi protocol");
+		// READ でレジスター毎に読む場合：CANINTF (3) + (5 + DLC) x 3 + BIT MODIFY (4) + CANINTF (3)
+		double fb = static_cast<double>(bytes) / acc;
+		double reg = 3 + (5 + static_cast<double>(data) / acc) * 3 + 4 + 3;
+		printf("filter: %u / %u frames accepted, %.1f SPI bytes/frame (READ per register %.1f)\n",
+			acc, loop, fb, reg);
+		return true;
+	}
+
+
+	bool test_rollover_()
+	{
+		CHECK(can_.start(16000000, 500000), "start");
+		frame f[4];
+		for(uint8_t i = 0; i < 4; ++i) {
+			f[i].id = 0x100 + i;
+			f[i].ext = false;
+			f[i].rtr = false;
+			f[i].dlc = 8;
+			for(uint8_t j = 0; j < 8; ++j) f[i].data[j] = i * 16 + j;
+		}
+		CHECK(model_.rx(f[0]), "RXB0");
+		CHECK(model_.rx(f[1]), "RXB1 (rollover)");
+		CHECK(!model_.rx(f[2]), "overflow");
+		uint8_t e = can_.get_error();
+		CHECK(e & 0x80, "RX1OVR");
+		CHECK((model_.reg_[0x2D] & 0xC0) == 0, "RX1OVR cleared");
+		can_.recv_task();
+		CAN::frame_t r;
+		CHECK(can_.recv(r) && same_(f[0], r), "first");
+		CHECK(can_.recv(r) && same_(f[1], r), "second");
+		CHECK(!can_.recv(r), "two frames");
+
+		// リングが一杯
+		for(uint8_t i = 0; i < 9; ++i) {
+			CHECK(model_.rx(f[i & 3]), "ring in");
+			can_.recv_task();
+		}
+		CHECK(can_.get_recv_num() == 7, "ring full");
+		CHECK(can_.get_lost_num() == 2, "lost");
+		while(can_.recv(r)) ;
+		printf("rollover: OK\n");
+		return true;
+	}
+
+
+	frame	isr_frame_;
+	bool	isr_ok_;
+
+	// SPI 転送中の INT 割り込み
+	void isr_()
+	{
+		isr_ok_ = model_.rx(isr_frame_);
+		can_.recv_task();
+	}
+
+
+	bool test_send_()
+	{
+		CHECK(can_.start(16000000, 500000), "start");
+		model_.sent_num_ = 0;
+		frame f[4];
+		for(uint8_t i = 0; i < 4; ++i) make_(f[i]);
+		CAN::frame_t t[4];
+		for(uint8_t i = 0; i < 4; ++i) {
+			t[i].id = f[i].id;
+			t[i].ext = f[i].ext;
+			t[i].rtr = f[i].rtr;
+			t[i].dlc = f[i].dlc;
+			memcpy(t[i].data, f[i].data, 8);
+		}
+		CHECK(can_.send(t[0], 1), "send 0");
+		CHECK(can_.send(t[1], 3), "send 1");
+		CHECK(can_.send(t[2], 1), "send 2");
+		CHECK(!can_.send(t[3], 0), "all busy");
+		CHECK(can_.get_send_pending() == 3, "pending");
+		CHECK(model_.bad_ == 0, "tx buffer");
+
+		// 優先度 3 (t1)、同じ優先度は番号の大きいバッファ (t2、t0)
+		while(model_.tx()) ;
+		CHECK(model_.sent_num_ == 3, "sent");
+		CAN::frame_t r;
+		static const uint8_t order[] = { 1, 2, 0 };
+		for(uint8_t i = 0; i < 3; ++i) {
+			const frame& s = model_.sent_[i];
+			r = t[order[i]];
+			CHECK(same_(s, r), "priority order");
+		}
+		CHECK(can_.get_send_pending() == 0, "sent all");
+
+		// 送信中の割り込みは、SPI の解放後に処理する
+		isr_frame_ = f[3];
+		isr_frame_.id = 0x7FF;
+		isr_frame_.ext = false;
+		model_.hook_ = isr_;
+		model_.hook_at_ = model_.bytes_ + 5;
+		CHECK(can_.send(t[3]), "send in isr");
+		model_.hook_ = nullptr;
+		CHECK(isr_ok_, "isr frame");
+		CHECK(model_.bad_ == 0, "no nested select");
+		CHECK(can_.recv(r) && same_(isr_frame_, r), "pended recv");
+
+		// ループバック
+		CHECK(can_.start(16000000, 500000, CAN::accept_all(), CAN::MODE::LOOPBACK), "loopback");
+		CHECK(can_.send(t[0]), "loopback send");
+		CHECK(model_.tx(), "loopback tx");
+		can_.recv_task();
+		CHECK(can_.recv(r) && same_(f[0], r), "loopback recv");
+		printf("send: OK\n");
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t loop = 100000;
+	if(argc >= 2) loop = strtoul(argv[1], nullptr, 10);
+
+	srand(1);
+	bool ok = true;
+	ok = test_timing_() && ok;
+	ok = test_filter_(loop) && ok;
+	ok = test_rollover_() && ok;
+	ok = test_send_() && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK\n");
+	return 0;
+}
@@ -0,0 +1,268 @@
+//=====================================================================//
+/*!	@file
+	@brief	monograph の描画テストとベンチマーク（ホスト用） @n
+			fill、reverse、clear、line、draw_image の結果を、１ピクセル毎に @n
+			描画する参照実装（従来の monograph と同じアルゴリズム）と比較し、 @n
+			１秒あたりの描画ピクセル数を表示する。 @n
+			monograph_test [テスト回数]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include "common/monograph.hpp"
+
+namespace {
+
+	static constexpr uint16_t WIDTH = 128;
+	static constexpr uint16_t HEIGHT = 64;
+
+	typedef graphics::kfont_null KFONT;
+	typedef graphics::monograph<WIDTH, HEIGHT, graphics::afont_null, KFONT> MONOGRAPH;
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	参照実装（１ピクセル毎の描画）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct ref_graph {
+		uint8_t	fb_[WIDTH * HEIGHT / 8];
+
+		void set_(int16_t x, int16_t y) {
+			if(static_cast<uint16_t>(x) >= WIDTH) return;
+			if(static_cast<uint16_t>(y) >= HEIGHT) return;
+			fb_[(y >> 3) * WIDTH + x] |= (1 << (y & 7));
+		}
+
+		void reset_(int16_t x, int16_t y) {
+			if(static_cast<uint16_t>(x) >= WIDTH) return;
+			if(static_cast<uint16_t>(y) >= HEIGHT) return;
+			fb_[(y >> 3) * WIDTH + x] &= ~(1 << (y & 7));
+		}
+
+		void reverse_(int16_t x, int16_t y) {
+			if(static_cast<uint16_t>(x) >= WIDTH) return;
+			if(static_cast<uint16_t>(y) >= HEIGHT) return;
+			fb_[(y >> 3) * WIDTH + x] ^= (1 << (y & 7));
+		}
+
+		void fill(int16_t x, int16_t y, int16_t w, int16_t h, bool c) {
+			for(int16_t i = y; i < (y + h); ++i) {
+				for(int16_t j = x; j < (x + w); ++j) {
+					if(c) set_(j, i);
+					else reset_(j, i);
+				}
+			}
+		}
+
+		void reverse(int16_t x, int16_t y, int16_t w, int16_t h) {
+			for(int16_t i = y; i < (y + h); ++i) {
+				for(int16_t j = x; j < (x + w); ++j) {
+					reverse_(j, i);
+				}
+			}
+		}
+
+		void clear(bool c) { fill(0, 0, WIDTH, HEIGHT, c); }
+
+		void line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, bool c) {
+			int16_t dx;
+			int16_t dy;
+			int16_t sx;
+			int16_t sy;
+			if(x2 >= x1) { dx = x2 - x1; sx = 1; } else { dx = x1 - x2; sx = -1; }
+			if(y2 >= y1) { dy = y2 - y1; sy = 1; } else { dy = y1 - y2; sy = -1; }
+			int16_t m = 0;
+			int16_t x = x1;
+			int16_t y = y1;
+			if(dx > dy) {
+				for(int16_t i = 0; i <= dx; i++) {
+					if(c) set_(x, y);
+					else reset_(x, y);
+					m += dy;
+					if(m >= dx) {
+						m -= dx;
+						y += sy;
+					}
+					x += sx;
+				}
+			} else {
+				for(int16_t i = 0; i <= dy; i++) {
+					if(c) set_(x, y);
+					else reset_(x, y);
+					m += dx;
+					if(m >= dy) {
+						m -= dy;
+						x += sx;
+					}
+					y += sy;
+				}
+			}
+		}
+
+		void draw_image(int16_t x, int16_t y, const uint8_t* img, uint8_t w, uint8_t h) {
+			uint8_t k = 1;
+			uint8_t c = *img++;
+			for(uint8_t i = 0; i < h; ++i) {
+				int16_t xx = x;
+				for(uint8_t j = 0; j < w; ++j) {
+					if(c & k) set_(xx, y);
+					k <<= 1;
+					if(k == 0) {
+						k = 1;
+						c = *img++;
+					}
+					++xx;
+				}
+				++y;
+			}
+		}
+	};
+
+	KFONT		kfont_;
+	MONOGRAPH	mono_(kfont_);
+	ref_graph	ref_;
+
+	uint8_t		img_[256 * 256 / 8 + 1];
+
+	int16_t rand_(int16_t min, int16_t max)
+	{
+		return min + (rand() % (max - min + 1));
+	}
+
+
+	bool compare_(const char* name, uint32_t n)
+	{
+		if(memcmp(mono_.fb(), ref_.fb_, sizeof(ref_.fb_)) == 0) return true;
+		for(uint16_t i = 0; i < sizeof(ref_.fb_); ++i) {
+			if(mono_.fb()[i] != ref_.fb_[i]) {
+				printf("%s (#%u): page %d, x %d: %02X != %02X\n", name, n,
+					i / WIDTH, i % WIDTH, mono_.fb()[i], ref_.fb_[i]);
+				break;
+			}
+		}
+		return false;
+	}
+
+
+	bool test_(uint32_t loop)
+	{
+		for(uint16_t i = 0; i < sizeof(img_); ++i) img_[i] = rand();
+
+		mono_.clear(false);
+		ref_.clear(false);
+		if(!compare_("clear", 0)) return false;
+		mono_.clear(true);
+		ref_.clear(true);
+		if(!compare_("clear", 0)) return false;
+
+		// 画面外にはみ出す座標も含める
+		for(uint32_t n = 0; n < loop; ++n) {
+			int16_t x = rand_(-40, WIDTH + 8);
+			int16_t y = rand_(-40, HEIGHT + 8);
+			int16_t w = rand_(-2, WIDTH + 40);
+			int16_t h = rand_(-2, HEIGHT + 40);
+			bool c = rand() & 1;
+			switch(n % 4) {
+			case 0:
+				mono_.fill(x, y, w, h, c);
+				ref_.fill(x, y, w, h, c);
+				if(!compare_("fill", n)) return false;
+				break;
+			case 1:
+				mono_.reverse(x, y, w, h);
+				ref_.reverse(x, y, w, h);
+				if(!compare_("reverse", n)) return false;
+				break;
+			case 2:
+				{
+					int16_t x2 = rand_(-40, WIDTH + 40);
+					int16_t y2 = rand_(-40, HEIGHT + 40);
+					mono_.line(x, y, x2, y2, c);
+					ref_.line(x, y, x2, y2, c);
+					if(!compare_("line", n)) return false;
+				}
+				break;
+			case 3:
+				{
+					uint8_t iw = rand_(1, 40);
+					uint8_t ih = rand_(1, 40);
+					const uint8_t* img = &img_[rand_(0, 1024)];
+					mono_.draw_image(x, y, img, iw, ih);
+					ref_.draw_image(x, y, img, iw, ih);
+					if(!compare_("draw_image", n)) return false;
+				}
+				break;
+			}
+		}
+		return true;
+	}
+
+
+	template <class FUNC>
+	double bench_(uint32_t pixels, FUNC func)
+	{
+		uint32_t loop = 0;
+		auto st = std::chrono::steady_clock::now();
+		double sec = 0;
+		do {
+			for(uint32_t i = 0; i < 1000; ++i) {
+				func(i);
+			}
+			loop += 1000;
+			sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - st).count();
+		} while(sec < 0.2) ;
+		return static_cast<double>(pixels) * loop / sec;
+	}
+
+
+	void bench_all_()
+	{
+		printf("pixel/s      %14s %14s\n", "reference", "monograph");
+		auto a = bench_(WIDTH * HEIGHT, [](uint32_t i) { ref_.fill(0, 0, WIDTH, HEIGHT, i & 1); });
+		auto b = bench_(WIDTH * HEIGHT, [](uint32_t i) { mono_.fill(0, 0, WIDTH, HEIGHT, i & 1); });
+		printf("%-12s %14.0f %14.0f (x%.1f)\n", "fill", a, b, b / a);
+		a = bench_(37 * 21, [](uint32_t i) { ref_.reverse(i & 63, 3, 37, 21); });
+		b = bench_(37 * 21, [](uint32_t i) { mono_.reverse(i & 63, 3, 37, 21); });
+		printf("%-12s %14.0f %14.0f (x%.1f)\n", "reverse", a, b, b / a);
+		a = bench_(WIDTH, [](uint32_t i) { ref_.line(0, i & 63, WIDTH - 1, 63 - (i & 63), true); });
+		b = bench_(WIDTH, [](uint32_t i) { mono_.line(0, i & 63, WIDTH - 1, 63 - (i & 63), true); });
+		printf("%-12s %14.0f %14.0f (x%.1f)\n", "line", a, b, b / a);
+		a = bench_(HEIGHT, [](uint32_t i) { ref_.line(i & 63, 0, (i & 63) + 9, HEIGHT - 1, true); });
+		b = bench_(HEIGHT, [](uint32_t i) { mono_.line(i & 63, 0, (i & 63) + 9, HEIGHT - 1, true); });
+		printf("%-12s %14.0f %14.0f (x%.1f)\n", "line (steep)", a, b, b / a);
+		a = bench_(12 * 12, [](uint32_t i) { ref_.draw_image(i & 127, 20, img_, 12, 12); });
+		b = bench_(12 * 12, [](uint32_t i) { mono_.draw_image(i & 127, 20, img_, 12, 12); });
+		printf("%-12s %14.0f %14.0f (x%.1f)\n", "draw_image", a, b, b / a);
+		a = bench_(8 * 16, [](uint32_t i) { ref_.draw_image((i & 15) * 8, 16, img_, 8, 16); });
+		b = bench_(8 * 16, [](uint32_t i) { mono_.draw_image((i & 15) * 8, 16, img_, 8, 16); });
+		printf("%-12s %14.0f %14.0f (x%.1f)\n", "image 8x16", a, b, b / a);
+		a = bench_(64 * 48, [](uint32_t i) { ref_.draw_image(i & 63, i & 15, img_, 64, 48); });
+		b = bench_(64 * 48, [](uint32_t i) { mono_.draw_image(i & 63, i & 15, img_, 64, 48); });
+		printf("%-12s %14.0f %14.0f (x%.1f)\n", "image 64x48", a, b, b / a);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t loop = 100000;
+	if(argc >= 2) loop = strtoul(argv[1], nullptr, 10);
+
+	srand(1);
+	if(!test_(loop)) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: %u operations OK\n", loop);
+
+	bench_all_();
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+//=====================================================================//
+/*!	@file
+	@brief	NTCTH のテーブル変換テスト（ホスト用） @n
+			get_fixed（テーブル変換）を、operator ()（float の計算）と、 @n
+			全ての A/D 変換値で比較し、温度範囲毎の最大誤差が、 @n
+			規定値以内か検査する。 @n
+			また、１回の変換にかかる時間を表示する。 @n
+			TBITS = 6: -20 ～ 85 ℃: 0.15 ℃、-40 ～ 125 ℃: 1.0 ℃ @n
+			TBITS = 8: -20 ～ 85 ℃、-40 ～ 125 ℃: 0.1 ℃ @n
+			ntcth_test
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include "chip/NTCTH.hpp"
+
+namespace {
+
+	struct range_t {
+		float	min;
+		float	max;
+		float	limit;	///< 許容誤差（℃、TBITS = 6）
+	};
+
+	static const range_t ranges_[] = {
+		{ -20.0f,  85.0f, 0.15f },
+		{ -40.0f, 125.0f, 1.0f },
+	};
+
+	template <class NTC>
+	bool test_(const char* name, uint32_t adnum, float limit = 0.0f)
+	{
+		static NTC ntc;
+		bool ok = true;
+		printf("%-28s", name);
+		for(const auto& r : ranges_) {
+			float err = 0.0f;
+			for(uint32_t adn = 1; adn < adnum; ++adn) {
+				float ref = ntc(adn);
+				if(ref < r.min || ref > r.max) continue;
+				float t = static_cast<float>(ntc.get_fixed(adn)) / (1 << NTC::FIXED_BITS);
+				float d = std::fabs(t - ref);
+				if(d > err) err = d;
+			}
+			bool f = err <= (limit > 0.0f ? limit : r.limit);
+			printf(" %4.0f..%3.0f: %5.3f (%s)", r.min, r.max, err, f ? "OK" : "NG");
+			if(!f) ok = false;
+		}
+		printf("\n");
+		return ok;
+	}
+
+
+	template <class NTC>
+	void bench_(const char* name, uint32_t adnum)
+	{
+		static NTC ntc;
+		static constexpr uint32_t LOOP = 200;
+		volatile float fs = 0.0f;
+		volatile int16_t is = 0;
+
+		auto st = std::chrono::steady_clock::now();
+		for(uint32_t n = 0; n < LOOP; ++n) {
+			for(uint32_t adn = 1; adn < adnum; ++adn) {
+				fs = ntc(adn);
+			}
+		}
+		auto md = std::chrono::steady_clock::now();
+		for(uint32_t n = 0; n < LOOP; ++n) {
+			for(uint32_t adn = 1; adn < adnum; ++adn) {
+				is = ntc.get_fixed(adn);
+			}
+		}
+		auto ed = std::chrono::steady_clock::now();
+		(void)fs;
+		(void)is;
+
+		double num = static_cast<double>(LOOP) * (adnum - 1);
+		double a = std::chrono::duration<double, std::nano>(md - st).count() / num;
+		double b = std::chrono::duration<double, std::nano>(ed - md).count() / num;
+		printf("%-28s float %6.2f ns, get_fixed %6.2f ns (x%.1f)\n", name, a, b, a / b);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	using chip::thermistor;
+	typedef chip::NTCTH<1023, thermistor::HX103_3380, 10000, true>  NTC10_UP;
+	typedef chip::NTCTH<1023, thermistor::NT103_34G,  10000, false> NTC10_LO;
+	typedef chip::NTCTH<4095, thermistor::NT103_41G,  10000, true>  NTC12_UP;
+	typedef chip::NTCTH<4095, thermistor::HX103_3380, 4700,  false> NTC12_LO;
+	typedef chip::NTCTH<4095, thermistor::NT103_34G,  10000, true, 8> NTC12_T8;
+
+	bool ok = true;
+	ok = test_<NTC10_UP>("10 bits, 3380, 10K, up", 1024) && ok;
+	ok = test_<NTC10_LO>("10 bits, 3435, 10K, low", 1024) && ok;
+	ok = test_<NTC12_UP>("12 bits, 4126, 10K, up", 4096) && ok;
+	ok = test_<NTC12_LO>("12 bits, 3380, 4.7K, low", 4096) && ok;
+	// 区間を 1/4 にすると、補間の誤差は 1/16 になり、量子化（1/16 ℃）が残る
+	ok = test_<NTC12_T8>("12 bits, 3435, 10K, up, T8", 4096, 0.1f) && ok;
+
+	bench_<NTC10_UP>("10 bits", 1024);
+	bench_<NTC12_UP>("12 bits", 4096);
+
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK\n");
+	return 0;
+}
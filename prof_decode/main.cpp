@@ -0,0 +1,140 @@
+//=====================================================================//
+/*!	@file
+	@brief	プロファイラー（common/profile.hpp）出力のデコーダー @n
+			シリアルのログから「#PROF 」の行を探して、ID 毎の集計を表示する。 @n
+			prof_decode [-f F_CLK] [log-file]（ファイルが無い場合、標準入力）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+	static const uint32_t HIST_NUM = 8;
+	static const uint32_t VERSION = 2;	///< 1: ID 毎の単位無し
+	static const char* header_ = "#PROF ";
+
+	bool get_hex_(const std::string& line, std::vector<uint8_t>& out)
+	{
+		out.clear();
+		std::string::size_type i = line.find(header_);
+		if(i == std::string::npos) return false;
+		i += strlen(header_);
+		while((i + 1) < line.size()) {
+			char tmp[3] = { line[i], line[i + 1], 0 };
+			char* end;
+			auto v = strtoul(tmp, &end, 16);
+			if(*end != 0) break;
+			out.push_back(v);
+			i += 2;
+		}
+		return !out.empty();
+	}
+
+
+	uint32_t get16_(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+
+	bool decode_(const std::vector<uint8_t>& d, uint32_t clk)
+	{
+		uint8_t sum = 0;
+		for(auto v : d) sum += v;
+		if(sum != 0) {
+			std::cerr << "Checksum error" << std::endl;
+			return false;
+		}
+		if(d.size() < 4 || d[0] == 0 || d[0] > VERSION) {
+			std::cerr << "Version error" << std::endl;
+			return false;
+		}
+		// バージョン２から、ID 毎にカウントの単位（割り込み遅延は TAU の単位）を持つ
+		uint32_t unit = d[0] >= 2 ? 1 : 0;
+		uint32_t num = d[2];
+		const uint32_t rec = 1 + unit + 2 * 3 + 4 + 2 * HIST_NUM;
+		if(d.size() != (3 + num * rec + 1)) {
+			std::cerr << "Length error" << std::endl;
+			return false;
+		}
+
+		printf("ID       min       max       avg     count  histogram(<4,<16,<64,...)\n");
+		const uint8_t* p = &d[3];
+		for(uint32_t i = 0; i < num; ++i) {
+			uint32_t id = p[0];
+			uint32_t shift = unit ? p[1] : d[1];
+			p += unit;
+			uint32_t min = get16_(p + 1) << shift;
+			uint32_t max = get16_(p + 3) << shift;
+			uint32_t n = get16_(p + 5);
+			uint32_t s = get16_(p + 7) | (get16_(p + 9) << 16);
+			double avg = n != 0 ? (static_cast<double>(s) / n) * (1 << shift) : 0.0;
+			if(clk != 0) {  // サイクルをマイクロ秒にする
+				double k = 1e6 / clk;
+				printf("%2u %8.2fu %8.2fu %8.2fu %9u ", id, min * k, max * k, avg * k, n);
+			} else {
+				printf("%2u %9u %9u %9.1f %9u ", id, min, max, avg, n);
+			}
+			for(uint32_t j = 0; j < HIST_NUM; ++j) {
+				printf(" %u", get16_(p + 11 + j * 2));
+			}
+			if(shift != d[1]) printf("  (F_CLK/%u)", 1 << shift);
+			printf("\n");
+			p += rec - unit;
+		}
+		return true;
+	}
+
+
+	void help_(const char* cmd)
+	{
+		std::cout << "Profiler dump decoder" << std::endl;
+		std::cout << cmd << " [-f F_CLK] [log-file]" << std::endl;
+		std::cout << "    -f F_CLK   show time [uS] with F_CLK [Hz]" << std::endl;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t clk = 0;
+	std::string file;
+	for(int i = 1; i < argc; ++i) {
+		std::string s = argv[i];
+		if(s == "-f" && (i + 1) < argc) {
+			clk = strtoul(argv[++i], nullptr, 10);
+		} else if(s == "-h" || s == "--help") {
+			help_(argv[0]);
+			return 0;
+		} else {
+			file = s;
+		}
+	}
+
+	std::ifstream ifs;
+	if(!file.empty()) {
+		ifs.open(file);
+		if(!ifs) {
+			std::cerr << "Can't open file: '" << file << "'" << std::endl;
+			return 1;
+		}
+	}
+	std::istream& is = file.empty() ? std::cin : ifs;
+
+	int ret = 1;
+	std::string line;
+	std::vector<uint8_t> d;
+	while(std::getline(is, line)) {
+		if(!get_hex_(line, d)) continue;
+		if(decode_(d, clk)) ret = 0;
+	}
+	return ret;
+}
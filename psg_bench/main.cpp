@@ -0,0 +1,133 @@
+//=====================================================================//
+/*!	@file
+	@brief	psg_mng の render と render_fast の比較（ホスト用） @n
+			同じスコアを、二つの psg_mng で演奏し、出力の差（最大値）と、 @n
+			１秒あたりに生成できるサンプル数を、同時発音数毎に表示する。 @n
+			psg_bench [秒数]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include "common/psg_mng.hpp"
+
+extern "C" {
+
+	void sci_putch(char ch)
+	{
+		putchar(ch);
+	}
+
+}
+
+namespace {
+
+	static constexpr uint16_t SAMPLE = 31'250;
+	static constexpr uint16_t TICK = 100;
+	static constexpr uint16_t BLOCK = SAMPLE / TICK;
+
+	typedef utils::psg_base PSG;
+
+	// 波形毎のアルペジオ（最後に最初から繰り返す）
+#define ARPEGGIO(WT, K0, K1, K2) \
+		PSG::CTRL::VOLUME, 128, \
+		PSG::CTRL::WT, \
+		PSG::CTRL::TEMPO, 80, \
+		PSG::CTRL::ATTACK, 175, \
+		PSG::KEY::K0, 8, \
+		PSG::KEY::K1, 8, \
+		PSG::KEY::K2, 16, \
+		PSG::KEY::Q,  8, \
+		PSG::CTRL::REPEAT
+
+	constexpr PSG::SCORE score_sq25_[]  = { ARPEGGIO(SQ25,  C_4, E_4, G_4) };
+	constexpr PSG::SCORE score_sq50_[]  = { ARPEGGIO(SQ50,  E_5, G_5, B_5) };
+	constexpr PSG::SCORE score_sq75_[]  = { ARPEGGIO(SQ75,  G_3, B_3, D_4) };
+	constexpr PSG::SCORE score_tri_[]   = { ARPEGGIO(TRI,   C_2, G_2, C_3) };
+	constexpr PSG::SCORE score_noise_[] = { ARPEGGIO(NOISE, A_6, A_5, A_7) };
+
+	const PSG::SCORE* scores_[] = {
+		score_sq25_, score_sq50_, score_tri_, score_sq75_, score_noise_
+	};
+
+
+	template <uint16_t CNUM>
+	void setup_(utils::psg_mng<SAMPLE, TICK, CNUM>& psg)
+	{
+		for(uint16_t i = 0; i < CNUM; ++i) {
+			psg.set_score(i, scores_[i % 5]);
+		}
+	}
+
+
+	template <uint16_t CNUM>
+	bool bench_(uint32_t sec)
+	{
+		typedef utils::psg_mng<SAMPLE, TICK, CNUM> PSG_MNG;
+		static PSG_MNG ref;
+		static PSG_MNG fast;
+		setup_(ref);
+		setup_(fast);
+
+		// 出力の比較
+		uint32_t ticks = sec * TICK;
+		int8_t a[BLOCK];
+		int8_t b[BLOCK];
+		int16_t err = 0;
+		for(uint32_t t = 0; t < ticks; ++t) {
+			ref.service();
+			fast.service();
+			ref.render(BLOCK, a);
+			fast.render_fast(BLOCK, b);
+			for(uint16_t i = 0; i < BLOCK; ++i) {
+				int16_t d = a[i] - b[i];
+				if(d < 0) d = -d;
+				if(d > err) err = d;
+			}
+		}
+
+		// 速度（演奏サービスを含む）
+		volatile int8_t sink = 0;
+		auto st = std::chrono::steady_clock::now();
+		for(uint32_t t = 0; t < ticks; ++t) {
+			ref.service();
+			ref.render(BLOCK, a);
+			sink = a[0];
+		}
+		auto md = std::chrono::steady_clock::now();
+		for(uint32_t t = 0; t < ticks; ++t) {
+			fast.service();
+			fast.render_fast(BLOCK, b);
+			sink = b[0];
+		}
+		auto ed = std::chrono::steady_clock::now();
+		(void)sink;
+
+		double n = static_cast<double>(ticks) * BLOCK;
+		double ra = n / std::chrono::duration<double>(md - st).count();
+		double rb = n / std::chrono::duration<double>(ed - md).count();
+		printf("%u voices: render %10.0f smp/s, render_fast %10.0f smp/s (x%.1f), max diff %d LSB\n",
+			CNUM, ra, rb, rb / ra, err);
+		return err == 0;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t sec = 60;
+	if(argc >= 2) sec = strtoul(argv[1], nullptr, 10);
+	if(sec == 0) sec = 1;
+
+	bool ok = true;
+	ok = bench_<3>(sec) && ok;
+	ok = bench_<4>(sec) && ok;
+	ok = bench_<8>(sec) && ok;
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+//=====================================================================//
+/*!	@file
+	@brief	RAM 使用量レポート @n
+			リンカーのマップ・ファイル（-Wl,-Map,xxx.map）を読んで、 @n
+			オブジェクト毎の .data、.ramtext、.bss、.lowtext の大きさと、RAM の残り @n
+			（スタックに使える領域）、RAM を多く使う変数を表示する。 @n
+			ram_report [-n 数] xxx.map
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+namespace {
+
+	enum class area { DATA, RAMTEXT, BSS, LOWTEXT, NONE };
+
+	struct size_t_ {
+		uint32_t	data = 0;
+		uint32_t	ramtext = 0;
+		uint32_t	bss = 0;
+		uint32_t	lowtext = 0;
+	};
+
+	struct item_t {
+		std::string	name;
+		std::string	obj;
+		uint32_t	size;
+	};
+
+	std::map<std::string, size_t_> objs_;
+	std::vector<item_t> items_;
+	uint32_t ram_org_ = 0;
+	uint32_t ram_len_ = 0;
+	uint32_t stack_ = 0;
+
+
+	area get_area_(const std::string& sec)
+	{
+		if(sec == ".data") return area::DATA;
+		if(sec == ".ramtext") return area::RAMTEXT;
+		if(sec == ".bss") return area::BSS;
+		if(sec == ".lowtext") return area::LOWTEXT;
+		return area::NONE;
+	}
+
+
+	// 「.bss._ZN...」から変数名を取り出す
+	std::string get_name_(const std::string& sec)
+	{
+		std::string s = sec;
+		if(s[0] == '.') {
+			auto pos = s.find('.', 1);
+			if(pos == std::string::npos) return s;
+			s = s.substr(pos + 1);
+		}
+		int st = 0;
+		char* dm = abi::__cxa_demangle(s.c_str(), nullptr, nullptr, &st);
+		if(dm != nullptr) {
+			s = dm;
+			free(dm);
+		}
+		return s;
+	}
+
+
+	void add_(area a, const std::string& sec, uint32_t size, const std::string& obj)
+	{
+		if(size == 0) return;
+		auto& t = objs_[obj];
+		switch(a) {
+		case area::DATA:	t.data += size;		break;
+		case area::RAMTEXT:	t.ramtext += size;	break;
+		case area::BSS:		t.bss += size;		break;
+		case area::LOWTEXT:	t.lowtext += size;	break;
+		default: return;
+		}
+		if(a != area::LOWTEXT) {
+			items_.push_back({ get_name_(sec), obj, size });
+		}
+	}
+
+
+	bool load_(const std::string& file)
+	{
+		std::ifstream ifs(file);
+		if(!ifs) {
+			std::cerr << "Can't open file: '" << file << "'" << std::endl;
+			return false;
+		}
+
+		area cur = area::NONE;
+		bool memcfg = false;
+		std::string pend;	// 名前が長く、次の行に続く入力セクション
+		std::string line;
+		while(std::getline(ifs, line)) {
+			if(!line.empty() && line.back() == '\r') line.pop_back();
+
+			if(line == "Memory Configuration") { memcfg = true; continue; }
+			if(line == "Linker script and memory map") { memcfg = false; continue; }
+			if(memcfg) {
+				std::istringstream ss(line);
+				std::string name, org, len;
+				if((ss >> name >> org >> len) && name == "RAM") {
+					ram_org_ = strtoul(org.c_str(), nullptr, 16);
+					ram_len_ = strtoul(len.c_str(), nullptr, 16);
+				}
+				continue;
+			}
+
+			if(line.find("__stack = .") != std::string::npos) {
+				std::istringstream ss(line);
+				std::string adr;
+				if(ss >> adr) stack_ = strtoul(adr.c_str(), nullptr, 16);
+			}
+
+			if(line.empty()) continue;
+
+			// 出力セクション
+			if(line[0] == '.') {
+				std::istringstream ss(line);
+				std::string sec;
+				ss >> sec;
+				cur = get_area_(sec);
+				pend.clear();
+				continue;
+			}
+			if(cur == area::NONE) continue;
+
+			std::istringstream ss(line);
+			if(line[0] == ' ' && line[1] != ' ') {  // 入力セクション
+				std::string sec, adr, size, obj;
+				ss >> sec;
+				if(sec == "*fill*" || sec[0] == '*') continue;
+				if(ss >> adr >> size >> obj) {
+					add_(cur, sec, strtoul(size.c_str(), nullptr, 16), obj);
+					pend.clear();
+				} else {
+					pend = sec;
+				}
+			} else if(!pend.empty()) {
+				std::string adr, size, obj;
+				if(ss >> adr >> size >> obj) {
+					add_(cur, pend, strtoul(size.c_str(), nullptr, 16), obj);
+				}
+				pend.clear();
+			}
+		}
+		return true;
+	}
+
+
+	void help_(const char* cmd)
+	{
+		std::cout << "RAM usage report from linker map file" << std::endl;
+		std::cout << cmd << " [-n num] file.map" << std::endl;
+		std::cout << "    -n num   number of the largest variables (default 10)" << std::endl;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t num = 10;
+	std::string file;
+	for(int i = 1; i < argc; ++i) {
+		std::string s = argv[i];
+		if(s == "-n" && (i + 1) < argc) {
+			num = strtoul(argv[++i], nullptr, 10);
+		} else if(s == "-h" || s == "--help") {
+			help_(argv[0]);
+			return 0;
+		} else {
+			file = s;
+		}
+	}
+	if(file.empty()) {
+		help_(argv[0]);
+		return 1;
+	}
+
+	if(!load_(file)) return 1;
+
+	size_t_ total;
+	printf("%7s %8s %7s %8s  object\n", ".data", ".ramtext", ".bss", ".lowtext");
+	for(const auto& t : objs_) {
+		printf("%7u %8u %7u %8u  %s\n", t.second.data, t.second.ramtext, t.second.bss,
+			t.second.lowtext, t.first.c_str());
+		total.data += t.second.data;
+		total.ramtext += t.second.ramtext;
+		total.bss += t.second.bss;
+		total.lowtext += t.second.lowtext;
+	}
+	printf("%7u %8u %7u %8u  (total)\n\n", total.data, total.ramtext, total.bss,
+		total.lowtext);
+
+	if(ram_len_ != 0) {
+		uint32_t end = stack_ != 0 ? stack_ : (ram_org_ + ram_len_);
+		uint32_t used = total.data + total.ramtext + total.bss;
+		int32_t free = static_cast<int32_t>(end - ram_org_) - static_cast<int32_t>(used);
+		printf("RAM: %u bytes, .data + .ramtext + .bss: %u bytes, stack space: %d bytes\n\n",
+			end - ram_org_, used, free);
+	}
+
+	std::sort(items_.begin(), items_.end(),
+		[](const item_t& a, const item_t& b) { return a.size > b.size; });
+	if(items_.size() > num) items_.resize(num);
+	for(const auto& t : items_) {
+		printf("%7u  %s (%s)\n", t.size, t.name.c_str(), t.obj.c_str());
+	}
+
+	return 0;
+}
@@ -0,0 +1,282 @@
+//=====================================================================//
+/*!	@file
+	@brief	scheduler のテスト（ホスト用） @n
+			・割り込みのモデル（DI 中の割り込みは保留され、EI で入る）で、 @n
+			  タスクの中、DI と HALT の間に割り込みを入れ、実行順を優先順位 @n
+			  毎の FIFO（参照モデル）と比較し、イベントが有る状態で HALT @n
+			  しない事、一杯の時に捨てた数を検査する。 @n
+			・割り込みの代わりにスレッドから post() して、イベントと @n
+			  パラメーターの組が壊れない事、順番が保たれる事を検査する。 @n
+			scheduler_test [イベント数]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include "common/scheduler.hpp"
+
+namespace {
+
+	static constexpr uint8_t EVTNUM = 6;
+	static constexpr uint8_t PRI = 3;
+	static constexpr uint8_t QSIZE = 8;
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	割り込みのモデル（DI 中の割り込みは、EI まで保留）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct intr_sys {
+		static bool		mask_;
+		static uint8_t	pend_;		///< 保留中の割り込み
+		static uint32_t	halt_;		///< HALT した回数
+		static uint32_t	wake_;		///< 保留中の割り込みで HALT しなかった回数
+		static void (*isr_)();
+		static uint32_t (*queued_)();
+
+		static void raise() {
+			if(mask_) ++pend_;
+			else isr_();
+		}
+
+		static void deliver_() {
+			while(pend_ > 0) {
+				--pend_;
+				isr_();
+			}
+		}
+
+		static void lock() {
+			mask_ = true;
+			// DI とイベントの確認の間に、割り込みが入る
+			if((rand() % 4) == 0) raise();
+		}
+
+		static void unlock() {
+			mask_ = false;
+			deliver_();
+		}
+
+		static void sleep() {
+			mask_ = false;
+			if(pend_ > 0) {
+				++wake_;
+				deliver_();
+				return;
+			}
+			if(queued_() != 0) {
+				printf("HALT with %u events: NG\n", queued_());
+				exit(1);
+			}
+			++halt_;
+			isr_();  // 割り込みで起きる
+		}
+	};
+	bool		intr_sys::mask_;
+	uint8_t		intr_sys::pend_;
+	uint32_t	intr_sys::halt_;
+	uint32_t	intr_sys::wake_;
+	void		(*intr_sys::isr_)();
+	uint32_t	(*intr_sys::queued_)();
+
+	typedef utils::scheduler<EVTNUM, PRI, QSIZE, intr_sys> SCHED;
+	SCHED	sched_;
+
+	struct event_t {
+		uint8_t	evt;
+		uint8_t	param;
+	};
+	std::deque<event_t>	ref_[PRI];
+	uint8_t		pri_[EVTNUM];
+	uint32_t	posted_;
+	uint32_t	lost_;
+	uint32_t	done_;
+	uint32_t	error_;
+
+	uint32_t queued_()
+	{
+		uint32_t n = 0;
+		for(uint8_t i = 0; i < PRI; ++i) n += ref_[i].size();
+		return n;
+	}
+
+	void post_(uint8_t evt, uint8_t param)
+	{
+		auto& r = ref_[pri_[evt]];
+		bool ok = sched_.post(evt, param);
+		if(ok != (r.size() < (QSIZE - 1))) {
+			printf("post: NG (queued %u)\n", static_cast<unsigned>(r.size()));
+			++error_;
+		}
+		if(ok) {
+			r.push_back(event_t{ evt, param });
+			++posted_;
+		} else {
+			++lost_;
+		}
+	}
+
+	// 割り込み：イベントを０～３個投げる
+	void isr_()
+	{
+		uint8_t n = rand() % 4;
+		for(uint8_t i = 0; i < n; ++i) {
+			post_(rand() % EVTNUM, rand());
+		}
+	}
+
+	void task_(uint8_t evt, uint8_t param)
+	{
+		// 一番優先順位の高い、一番古いイベントか
+		uint8_t i = 0;
+		while(i < PRI && ref_[i].empty()) ++i;
+		if(i >= PRI || ref_[i].front().evt != evt || ref_[i].front().param != param) {
+			printf("task %u (%u): NG\n", evt, param);
+			++error_;
+			return;
+		}
+		ref_[i].pop_front();
+		++done_;
+		// タスクの中で、割り込みと、メインからの post
+		if((rand() % 4) == 0) intr_sys::raise();
+		if((rand() % 8) == 0) {
+			uint8_t e = rand() % EVTNUM;
+			uint8_t p = rand();
+			intr_sys::lock();
+			post_(e, p);
+			intr_sys::unlock();
+		}
+	}
+
+	template <uint8_t EVT>
+	void func_(uint8_t param) { task_(EVT, param); }
+
+	struct functor {
+		void operator() (uint8_t param) { task_(EVTNUM - 1, param); }
+	};
+
+
+	bool test_(uint32_t loop)
+	{
+		srand(1);
+		intr_sys::isr_ = isr_;
+		intr_sys::queued_ = queued_;
+
+		if(sched_.install(EVTNUM, func_<0>, 0) || sched_.install(0, func_<0>, PRI)) {
+			printf("install range: NG\n");
+			return false;
+		}
+		static const SCHED::task_func func[] = { func_<0>, func_<1>, func_<2>, func_<3>, func_<4> };
+		for(uint8_t i = 0; i < (EVTNUM - 1); ++i) {
+			pri_[i] = i % PRI;
+			sched_.install(i, func[i], pri_[i]);
+		}
+		pri_[EVTNUM - 1] = 0;
+		sched_.install<functor>(EVTNUM - 1, 0);
+
+		while(done_ < loop) {
+			if(!sched_.service()) {
+				if(queued_() != 0) {
+					printf("service: NG (%u events)\n", queued_());
+					return false;
+				}
+				// service() と DI の間に、割り込みが入る
+				if((rand() % 4) == 0) intr_sys::raise();
+				sched_.idle();
+			}
+			if(error_ != 0) return false;
+		}
+		if(sched_.get_lost() != static_cast<uint8_t>(lost_)) {
+			printf("lost %u, expect %u: NG\n", sched_.get_lost(), static_cast<uint8_t>(lost_));
+			return false;
+		}
+		printf("order: %u events, %u lost, %u halt, %u woken before halt OK\n",
+			done_, lost_, intr_sys::halt_, intr_sys::wake_);
+		return true;
+	}
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	スレッドから post() する場合の待機
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct thread_sys {
+		static void lock() { }
+		static void unlock() { }
+		static void sleep() { std::this_thread::yield(); }
+	};
+
+	typedef utils::scheduler<4, 2, 16, thread_sys> TSCHED;
+	TSCHED		tsched_;
+	uint8_t		expect_[4];
+	uint32_t	recv_;
+	uint32_t	terror_;
+
+	template <uint8_t EVT>
+	void tfunc_(uint8_t param)
+	{
+		if(param != expect_[EVT]) ++terror_;
+		expect_[EVT] = param + 1;
+		++recv_;
+	}
+
+
+	bool test_thread_(uint32_t loop)
+	{
+		tsched_.install(0, tfunc_<0>, 0);
+		tsched_.install(1, tfunc_<1>, 1);
+		tsched_.install(2, tfunc_<2>, 0);
+		tsched_.install(3, tfunc_<3>, 1);
+
+		std::atomic<bool> end(false);
+		std::thread isr([&]() {
+			uint8_t param[4] = { 0 };
+			uint32_t seed = 1;
+			for(uint32_t i = 0; i < loop; ++i) {
+				seed = seed * 1103515245 + 12345;
+				uint8_t evt = (seed >> 16) & 3;
+				while(!tsched_.post(evt, param[evt])) std::this_thread::yield();
+				++param[evt];
+			}
+			end = true;
+		});
+
+		while(!end || tsched_.service()) {
+			if(!tsched_.service()) tsched_.idle();
+		}
+		isr.join();
+		while(tsched_.service()) ;
+
+		if(terror_ != 0 || recv_ != loop) {
+			printf("thread: NG (%u errors, %u / %u events)\n", terror_, recv_, loop);
+			return false;
+		}
+		printf("thread: %u events OK\n", recv_);
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t loop = 1000000;
+	if(argc >= 2) loop = strtoul(argv[1], nullptr, 10);
+
+	bool ok = true;
+	ok = test_(loop) && ok;
+	ok = test_thread_(loop * 4) && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK\n");
+	return 0;
+}
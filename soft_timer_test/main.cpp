@@ -0,0 +1,280 @@
+//=====================================================================//
+/*!	@file
+	@brief	soft_timer のテスト（ホスト用） @n
+			tick を模擬して、全てのタイマーの期限を 32 ビットで持つ参照モデルと @n
+			比較する。コールバックからの再開始、停止、他のタイマーの開始や、 @n
+			service() を呼ぶ前に溜まった tick、16 ビットの時間の一周も含める。 @n
+			・コールバックは、参照モデルの期限と同じ時間に一度だけ呼ばれる事 @n
+			・service() の後に、期限を過ぎたタイマーが残っていない事 @n
+			・tickless（get_idle() の tick 数だけ進める）でも遅れない事 @n
+			soft_timer_test [tick 数]
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include "common/soft_timer.hpp"
+
+namespace {
+
+	static constexpr uint8_t NUM = 16;
+	typedef utils::soft_timer<NUM> TIMER;
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	参照モデル（期限を 32 ビットの絶対時間で持つ）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct ref_t {
+		bool		used;
+		bool		active;
+		uint32_t	expire;
+		uint16_t	period;
+	};
+
+	TIMER		timer_;
+	ref_t		ref_[NUM];
+	uint8_t		handle_[NUM];	///< add() で得たハンドル（参照モデルの番号順）
+	uint8_t		index_[NUM];	///< コールバックのオプション（参照モデルの番号）
+	uint32_t	clock_;			///< tick() で渡した tick 数
+	uint32_t	fired_;
+	uint32_t	error_;
+	bool		tickless_;
+
+	uint16_t delay_()
+	{
+		static const uint16_t edge[] = { 1, 2, 31, 32, 33, 1023, 1024, 1025, TIMER::DELAY_MAX };
+		switch(rand() % 4) {
+		case 0:
+			return 1 + (rand() % 40);
+		case 1:
+			return 1 + (rand() % 1100);
+		case 2:
+			return 1 + (rand() % TIMER::DELAY_MAX);
+		default:
+			return edge[rand() % (sizeof(edge) / sizeof(edge[0]))];
+		}
+	}
+
+	// コールバック中の処理時間（32 ビット）
+	uint32_t now_()
+	{
+		return clock_ - static_cast<uint16_t>(static_cast<uint16_t>(clock_) - timer_.get_time());
+	}
+
+	// 両方で開始（期限は、処理中の時間に、未処理の tick と delay を加えた物）
+	void start_(uint8_t i, uint16_t delay, uint16_t period)
+	{
+		bool ok = timer_.start(handle_[i], delay, period);
+		if(ok != ref_[i].used) {
+			printf("start: NG (#%u)\n", i);
+			++error_;
+		}
+		if(!ok) return;
+		uint32_t now = now_();
+		uint32_t d = (clock_ - now) + delay;
+		if(d > TIMER::DELAY_MAX) d = TIMER::DELAY_MAX;
+		ref_[i].active = true;
+		ref_[i].expire = now + d;
+		ref_[i].period = period;
+	}
+
+	void stop_(uint8_t i)
+	{
+		timer_.stop(handle_[i]);
+		ref_[i].active = false;
+	}
+
+	void task_(void* option)
+	{
+		uint8_t i = *static_cast<uint8_t*>(option);
+		uint32_t now = now_();
+		if(!ref_[i].used) {
+			printf("callback of removed timer: NG\n");
+			++error_;
+			return;
+		}
+		auto& r = ref_[i];
+		if(!r.active || r.expire != now) {
+			printf("#%u: fired at %u, expire %u (%s): NG\n", i, now, r.expire,
+				r.active ? "active" : "stopped");
+			++error_;
+			return;
+		}
+		if(tickless_ && now != clock_) {
+			printf("#%u: late %u tick (tickless): NG\n", i, clock_ - now);
+			++error_;
+		}
+		++fired_;
+		if(r.period != 0) r.expire += r.period;
+		else r.active = false;
+
+		// コールバックからの操作
+		uint8_t j = rand() % NUM;
+		switch(rand() % 8) {
+		case 0:
+			start_(i, delay_(), 0);
+			break;
+		case 1:
+			start_(i, delay_(), (rand() & 1) ? delay_() : 0);
+			break;
+		case 2:
+			stop_(i);
+			break;
+		case 3:
+			start_(j, delay_(), 0);
+			break;
+		case 4:
+			stop_(j);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// service() の後に、期限を過ぎたタイマーが無いか
+	bool check_()
+	{
+		for(uint8_t i = 0; i < NUM; ++i) {
+			auto& r = ref_[i];
+			if(!r.used) continue;
+			if(timer_.is_active(handle_[i]) != r.active) {
+				printf("#%u: active %d, expect %d: NG\n", i, timer_.is_active(handle_[i]), r.active);
+				return false;
+			}
+			if(r.active && static_cast<int32_t>(r.expire - clock_) <= 0) {
+				printf("#%u: missed (expire %u, now %u): NG\n", i, r.expire, clock_);
+				return false;
+			}
+		}
+		return error_ == 0;
+	}
+
+	// メインループからの操作
+	void main_op_()
+	{
+		uint8_t i = rand() % NUM;
+		switch(rand() % 8) {
+		case 0:
+			if(ref_[i].used) {
+				timer_.remove(handle_[i]);
+				handle_[i] = TIMER::NONE;
+				ref_[i].used = false;
+				ref_[i].active = false;
+			} else {
+				handle_[i] = timer_.add(task_, &index_[i]);
+				ref_[i].used = handle_[i] != TIMER::NONE;
+			}
+			break;
+		case 1:
+		case 2:
+			start_(i, delay_(), 0);
+			break;
+		case 3:
+			start_(i, delay_(), delay_());
+			break;
+		case 4:
+			stop_(i);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void setup_()
+	{
+		timer_ = TIMER();
+		clock_ = 0;
+		fired_ = 0;
+		error_ = 0;
+		for(uint8_t i = 0; i < NUM; ++i) {
+			index_[i] = i;
+			handle_[i] = timer_.add(task_, &index_[i]);
+			ref_[i].used = true;
+			ref_[i].active = false;
+		}
+	}
+
+
+	// 割り込み（tick）と、service() の間隔をばらつかせる
+	bool test_(uint32_t loop)
+	{
+		srand(1);
+		tickless_ = false;
+		setup_();
+		for(uint8_t i = 0; i < NUM; ++i) start_(i, delay_(), (i & 1) ? delay_() : 0);
+		while(clock_ < loop) {
+			uint16_t n;
+			switch(rand() % 4) {
+			case 0:
+				n = 1 + (rand() % 3000);
+				break;
+			default:
+				n = 1 + (rand() % 8);
+				break;
+			}
+			// 未反映の tick が有る状態で、メインから操作する
+			for(uint16_t k = 0; k < n; ++k) {
+				timer_.tick();
+				++clock_;
+				if((rand() % 64) == 0) main_op_();
+			}
+			timer_.service();
+			if(!check_()) {
+				printf("tick %u: NG\n", clock_);
+				return false;
+			}
+			if((rand() % 4) == 0) main_op_();
+		}
+		printf("wheel: %u tick, %u callbacks OK\n", clock_, fired_);
+		return true;
+	}
+
+
+	// tickless：割り込みは、get_idle() の tick 数をまとめて渡す
+	bool test_tickless_(uint32_t loop)
+	{
+		srand(2);
+		tickless_ = true;
+		setup_();
+		for(uint8_t i = 0; i < NUM; ++i) start_(i, delay_(), (i & 1) ? delay_() : 0);
+		// 12 ビット・インターバル・タイマーの倍率の上限（60Hz の場合、4096 / 250）
+		static constexpr uint16_t SCALE_MAX = 16;
+		uint32_t intr = 0;
+		while(clock_ < loop) {
+			uint16_t n = timer_.get_idle(SCALE_MAX);
+			timer_.tick(n);
+			clock_ += n;
+			++intr;
+			timer_.service();
+			if(!check_()) {
+				printf("tick %u: NG\n", clock_);
+				return false;
+			}
+			if((rand() % 16) == 0) main_op_();
+		}
+		printf("tickless: %u tick, %u interrupts, %u callbacks OK\n", clock_, intr, fired_);
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	uint32_t loop = 20000000;
+	if(argc >= 2) loop = strtoul(argv[1], nullptr, 10);
+
+	bool ok = true;
+	ok = test_(loop) && ok;
+	ok = test_tickless_(loop) && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK\n");
+	return 0;
+}
@@ -0,0 +1,245 @@
+//=====================================================================//
+/*!	@file
+	@brief	VL53L0X ドライバーのテスト（ホスト用） @n
+			I2C のレジスタ・モデル（ページ切り替え、計測完了、割り込み @n
+			クリアを含む）に対して、初期化、連続計測のサービス、 @n
+			単発計測、タイムアウト、メディアンを検査する。 @n
+			vl53_test
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include "chip/VL53L0X.hpp"
+
+namespace {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	VL53L0X レジスタ・モデル @n
+				0xFF でページを切り替える。SYSRANGE_START の bit0 で @n
+				計測（auto_ の場合はすぐに完了）、SYSTEM_INTERRUPT_CLEAR で @n
+				割り込みステータスをクリアする。
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct i2c_model {
+		uint8_t		page_[256][256];
+		uint8_t		sel_;
+		uint8_t		ptr_;
+		uint32_t	send_;
+		uint32_t	recv_;
+		bool		auto_;		///< 計測をすぐに完了させる
+		uint16_t	range_;		///< 次の計測結果
+		uint8_t		start_;		///< 最後に SYSRANGE_START に書いた値
+
+		i2c_model() : page_{ }, sel_(0), ptr_(0), send_(0), recv_(0), auto_(true), range_(0), start_(0) {
+			page_[0x07][0x92] = 0x85;		// SPAD 数 5、アパーチャー
+			page_[0x00][0xF8] = 0x03;		// OSC_CALIBRATE_VAL = 1000
+			page_[0x00][0xF9] = 0xE8;
+			page_[0x00][0x51] = 0x01;		// FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI
+			page_[0x00][0x52] = 0x10;
+			page_[0x00][0x50] = 0x06;		// PRE_RANGE_CONFIG_VCSEL_PERIOD
+			page_[0x00][0x70] = 0x04;		// FINAL_RANGE_CONFIG_VCSEL_PERIOD
+		}
+
+		uint8_t& reg(uint8_t r) { return r == 0xFF ? page_[0][0xFF] : page_[sel_][r]; }
+
+		// 計測の完了（ステータス、距離を置き、割り込みを立てる）
+		void measure(uint16_t range, uint8_t status = 11) {
+			page_[0][0x14] = status << 3;
+			page_[0][0x1E] = range >> 8;
+			page_[0][0x1F] = range;
+			page_[0][0x13] = 0x04;
+		}
+
+		void write_(uint8_t r, uint8_t v) {
+			if(r == 0xFF) {
+				sel_ = v;
+				page_[0][0xFF] = v;
+				return;
+			}
+			reg(r) = v;
+			if(r == 0x83 && v == 0x00) {  // SPAD 情報の準備完了
+				reg(r) = 0x10;
+			}
+			if(sel_ != 0) return;
+			if(r == 0x00) start_ = v;
+			if(r == 0x00 && (v & 0x01) != 0) {  // SYSRANGE_START（単発）
+				if(auto_) {
+					measure(range_);
+					page_[0][0x00] &= ~0x01;
+				}
+			} else if(r == 0x0B && (v & 0x01) != 0) {  // SYSTEM_INTERRUPT_CLEAR
+				page_[0][0x13] = 0;
+			}
+		}
+
+		bool send(uint8_t adr, const uint8_t* src, uint8_t len) {
+			++send_;
+			ptr_ = src[0];
+			for(uint8_t i = 1; i < len; ++i) {
+				write_(ptr_, src[i]);
+				++ptr_;
+			}
+			return true;
+		}
+
+		bool recv(uint8_t adr, uint8_t* dst, uint8_t len) {
+			++recv_;
+			for(uint8_t i = 0; i < len; ++i) {
+				dst[i] = reg(ptr_);
+				++ptr_;
+			}
+			return true;
+		}
+
+		uint32_t get32(uint8_t r) {
+			return (static_cast<uint32_t>(page_[0][r]) << 24) | (static_cast<uint32_t>(page_[0][r + 1]) << 16)
+				| (static_cast<uint32_t>(page_[0][r + 2]) << 8) | page_[0][r + 3];
+		}
+	};
+
+	typedef chip::VL53L0X<i2c_model, 8> VLX;
+
+#define CHECK(cond, msg) \
+	if(!(cond)) { printf("NG: %s (line %d)\n", msg, __LINE__); return false; }
+
+
+	bool test_start_(i2c_model& m, VLX& vlx)
+	{
+		CHECK(vlx.start(), "start");
+		CHECK(m.sel_ == 0, "page restored");
+		CHECK(m.page_[0][0x01] == 0xE8, "sequence config restored");
+		CHECK(!vlx.timeout_occurred(), "no timeout");
+		printf("start: %u sends, %u recvs\n", m.send_, m.recv_);
+
+		CHECK(vlx.set_vcsel_pulse_period(VLX::vcselPeriod::PreRange, 14), "vcsel pre range");
+		CHECK(m.page_[0][0x50] == ((14 >> 1) - 1), "vcsel pre range reg");
+		return true;
+	}
+
+
+	bool test_service_(i2c_model& m, VLX& vlx)
+	{
+		vlx.start_service(33);
+		CHECK(m.start_ == 0x04, "timed mode");
+		CHECK(m.get32(0x04) == 33 * 1000, "inter measurement period");
+
+		// 計測が終わっていない
+		m.send_ = 0;
+		m.recv_ = 0;
+		CHECK(!vlx.service(1), "no data");
+		CHECK(vlx.get_sample_num() == 0, "no sample");
+		CHECK(m.send_ == 1 && m.recv_ == 1, "one burst read");
+
+		// 計測完了
+		m.measure(1234, 11);
+		m.send_ = 0;
+		m.recv_ = 0;
+		CHECK(vlx.service(2), "data");
+		CHECK(m.send_ == 2 && m.recv_ == 1, "burst read and clear");
+		CHECK(m.page_[0][0x13] == 0, "interrupt cleared");
+		CHECK(vlx.get_sample_num() == 1, "one sample");
+		CHECK(vlx.get_sample().range == 1234 && vlx.get_sample().status == 11
+			&& vlx.get_sample().time == 2, "sample");
+		CHECK(!vlx.service(3), "cleared");
+
+		// リングの周回（0 が最新）
+		for(uint16_t i = 0; i < 20; ++i) {
+			m.measure(100 + i);
+			CHECK(vlx.service(10 + i), "ring");
+		}
+		CHECK(vlx.get_sample_num() == 8, "ring full");
+		for(uint8_t i = 0; i < 8; ++i) {
+			CHECK(vlx.get_sample(i).range == 119 - i && vlx.get_sample(i).time == 29 - i, "ring order");
+		}
+
+		// 割り込みモード：ready_task が無ければ I2C に触らない
+		vlx.start_service(0, true);
+		CHECK(m.start_ == 0x02, "back-to-back mode");
+		CHECK(vlx.get_sample_num() == 0, "cleared samples");
+		m.measure(500);
+		m.send_ = 0;
+		m.recv_ = 0;
+		CHECK(!vlx.service(1), "not ready");
+		CHECK(m.send_ == 0 && m.recv_ == 0, "no transfer");
+		vlx.ready_task();
+		CHECK(vlx.service(2), "ready");
+		CHECK(vlx.get_sample().range == 500, "ready sample");
+		CHECK(!vlx.service(3), "ready once");
+
+		vlx.stop_continuous();
+		CHECK(m.start_ == 0x01, "stop");
+		return true;
+	}
+
+
+	bool test_single_(i2c_model& m, VLX& vlx)
+	{
+		m.auto_ = true;
+		m.range_ = 321;
+		CHECK(vlx.read_range_single_millimeters() == 321, "single");
+		CHECK(m.page_[0][0x13] == 0, "single cleared");
+		CHECK(!vlx.timeout_occurred(), "single no timeout");
+
+		// 計測が終わらない
+		m.auto_ = false;
+		m.page_[0][0x13] = 0;
+		vlx.set_timeout(2);
+		CHECK(vlx.read_range_single_millimeters() == 65535, "timeout value");
+		CHECK(vlx.timeout_occurred(), "timeout");
+		CHECK(!vlx.timeout_occurred(), "timeout flag cleared");
+		m.auto_ = true;
+		return true;
+	}
+
+
+	bool test_median_(i2c_model& m, VLX& vlx)
+	{
+		for(uint32_t loop = 0; loop < 10000; ++loop) {
+			vlx.start_service(0);
+			uint16_t n = 1 + (rand() % 12);
+			for(uint16_t i = 0; i < n; ++i) {
+				uint16_t r = (rand() % 8) == 0 ? 8190 : (rand() % 2000);
+				m.measure(r);
+				vlx.service(i);
+			}
+			uint8_t num = 1 + (rand() % 8);
+			uint16_t tmp[16];
+			uint8_t k = 0;
+			for(uint8_t i = 0; i < num && i < vlx.get_sample_num(); ++i) {
+				uint16_t r = vlx.get_sample(i).range;
+				if(r < 8190) tmp[k++] = r;
+			}
+			std::sort(tmp, tmp + k);
+			uint16_t ref = k == 0 ? 65535 : tmp[k / 2];
+			CHECK(vlx.get_median(num) == ref, "median");
+		}
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	static i2c_model m;
+	static VLX vlx(m);
+
+	srand(1);
+	bool ok = true;
+	ok = test_start_(m, vlx) && ok;
+	ok = test_service_(m, vlx) && ok;
+	ok = test_single_(m, vlx) && ok;
+	ok = test_median_(m, vlx) && ok;
+	if(!ok) {
+		printf("NG\n");
+		return 1;
+	}
+	printf("Test: OK\n");
+	return 0;
+}